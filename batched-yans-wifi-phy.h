@@ -0,0 +1,621 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BATCHED_YANS_WIFI_PHY_H
+#define BATCHED_YANS_WIFI_PHY_H
+
+#include "shared-memory-simulator-impl.h"
+
+#include "ns3/abort.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/phy-entity.h"
+#include "ns3/pointer.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-mpdu.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-ppdu.h"
+#include "ns3/wifi-psdu.h"
+#include "ns3/wifi-tx-vector.h"
+#include "ns3/wifi-utils.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/yans-wifi-phy.h"
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * The PHYs attached to a YansWifiChannel, with what delivering a frame to
+ * them needs: their mobility model and node, and the propagation models of
+ * the channel.  Aggregated to the channel by the first BatchedYansWifiPhy
+ * transmitting on it, and shared by all of them; rebuilt when PHYs are added.
+ */
+class YansWifiReceiverTable : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::YansWifiReceiverTable").SetParent<Object>();
+        return tid;
+    }
+
+    /// A PHY of the channel
+    struct Receiver
+    {
+        Ptr<YansWifiPhy> phy;        //!< The PHY
+        Ptr<MobilityModel> mobility; //!< Its mobility model
+        uint32_t node;               //!< Its node, 0xffffffff if none
+        uint32_t device;             //!< Its device index in the node
+    };
+
+    /**
+     * \param channel A channel.
+     * \return the table of the channel, up to date.
+     */
+    static Ptr<YansWifiReceiverTable> Get(Ptr<YansWifiChannel> channel)
+    {
+        Ptr<YansWifiReceiverTable> table = channel->GetObject<YansWifiReceiverTable>();
+        if (!table)
+        {
+            table = CreateObject<YansWifiReceiverTable>();
+            channel->AggregateObject(table);
+        }
+        if (table->m_receivers.size() != channel->GetNDevices())
+        {
+            table->Build(channel);
+        }
+        return table;
+    }
+
+    /**
+     * \return the PHYs, in the order YansWifiChannel delivers to them.
+     */
+    const std::vector<Receiver>& GetReceivers() const
+    {
+        return m_receivers;
+    }
+
+    /**
+     * \return the propagation delay model of the channel.
+     */
+    Ptr<PropagationDelayModel> GetDelayModel() const
+    {
+        return m_delay;
+    }
+
+    /**
+     * \return the propagation loss model of the channel.
+     */
+    Ptr<PropagationLossModel> GetLossModel() const
+    {
+        return m_loss;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_receivers.clear();
+        m_delay = nullptr;
+        m_loss = nullptr;
+        Object::DoDispose();
+    }
+
+  private:
+    /**
+     * \param channel The channel of the table.
+     */
+    void Build(Ptr<YansWifiChannel> channel)
+    {
+        PointerValue delay;
+        PointerValue loss;
+        channel->GetAttribute("PropagationDelayModel", delay);
+        channel->GetAttribute("PropagationLossModel", loss);
+        m_delay = delay.Get<PropagationDelayModel>();
+        m_loss = loss.Get<PropagationLossModel>();
+        m_receivers.clear();
+        for (std::size_t i = 0; i < channel->GetNDevices(); i++)
+        {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(channel->GetDevice(i));
+            NS_ABORT_MSG_UNLESS(device, "Only WifiNetDevices can use batched delivery");
+            Ptr<YansWifiPhy> phy = DynamicCast<YansWifiPhy>(device->GetPhy());
+            Ptr<MobilityModel> mobility = phy->GetMobility();
+            NS_ABORT_MSG_UNLESS(mobility, "A PHY of the channel has no mobility model");
+            m_receivers.push_back({phy,
+                                   mobility,
+                                   device->GetNode() ? device->GetNode()->GetId() : 0xffffffff,
+                                   device->GetIfIndex()});
+        }
+    }
+
+    std::vector<Receiver> m_receivers;  //!< PHYs of the channel, in channel order
+    Ptr<PropagationDelayModel> m_delay; //!< Propagation delay model of the channel
+    Ptr<PropagationLossModel> m_loss;   //!< Propagation loss model of the channel
+};
+
+NS_OBJECT_ENSURE_REGISTERED(YansWifiReceiverTable);
+
+/**
+ * YansWifiPhy delivering its frames with one event per group of receivers.
+ *
+ * YansWifiChannel::Send schedules one event per receiving PHY: an OLSR
+ * HELLO broadcast in an N-node grid is N - 1 events through the scheduler.
+ * This PHY computes the delay and the received power of every receiver as
+ * the channel does, in the same order (random propagation models draw the
+ * same values), then groups the receivers by propagation delay rounded down
+ * to a multiple of DeliveryQuantum, and schedules one event per group that
+ * starts the reception of each of its PHYs in turn, in channel order.
+ *
+ * With DeliveryQuantum=0 the receivers are grouped by exact delay: a group
+ * runs at the time, and the receptions in the order, the channel would
+ * have used, so the results are unchanged; on a regular grid many receivers
+ * are at equal distances and share an event.  A larger quantum gives fewer,
+ * larger groups but moves the receptions earlier by up to one quantum.
+ *
+ * A group event runs in the context of its first receiver: the events its
+ * other receivers schedule carry that node id, which only changes the
+ * context printed by the logging.
+ *
+ * Under SharedMemorySimulatorImpl (SetupPartitions), the frame and its
+ * receivers above the sensitivity are posted to the partitions instead,
+ * and each partition groups its own receivers by exact delay.
+ */
+class BatchedYansWifiPhy : public YansWifiPhy
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::BatchedYansWifiPhy")
+                .SetParent<YansWifiPhy>()
+                .AddConstructor<BatchedYansWifiPhy>()
+                .AddAttribute("DeliveryQuantum",
+                              "The propagation delays of the receivers sharing a delivery "
+                              "event are equal once rounded down to a multiple of this; "
+                              "0 for exact delays.",
+                              TimeValue(Seconds(0)),
+                              MakeTimeAccessor(&BatchedYansWifiPhy::m_quantum),
+                              MakeTimeChecker(Seconds(0)));
+        return tid;
+    }
+
+    /**
+     * \brief Deliver the frames of a channel through the partitions of the
+     * SharedMemorySimulatorImpl, and give it the smallest propagation delay
+     * of the channel as lookahead.
+     *
+     * The delay is computed over every pair of PHYs: N^2 calls to the delay
+     * model, once, before the run.
+     *
+     * \param channel The channel, with all its PHYs attached.
+     */
+    static void SetupPartitions(Ptr<YansWifiChannel> channel)
+    {
+        Ptr<SharedMemorySimulatorImpl> impl = SharedMemorySimulatorImpl::Get();
+        NS_ABORT_MSG_UNLESS(impl, "The simulator implementation is not SharedMemorySimulatorImpl");
+        Ptr<YansWifiReceiverTable> table = YansWifiReceiverTable::Get(channel);
+        NS_ABORT_MSG_UNLESS(table->GetDelayModel()->GetInstanceTypeId().GetName() ==
+                                "ns3::ConstantSpeedPropagationDelayModel",
+                            "Partitioned runs need a constant-speed propagation delay");
+        for (Ptr<PropagationLossModel> loss = table->GetLossModel(); loss; loss = loss->GetNext())
+        {
+            std::string name = loss->GetInstanceTypeId().GetName();
+            NS_ABORT_MSG_IF(name == "ns3::RandomPropagationLossModel" ||
+                                name == "ns3::NakagamiPropagationLossModel" ||
+                                name == "ns3::JakesPropagationLossModel" ||
+                                name.rfind("ns3::ThreeGpp", 0) == 0,
+                            "Partitioned runs need a deterministic loss model, not " << name);
+        }
+        const auto& receivers = table->GetReceivers();
+        Ptr<PropagationDelayModel> delay = table->GetDelayModel();
+        Time lookahead = Time::Max();
+        for (const auto& a : receivers)
+        {
+            NS_ABORT_MSG_UNLESS(DynamicCast<ConstantPositionMobilityModel>(a.mobility),
+                                "Partitioned runs need nodes that do not move");
+            NS_ABORT_MSG_UNLESS(DynamicCast<BatchedYansWifiPhy>(a.phy),
+                                "Partitioned runs need BatchedYansWifiPhys");
+            for (const auto& b : receivers)
+            {
+                if (a.phy != b.phy)
+                {
+                    lookahead = std::min(lookahead, delay->GetDelay(a.mobility, b.mobility));
+                }
+            }
+        }
+        impl->SetLookahead(lookahead);
+        impl->SetReceiveCallback(MakeCallback(&BatchedYansWifiPhy::Receive));
+    }
+
+    void StartTx(Ptr<const WifiPpdu> ppdu) override
+    {
+        if (Ptr<SharedMemorySimulatorImpl> impl = SharedMemorySimulatorImpl::Get())
+        {
+            Post(impl, ppdu);
+            return;
+        }
+        Ptr<YansWifiChannel> channel = DynamicCast<YansWifiChannel>(GetChannel());
+        double txPowerDbm = GetTxPowerForTransmission(ppdu) + GetTxGain();
+        Ptr<YansWifiReceiverTable> table = YansWifiReceiverTable::Get(channel);
+        Ptr<MobilityModel> senderMobility = GetMobility();
+        NS_ASSERT(senderMobility);
+        Ptr<PropagationDelayModel> delayModel = table->GetDelayModel();
+        Ptr<PropagationLossModel> lossModel = table->GetLossModel();
+        int64_t quantum = m_quantum.GetTimeStep();
+
+        for (const auto& receiver : table->GetReceivers())
+        {
+            if (receiver.phy == this || receiver.phy->GetChannelNumber() != GetChannelNumber())
+            {
+                continue;
+            }
+            Time delay = delayModel->GetDelay(senderMobility, receiver.mobility);
+            double rxPowerDbm =
+                lossModel->CalcRxPower(txPowerDbm, senderMobility, receiver.mobility);
+            int64_t key = delay.GetTimeStep();
+            if (quantum > 0)
+            {
+                key -= key % quantum;
+            }
+            Ptr<DeliveryGroup>& group = m_groups[key];
+            if (!group)
+            {
+                group = Create<DeliveryGroup>();
+                Simulator::ScheduleWithContext(receiver.node,
+                                               TimeStep(key),
+                                               &BatchedYansWifiPhy::Deliver,
+                                               group);
+            }
+            group->deliveries.push_back({receiver.phy, ppdu->Copy(), rxPowerDbm});
+        }
+        m_groups.clear();
+    }
+
+  private:
+    /**
+     * \param message The message being built.
+     * \param value A value to append to it.
+     */
+    template <typename T>
+    static void Append(std::vector<uint8_t>& message, const T& value)
+    {
+        auto bytes = reinterpret_cast<const uint8_t*>(&value);
+        message.insert(message.end(), bytes, bytes + sizeof(T));
+    }
+
+    /**
+     * \param data The message being read; moved past the value.
+     * \return the next value.
+     */
+    template <typename T>
+    static T Read(const uint8_t*& data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return value;
+    }
+
+    /**
+     * \brief Post a frame and its receivers to the partitions.
+     *
+     * The message is the TXVECTOR, the duration, the receivers above the
+     * sensitivity with their arrival time and received power, then the
+     * MPDUs, each serialized with its MAC header.
+     *
+     * \param impl The simulator implementation.
+     * \param ppdu The frame.
+     */
+    void Post(Ptr<SharedMemorySimulatorImpl> impl, Ptr<const WifiPpdu> ppdu)
+    {
+        Ptr<YansWifiReceiverTable> table =
+            YansWifiReceiverTable::Get(DynamicCast<YansWifiChannel>(GetChannel()));
+        Ptr<MobilityModel> senderMobility = GetMobility();
+        double txPowerDbm = GetTxPowerForTransmission(ppdu) + GetTxGain();
+        const WifiTxVector& txVector = ppdu->GetTxVector();
+        NS_ABORT_MSG_IF(txVector.IsMu(), "Partitioned runs do not support MU PPDUs");
+        uint16_t txWidth = txVector.GetChannelWidth();
+
+        std::vector<uint8_t>& message = m_message;
+        message.clear();
+        std::string mode = txVector.GetMode().GetUniqueName();
+        Append<uint32_t>(message, mode.size());
+        message.insert(message.end(), mode.begin(), mode.end());
+        Append<uint32_t>(message, txVector.GetPreambleType());
+        Append<uint8_t>(message, txVector.GetTxPowerLevel());
+        Append<uint16_t>(message, txVector.GetGuardInterval());
+        Append<uint8_t>(message, txVector.GetNTx());
+        Append<uint8_t>(message, txVector.GetNss());
+        Append<uint8_t>(message, txVector.GetNess());
+        Append<uint16_t>(message, txWidth);
+        Append<uint8_t>(message, txVector.IsAggregation());
+        Append<uint8_t>(message, txVector.IsStbc());
+        Append<uint8_t>(message, txVector.IsLdpc());
+        Append<uint8_t>(message, txVector.GetBssColor());
+        Append<uint16_t>(message, txVector.GetLength());
+        Append<int64_t>(message, ppdu->GetTxDuration().GetTimeStep());
+
+        std::size_t countOffset = message.size();
+        Append<uint32_t>(message, 0);
+        uint32_t count = 0;
+        Time earliest = Time::Max();
+        for (const auto& receiver : table->GetReceivers())
+        {
+            if (receiver.phy == this || receiver.phy->GetChannelNumber() != GetChannelNumber())
+            {
+                continue;
+            }
+            double rxPowerDbm =
+                table->GetLossModel()->CalcRxPower(txPowerDbm, senderMobility, receiver.mobility);
+            if (rxPowerDbm + receiver.phy->GetRxGain() <
+                receiver.phy->GetRxSensitivity() + RatioToDb(txWidth / 20.0))
+            {
+                continue;
+            }
+            Time arrival =
+                Simulator::Now() +
+                table->GetDelayModel()->GetDelay(senderMobility, receiver.mobility);
+            earliest = std::min(earliest, arrival);
+            Append<uint32_t>(message, receiver.node);
+            Append<uint32_t>(message, receiver.device);
+            Append<int64_t>(message, arrival.GetTimeStep());
+            Append<double>(message, rxPowerDbm);
+            count++;
+        }
+        if (count == 0)
+        {
+            return;
+        }
+        std::memcpy(message.data() + countOffset, &count, sizeof(count));
+
+        Ptr<const WifiPsdu> psdu = ppdu->GetPsdu();
+        Append<uint8_t>(message, psdu->IsAggregate() ? (psdu->IsSingle() ? 1 : 2) : 0);
+        Append<uint32_t>(message, psdu->GetNMpdus());
+        for (std::size_t i = 0; i < psdu->GetNMpdus(); i++)
+        {
+            Ptr<Packet> packet = psdu->GetPayload(i)->Copy();
+            packet->AddHeader(psdu->GetHeader(i));
+            uint32_t size = packet->GetSerializedSize();
+            Append<uint32_t>(message, size);
+            message.resize(message.size() + size);
+            NS_ABORT_MSG_UNLESS(packet->Serialize(message.data() + message.size() - size, size),
+                                "Cannot serialize an MPDU of " << size << " bytes");
+        }
+        impl->Post(GetDevice()->GetNode()->GetId(), earliest, message.data(), message.size());
+    }
+
+    /// A posted frame, as the partitions read it
+    struct PostedFrame : public SimpleRefCount<PostedFrame>
+    {
+        WifiTxVector txVector;                  //!< Its TXVECTOR
+        Time duration;                          //!< Its duration
+        uint8_t aggregation;                    //!< 0 MPDU, 1 S-MPDU, 2 A-MPDU
+        std::vector<std::vector<uint8_t>> mpdus; //!< Its serialized MPDUs
+    };
+
+    /// The receptions of a posted frame by the PHYs of one partition, at one time
+    struct PostedGroup : public SimpleRefCount<PostedGroup>
+    {
+        Ptr<PostedFrame> frame;                                    //!< The frame
+        std::vector<std::pair<Ptr<YansWifiPhy>, double>> receivers; //!< PHYs and powers (dBm)
+    };
+
+    /**
+     * \brief Schedule the receptions of a posted frame by the local PHYs,
+     * one event per arrival time.
+     *
+     * \param data The message.
+     * \param size Its size.
+     */
+    static void Receive(const uint8_t* data, uint32_t size)
+    {
+        const uint8_t* end = data + size;
+        Ptr<SharedMemorySimulatorImpl> impl = SharedMemorySimulatorImpl::Get();
+        auto frame = Create<PostedFrame>();
+        auto modeSize = Read<uint32_t>(data);
+        frame->txVector.SetMode(WifiMode(std::string(data, data + modeSize)));
+        data += modeSize;
+        frame->txVector.SetPreambleType(static_cast<WifiPreamble>(Read<uint32_t>(data)));
+        frame->txVector.SetTxPowerLevel(Read<uint8_t>(data));
+        frame->txVector.SetGuardInterval(Read<uint16_t>(data));
+        frame->txVector.SetNTx(Read<uint8_t>(data));
+        frame->txVector.SetNss(Read<uint8_t>(data));
+        frame->txVector.SetNess(Read<uint8_t>(data));
+        frame->txVector.SetChannelWidth(Read<uint16_t>(data));
+        frame->txVector.SetAggregation(Read<uint8_t>(data));
+        frame->txVector.SetStbc(Read<uint8_t>(data));
+        frame->txVector.SetLdpc(Read<uint8_t>(data));
+        frame->txVector.SetBssColor(Read<uint8_t>(data));
+        frame->txVector.SetLength(Read<uint16_t>(data));
+        frame->duration = TimeStep(Read<int64_t>(data));
+
+        std::map<int64_t, Ptr<PostedGroup>> groups;
+        auto count = Read<uint32_t>(data);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            auto node = Read<uint32_t>(data);
+            auto device = Read<uint32_t>(data);
+            auto arrival = Read<int64_t>(data);
+            auto rxPowerDbm = Read<double>(data);
+            if (!impl->IsLocal(node))
+            {
+                continue;
+            }
+            Ptr<WifiNetDevice> receiver =
+                DynamicCast<WifiNetDevice>(NodeList::GetNode(node)->GetDevice(device));
+            Ptr<PostedGroup>& group = groups[arrival];
+            if (!group)
+            {
+                group = Create<PostedGroup>();
+                group->frame = frame;
+                Simulator::ScheduleWithContext(node,
+                                               TimeStep(arrival) - Simulator::Now(),
+                                               &BatchedYansWifiPhy::DeliverPosted,
+                                               group);
+            }
+            group->receivers.emplace_back(DynamicCast<YansWifiPhy>(receiver->GetPhy()),
+                                          rxPowerDbm);
+        }
+        if (groups.empty())
+        {
+            return;
+        }
+        frame->aggregation = Read<uint8_t>(data);
+        frame->mpdus.resize(Read<uint32_t>(data));
+        for (auto& mpdu : frame->mpdus)
+        {
+            auto mpduSize = Read<uint32_t>(data);
+            mpdu.assign(data, data + mpduSize);
+            data += mpduSize;
+        }
+        NS_ABORT_MSG_UNLESS(data == end, "Malformed frame message");
+    }
+
+    /**
+     * \brief Rebuild a posted frame and start its receptions.
+     *
+     * \param posted The receptions.
+     */
+    static void DeliverPosted(Ptr<PostedGroup> posted)
+    {
+        const PostedFrame& frame = *posted->frame;
+        std::vector<Ptr<WifiMpdu>> mpdus;
+        for (const auto& bytes : frame.mpdus)
+        {
+            auto packet = Create<Packet>(bytes.data(), static_cast<uint32_t>(bytes.size()), true);
+            WifiMacHeader header;
+            packet->RemoveHeader(header);
+            mpdus.push_back(Create<WifiMpdu>(packet, header));
+        }
+        Ptr<WifiPsdu> psdu;
+        if (frame.aggregation == 0)
+        {
+            psdu = Create<WifiPsdu>(mpdus.front()->GetPacket(), mpdus.front()->GetHeader());
+        }
+        else if (frame.aggregation == 1)
+        {
+            psdu = Create<WifiPsdu>(mpdus.front(), true);
+        }
+        else
+        {
+            psdu = Create<WifiPsdu>(mpdus);
+        }
+        Ptr<YansWifiPhy> first = posted->receivers.front().first;
+        Ptr<const WifiPpdu> ppdu =
+            first->GetPhyEntity(frame.txVector.GetModulationClass())
+                ->BuildPpdu(WifiConstPsduMap{{SU_STA_ID, psdu}}, frame.txVector, frame.duration);
+        auto group = Create<DeliveryGroup>();
+        for (const auto& [phy, rxPowerDbm] : posted->receivers)
+        {
+            group->deliveries.push_back({phy, ppdu->Copy(), rxPowerDbm});
+        }
+        Deliver(group);
+    }
+
+    /// A reception to start
+    struct Delivery
+    {
+        Ptr<YansWifiPhy> phy;     //!< The receiving PHY
+        Ptr<const WifiPpdu> ppdu; //!< Its copy of the PPDU
+        double rxPowerDbm;        //!< Received power before the receiver gain
+    };
+
+    /// The receptions of one delivery event
+    struct DeliveryGroup : public SimpleRefCount<DeliveryGroup>
+    {
+        std::vector<Delivery> deliveries; //!< Receptions, in channel order
+    };
+
+    /**
+     * \brief Start the receptions of a group, as YansWifiChannel::Receive does.
+     *
+     * \param group The group.
+     */
+    static void Deliver(Ptr<DeliveryGroup> group)
+    {
+        for (auto& delivery : group->deliveries)
+        {
+            Ptr<YansWifiPhy> phy = delivery.phy;
+            // signals below the sensitivity, normalized to the width, are not processed
+            uint16_t txWidth = delivery.ppdu->GetTxVector().GetChannelWidth();
+            if (delivery.rxPowerDbm + phy->GetRxGain() <
+                phy->GetRxSensitivity() + RatioToDb(txWidth / 20.0))
+            {
+                continue;
+            }
+            double rxPowerW = DbmToW(delivery.rxPowerDbm + phy->GetRxGain());
+            RxPowerWattPerChannelBand rxPowersW;
+            rxPowersW.insert({phy->GetBand(txWidth), rxPowerW});
+            phy->StartReceivePreamble(delivery.ppdu, rxPowersW, delivery.ppdu->GetTxDuration());
+        }
+    }
+
+    Time m_quantum; //!< Delivery quantum, 0 for exact delays
+    /// Groups of the transmission being scheduled, by rounded delay
+    std::unordered_map<int64_t, Ptr<DeliveryGroup>> m_groups;
+    std::vector<uint8_t> m_message; //!< Message of the frame being posted
+};
+
+NS_OBJECT_ENSURE_REGISTERED(BatchedYansWifiPhy);
+
+/**
+ * YansWifiPhyHelper creating BatchedYansWifiPhys, with every other setting
+ * of the helper it is built from.
+ */
+class BatchedYansWifiPhyHelper : public YansWifiPhyHelper
+{
+  public:
+    /**
+     * \param helper The helper whose settings are kept.
+     * \param quantum The delivery quantum, 0 for exact delays.
+     */
+    BatchedYansWifiPhyHelper(const YansWifiPhyHelper& helper, Time quantum)
+        : YansWifiPhyHelper(helper)
+    {
+        for (auto& phy : m_phys)
+        {
+            phy.SetTypeId(BatchedYansWifiPhy::GetTypeId());
+        }
+        Set("DeliveryQuantum", TimeValue(quantum));
+    }
+};
+
+} // namespace ns3
+
+#endif /* BATCHED_YANS_WIFI_PHY_H */
@@ -0,0 +1,53 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Offline decoder for the binary event logs written by the scratch
+// scenarios (see binary-event-log.h), e.g.:
+//
+// ./ns3 run "wifi-simple-adhoc-grid --eventLog=grid.evlog"
+// ./ns3 run "binary-event-log-decode --input=grid.evlog" > grid.log
+//
+
+#include "binary-event-log.h"
+
+#include "ns3/command-line.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+int
+main(int argc, char* argv[])
+{
+    std::string input;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "binary event log to decode", input);
+    cmd.Parse(argc, argv);
+
+    std::ifstream is(input, std::ios::in | std::ios::binary);
+    if (!is.is_open())
+    {
+        std::cerr << "Cannot open " << input << std::endl;
+        return 1;
+    }
+    if (!BinaryEventLog::Decode(is, std::cout))
+    {
+        std::cerr << input << ": truncated or invalid event log" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,394 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_EVENT_LOG_H
+#define BINARY_EVENT_LOG_H
+
+#include "ns3/abort.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/simulator.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Deferred-formatting event log.
+ *
+ * Instead of building a string for every logged event, the caller records
+ * the id of a format string registered once at startup plus the raw
+ * argument values.  Records are appended to an in-memory buffer that is
+ * written to disk in large blocks; the text is only produced later, offline,
+ * by BinaryEventLog::Decode (see binary-event-log-decode.cc).
+ *
+ * Format strings use "{}" as the placeholder for each argument, e.g.
+ * "node {} received {} bytes".
+ *
+ * File layout: an 8-byte magic followed by a sequence of records, each
+ * starting with a one-byte record kind:
+ *  - FORMAT: uint16 id, uint32 length, format string bytes
+ *  - EVENT:  uint16 id, int64 time (ns), uint32 context, uint8 nArgs,
+ *            then nArgs times (uint8 type tag, value)
+ */
+class BinaryEventLog
+{
+  public:
+    BinaryEventLog() = default;
+
+    ~BinaryEventLog()
+    {
+        Close();
+    }
+
+    BinaryEventLog(const BinaryEventLog&) = delete;
+    BinaryEventLog& operator=(const BinaryEventLog&) = delete;
+
+    /**
+     * \brief Open the log file.  Events recorded while closed are discarded.
+     *
+     * \param filename The output file name.
+     * \param bufferSize Number of bytes buffered in memory between writes.
+     */
+    void Open(const std::string& filename, std::size_t bufferSize = 1 << 20)
+    {
+        Close();
+        m_file.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+        NS_ABORT_MSG_UNLESS(m_file.is_open(), "Cannot open event log " << filename);
+        m_bufferSize = bufferSize;
+        m_buffer.reserve(m_bufferSize + MAX_RECORD_HINT);
+        m_file.write(MAGIC, sizeof(MAGIC));
+        // formats registered before Open () still have to be described
+        for (uint16_t id = 0; id < m_formats.size(); id++)
+        {
+            WriteFormat(id);
+        }
+    }
+
+    /**
+     * \brief Flush the buffered records and close the log file.
+     */
+    void Close()
+    {
+        if (m_file.is_open())
+        {
+            Flush();
+            m_file.close();
+        }
+    }
+
+    /**
+     * \return true if events are being recorded.
+     */
+    bool IsEnabled() const
+    {
+        return m_file.is_open();
+    }
+
+    /**
+     * \brief Register a format string.
+     *
+     * \param format The format string, with one "{}" per argument.
+     * \return the id to pass to Record ().
+     */
+    uint16_t RegisterFormat(const std::string& format)
+    {
+        NS_ABORT_MSG_IF(m_formats.size() == UINT16_MAX, "Too many event log formats");
+        uint16_t id = static_cast<uint16_t>(m_formats.size());
+        m_formats.push_back(format);
+        if (IsEnabled())
+        {
+            WriteFormat(id);
+        }
+        return id;
+    }
+
+    /**
+     * \brief Record an event stamped with the current simulation time and context.
+     *
+     * Supported argument types are integers, floating point values,
+     * Ipv4Address and strings.
+     *
+     * \param id The format id returned by RegisterFormat ().
+     * \param args The raw argument values.
+     */
+    template <typename... Args>
+    void Record(uint16_t id, const Args&... args)
+    {
+        if (!IsEnabled())
+        {
+            return;
+        }
+        Put<uint8_t>(EVENT);
+        Put<uint16_t>(id);
+        Put<int64_t>(Simulator::Now().GetNanoSeconds());
+        Put<uint32_t>(Simulator::GetContext());
+        Put<uint8_t>(static_cast<uint8_t>(sizeof...(Args)));
+        (PutArg(args), ...);
+        if (m_buffer.size() >= m_bufferSize)
+        {
+            Flush();
+        }
+    }
+
+    /**
+     * \brief Write the buffered records to the file.
+     */
+    void Flush()
+    {
+        if (!m_buffer.empty())
+        {
+            m_file.write(m_buffer.data(), m_buffer.size());
+            m_buffer.clear();
+        }
+        m_file.flush();
+    }
+
+    /**
+     * \brief Format a binary event log as text.
+     *
+     * Each event is printed on its own line as "<time>s [<context>] <text>".
+     *
+     * \param is The binary log.
+     * \param os The text output.
+     * \return false if the input is not a complete event log.
+     */
+    static bool Decode(std::istream& is, std::ostream& os)
+    {
+        char magic[sizeof(MAGIC)];
+        if (!is.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+        {
+            return false;
+        }
+        std::vector<std::string> formats;
+        uint8_t kind;
+        while (Get(is, kind))
+        {
+            uint16_t id;
+            if (!Get(is, id))
+            {
+                return false;
+            }
+            if (kind == FORMAT)
+            {
+                uint32_t length;
+                if (!Get(is, length))
+                {
+                    return false;
+                }
+                std::string format(length, '\0');
+                if (!is.read(&format[0], length))
+                {
+                    return false;
+                }
+                if (formats.size() <= id)
+                {
+                    formats.resize(id + 1);
+                }
+                formats[id] = format;
+                continue;
+            }
+            int64_t ts;
+            uint32_t context;
+            uint8_t nArgs;
+            if (kind != EVENT || id >= formats.size() || !Get(is, ts) || !Get(is, context) ||
+                !Get(is, nArgs))
+            {
+                return false;
+            }
+            // full nanosecond resolution: a double prints 6 digits only
+            os << (ts < 0 ? "-" : "") << std::abs(ts / 1000000000) << "." << std::setw(9)
+               << std::setfill('0') << std::abs(ts % 1000000000) << std::setfill(' ') << "s [";
+            if (context == Simulator::NO_CONTEXT)
+            {
+                os << "-";
+            }
+            else
+            {
+                os << context;
+            }
+            os << "] ";
+            const std::string& format = formats[id];
+            std::size_t pos = 0;
+            for (uint8_t i = 0; i < nArgs; i++)
+            {
+                std::size_t next = format.find("{}", pos);
+                os << format.substr(pos, next - pos);
+                if (!DecodeArg(is, os))
+                {
+                    return false;
+                }
+                pos = (next == std::string::npos) ? format.size() : next + 2;
+            }
+            os << format.substr(pos) << "\n";
+        }
+        return is.eof();
+    }
+
+  private:
+    /// Record kinds
+    enum RecordKind : uint8_t
+    {
+        FORMAT = 0,
+        EVENT = 1,
+    };
+
+    /// Argument type tags
+    enum ArgTag : uint8_t
+    {
+        TAG_INT = 'i',
+        TAG_UINT = 'u',
+        TAG_DOUBLE = 'd',
+        TAG_IPV4 = 'a',
+        TAG_STRING = 's',
+    };
+
+    static constexpr char MAGIC[8] = {'N', 'S', '3', 'E', 'V', 'L', 'O', 'G'}; //!< File magic
+    static constexpr std::size_t MAX_RECORD_HINT = 256; //!< Slack reserved past bufferSize
+
+    /**
+     * Append a raw value to the buffer.
+     * \param value The value.
+     */
+    template <typename T>
+    void Put(T value)
+    {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    /**
+     * Append a tagged argument to the buffer.
+     * \param value The argument.
+     */
+    template <typename T>
+    void PutArg(const T& value)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            Put<uint8_t>(TAG_DOUBLE);
+            Put<double>(value);
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        {
+            Put<uint8_t>(TAG_INT);
+            Put<int64_t>(value);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            Put<uint8_t>(TAG_UINT);
+            Put<uint64_t>(value);
+        }
+        else if constexpr (std::is_same_v<T, Ipv4Address>)
+        {
+            Put<uint8_t>(TAG_IPV4);
+            Put<uint32_t>(value.Get());
+        }
+        else
+        {
+            const std::string str(value);
+            Put<uint8_t>(TAG_STRING);
+            Put<uint32_t>(static_cast<uint32_t>(str.size()));
+            m_buffer.insert(m_buffer.end(), str.begin(), str.end());
+        }
+    }
+
+    /**
+     * Write the definition of a format to the file.
+     * \param id The format id.
+     */
+    void WriteFormat(uint16_t id)
+    {
+        const std::string& format = m_formats[id];
+        Put<uint8_t>(FORMAT);
+        Put<uint16_t>(id);
+        Put<uint32_t>(static_cast<uint32_t>(format.size()));
+        m_buffer.insert(m_buffer.end(), format.begin(), format.end());
+    }
+
+    /**
+     * Read a raw value.
+     * \param is The input stream.
+     * \param value The value read.
+     * \return true on success.
+     */
+    template <typename T>
+    static bool Get(std::istream& is, T& value)
+    {
+        return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    /**
+     * Read a tagged argument and print it.
+     * \param is The input stream.
+     * \param os The text output.
+     * \return true on success.
+     */
+    static bool DecodeArg(std::istream& is, std::ostream& os)
+    {
+        uint8_t tag;
+        if (!Get(is, tag))
+        {
+            return false;
+        }
+        switch (tag)
+        {
+        case TAG_INT: {
+            int64_t v;
+            return Get(is, v) && (os << v);
+        }
+        case TAG_UINT: {
+            uint64_t v;
+            return Get(is, v) && (os << v);
+        }
+        case TAG_DOUBLE: {
+            double v;
+            return Get(is, v) && (os << v);
+        }
+        case TAG_IPV4: {
+            uint32_t v;
+            return Get(is, v) && (os << Ipv4Address(v));
+        }
+        case TAG_STRING: {
+            uint32_t length;
+            if (!Get(is, length))
+            {
+                return false;
+            }
+            std::string str(length, '\0');
+            return is.read(&str[0], length) && (os << str);
+        }
+        default:
+            return false;
+        }
+    }
+
+    std::ofstream m_file;               //!< Output file
+    std::vector<char> m_buffer;         //!< Records not yet written
+    std::size_t m_bufferSize{0};        //!< Flush threshold
+    std::vector<std::string> m_formats; //!< Registered formats, indexed by id
+};
+
+} // namespace ns3
+
+#endif /* BINARY_EVENT_LOG_H */
@@ -0,0 +1,314 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BURST_SENDER_H
+#define BURST_SENDER_H
+
+#include "ns3/abort.h"
+#include "ns3/address.h"
+#include "ns3/application-container.h"
+#include "ns3/application.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/node.h"
+#include "ns3/object-factory.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/string.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/traced-callback.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * Constant bit rate sender that sends its packets in bursts.
+ *
+ * OnOffApplication schedules one event per packet: at 100 Mbit/s with
+ * 1472-byte packets, one every 118 us per flow.  BurstSender keeps a
+ * token-bucket credit instead, refilled at DataRate, and at every timer
+ * expiration sends up to BurstSize packets into the socket, as many as the
+ * credit pays for; the timer is set to the time at which the credit will
+ * pay for a full burst.  The long-term rate is exactly DataRate, with
+ * BurstSize times fewer application events, but the packets of a burst
+ * reach the MAC queue together: the queue occupancy and the delay of the
+ * first packets of a burst are larger than with evenly spaced packets.
+ * The credit is kept in whole bits plus a fraction of a bit counted in
+ * bit-nanoseconds, both on 64 bits, which limits DataRate to 2^64 / 10^9
+ * bit/s (about 18 Gbit/s).  BurstSize=1 spaces the packets as
+ * OnOffApplication does in its always-on state.
+ */
+class BurstSender : public Application
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::BurstSender")
+                .SetParent<Application>()
+                .AddConstructor<BurstSender>()
+                .AddAttribute("DataRate",
+                              "The long-term sending rate.",
+                              DataRateValue(DataRate("500kb/s")),
+                              MakeDataRateAccessor(&BurstSender::m_rate),
+                              MakeDataRateChecker())
+                .AddAttribute("PacketSize",
+                              "The size of the packets sent.",
+                              UintegerValue(512),
+                              MakeUintegerAccessor(&BurstSender::m_packetSize),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("BurstSize",
+                              "The maximum number of packets sent per timer expiration.",
+                              UintegerValue(8),
+                              MakeUintegerAccessor(&BurstSender::m_burstSize),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("Remote",
+                              "The address of the destination.",
+                              AddressValue(),
+                              MakeAddressAccessor(&BurstSender::m_peer),
+                              MakeAddressChecker())
+                .AddAttribute("Protocol",
+                              "The type of socket factory to use.",
+                              TypeIdValue(UdpSocketFactory::GetTypeId()),
+                              MakeTypeIdAccessor(&BurstSender::m_protocol),
+                              MakeTypeIdChecker())
+                .AddTraceSource("Tx",
+                                "A packet is sent.",
+                                MakeTraceSourceAccessor(&BurstSender::m_txTrace),
+                                "ns3::Packet::TracedCallback")
+                .AddTraceSource("TxWithAddresses",
+                                "A packet is sent, with its source and destination addresses.",
+                                MakeTraceSourceAccessor(&BurstSender::m_txTraceWithAddresses),
+                                "ns3::Packet::TwoAddressTracedCallback");
+        return tid;
+    }
+
+    /**
+     * \return the number of bytes sent.
+     */
+    uint64_t GetTotalTx() const
+    {
+        return m_totalTx;
+    }
+
+    /**
+     * \return the number of timer expirations.
+     */
+    uint64_t GetExpirations() const
+    {
+        return m_expirations;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_socket = nullptr;
+        Application::DoDispose();
+    }
+
+  private:
+    void StartApplication() override
+    {
+        NS_ABORT_MSG_IF(m_rate.GetBitRate() > MAX_RATE,
+                        "BurstSender DataRate is limited to " << MAX_RATE << " bit/s");
+        if (!m_socket)
+        {
+            m_socket = Socket::CreateSocket(GetNode(), m_protocol);
+            if (Inet6SocketAddress::IsMatchingType(m_peer))
+            {
+                m_socket->Bind6();
+            }
+            else
+            {
+                m_socket->Bind();
+            }
+            m_socket->Connect(m_peer);
+            m_socket->SetAllowBroadcast(true);
+            m_socket->ShutdownRecv();
+            m_socket->GetSockName(m_local);
+        }
+        m_creditBits = 0;
+        m_creditFraction = 0;
+        m_lastRefill = Simulator::Now();
+        ScheduleNext();
+    }
+
+    void StopApplication() override
+    {
+        Simulator::Cancel(m_event);
+        if (m_socket)
+        {
+            m_socket->Close();
+        }
+    }
+
+    /// Nanoseconds per second, the bit-nanoseconds per bit
+    static constexpr uint64_t NS_PER_S = 1000000000;
+    /// Highest DataRate, for which NS_PER_S - 1 nanoseconds of refill fit 64 bits
+    static constexpr uint64_t MAX_RATE = std::numeric_limits<uint64_t>::max() / NS_PER_S - 1;
+
+    /**
+     * \return the credit needed for one packet, in bits.
+     */
+    uint64_t GetPacketCost() const
+    {
+        return static_cast<uint64_t>(m_packetSize) * 8;
+    }
+
+    /**
+     * \brief Refill the credit and send the burst it pays for.
+     */
+    void Expire()
+    {
+        Time now = Simulator::Now();
+        auto elapsed = static_cast<uint64_t>((now - m_lastRefill).GetNanoSeconds());
+        uint64_t rate = m_rate.GetBitRate();
+        // whole seconds refill whole bits; the rest, below rate bits, goes
+        // through the fraction, which stays below 2^64 for rate <= MAX_RATE
+        uint64_t fraction = m_creditFraction + rate * (elapsed % NS_PER_S);
+        m_creditBits += rate * (elapsed / NS_PER_S) + fraction / NS_PER_S;
+        m_creditFraction = fraction % NS_PER_S;
+        m_lastRefill = now;
+        m_expirations++;
+        for (uint32_t i = 0; i < m_burstSize && m_creditBits >= GetPacketCost(); i++)
+        {
+            Ptr<Packet> packet = Create<Packet>(m_packetSize);
+            m_txTrace(packet);
+            m_txTraceWithAddresses(packet, m_local, m_peer);
+            m_socket->Send(packet);
+            m_totalTx += m_packetSize;
+            m_creditBits -= GetPacketCost();
+        }
+        ScheduleNext();
+    }
+
+    /**
+     * \brief Set the timer to the time the credit pays for a full burst.
+     */
+    void ScheduleNext()
+    {
+        uint64_t rate = m_rate.GetBitRate();
+        if (rate == 0)
+        {
+            return;
+        }
+        uint64_t cost = GetPacketCost();
+        uint64_t burst = cost > std::numeric_limits<uint64_t>::max() / m_burstSize
+                             ? std::numeric_limits<uint64_t>::max()
+                             : cost * m_burstSize;
+        int64_t delay = 0;
+        if (burst > m_creditBits)
+        {
+            // the missing credit is missing * NS_PER_S - m_creditFraction
+            // bit-nanoseconds, with missing = q * rate + r; divided by the rate
+            // and rounded up, so that the credit is there when the timer expires
+            uint64_t missing = burst - m_creditBits;
+            uint64_t q = missing / rate;
+            uint64_t r = missing % rate;
+            if (q >= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) / NS_PER_S - 1)
+            {
+                delay = std::numeric_limits<int64_t>::max();
+            }
+            else if (r > 0)
+            {
+                delay = q * NS_PER_S + (r * NS_PER_S - m_creditFraction + rate - 1) / rate;
+            }
+            else
+            {
+                delay = q * NS_PER_S - m_creditFraction / rate;
+            }
+        }
+        m_event = Simulator::Schedule(NanoSeconds(delay), &BurstSender::Expire, this);
+    }
+
+    DataRate m_rate;                             //!< Long-term sending rate
+    uint32_t m_packetSize;                       //!< Packet size (bytes)
+    uint32_t m_burstSize;                        //!< Maximum packets per expiration
+    Address m_peer;                              //!< Destination address
+    TypeId m_protocol;                           //!< Socket factory type
+    Ptr<Socket> m_socket;                        //!< Sending socket
+    uint64_t m_creditBits{0};                    //!< Token-bucket credit (whole bits)
+    uint64_t m_creditFraction{0};                //!< Fraction of a bit of credit (bit-ns)
+    Time m_lastRefill;                           //!< Time of the last credit refill
+    EventId m_event;                             //!< Next timer expiration
+    uint64_t m_totalTx{0};                       //!< Bytes sent
+    uint64_t m_expirations{0};                   //!< Timer expirations
+    TracedCallback<Ptr<const Packet>> m_txTrace; //!< Packets sent
+    Address m_local;                             //!< Local address of the socket
+
+    /// Packets sent, with their source and destination addresses
+    TracedCallback<Ptr<const Packet>, const Address&, const Address&> m_txTraceWithAddresses;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(BurstSender);
+
+/**
+ * Installs BurstSender applications, as OnOffHelper does OnOffApplications.
+ */
+class BurstSenderHelper
+{
+  public:
+    /**
+     * \param protocol The socket factory type, e.g. "ns3::UdpSocketFactory".
+     * \param remote The destination address.
+     */
+    BurstSenderHelper(const std::string& protocol, const Address& remote)
+    {
+        m_factory.SetTypeId(BurstSender::GetTypeId());
+        m_factory.Set("Protocol", StringValue(protocol));
+        m_factory.Set("Remote", AddressValue(remote));
+    }
+
+    /**
+     * \param name The attribute name.
+     * \param value The attribute value.
+     */
+    void SetAttribute(const std::string& name, const AttributeValue& value)
+    {
+        m_factory.Set(name, value);
+    }
+
+    /**
+     * \param node The node to install a sender on.
+     * \return the sender.
+     */
+    ApplicationContainer Install(Ptr<Node> node) const
+    {
+        Ptr<Application> app = m_factory.Create<Application>();
+        node->AddApplication(app);
+        return ApplicationContainer(app);
+    }
+
+  private:
+    ObjectFactory m_factory; //!< Sender factory
+};
+
+} // namespace ns3
+
+#endif /* BURST_SENDER_H */
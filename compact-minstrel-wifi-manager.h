@@ -0,0 +1,809 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COMPACT_MINSTREL_WIFI_MANAGER_H
+#define COMPACT_MINSTREL_WIFI_MANAGER_H
+
+#include "ns3/abort.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/traced-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-remote-station-manager.h"
+#include "ns3/wifi-tx-vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Minstrel rate control with the state of all the peers of a device in
+ * a few contiguous tables.
+ *
+ * MinstrelWifiManager allocates, for every peer, a station object holding
+ * a vector of per-rate records and a sample table of one vector per rate:
+ * in a 100-node all-to-all grid, 10k scattered station records, each read
+ * and updated on every transmission, and each refreshed on its own when its
+ * UpdateStatistics period expires.
+ *
+ * This manager runs the same algorithm (rate selection, look-around
+ * sampling, retry chain, EWMA of the success probability) over a
+ * structure-of-arrays store owned by the device:
+ *  - one row per peer, allocated on the first transmission to it (when its
+ *    supported rates are known) and recycled when the station is deleted;
+ *  - per-peer fields (current, best, second best, most probable and sample
+ *    rates, packet counters, retries) in one array each;
+ *  - per-(peer, rate) fields in one array each, a row being the rates of a
+ *    peer: 27 bytes per rate against about 90 for Minstrel;
+ *  - the sample tables of all peers in one byte array.
+ *
+ * The statistics of all the peers are updated together, in one pass over
+ * the tables, at the first report after every UpdateStatistics period of
+ * the device, instead of peer by peer.  Retransmissions stop at the retry
+ * limit of the MAC rather than at the end of the retry chain; within it,
+ * the rates tried are the same as with Minstrel.
+ */
+class CompactMinstrelWifiManager : public WifiRemoteStationManager
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::CompactMinstrelWifiManager")
+                .SetParent<WifiRemoteStationManager>()
+                .AddConstructor<CompactMinstrelWifiManager>()
+                .AddAttribute("UpdateStatistics",
+                              "The interval between updates of the statistics of all peers.",
+                              TimeValue(Seconds(0.1)),
+                              MakeTimeAccessor(&CompactMinstrelWifiManager::m_updateStats),
+                              MakeTimeChecker())
+                .AddAttribute("LookAroundRate",
+                              "The percentage of packets sent at a sampled rate.",
+                              UintegerValue(10),
+                              MakeUintegerAccessor(&CompactMinstrelWifiManager::m_lookAroundRate),
+                              MakeUintegerChecker<uint8_t>(0, 100))
+                .AddAttribute("EWMA",
+                              "The EWMA level, in percent.",
+                              UintegerValue(75),
+                              MakeUintegerAccessor(&CompactMinstrelWifiManager::m_ewmaLevel),
+                              MakeUintegerChecker<uint8_t>(0, 100))
+                .AddAttribute("SampleColumn",
+                              "The number of columns of the sample tables.",
+                              UintegerValue(10),
+                              MakeUintegerAccessor(&CompactMinstrelWifiManager::m_sampleCol),
+                              MakeUintegerChecker<uint8_t>(1))
+                .AddAttribute("PacketLength",
+                              "The packet length used to compute the transmission times.",
+                              UintegerValue(1200),
+                              MakeUintegerAccessor(&CompactMinstrelWifiManager::m_pktLen),
+                              MakeUintegerChecker<uint32_t>())
+                .AddTraceSource(
+                    "Rate",
+                    "Traced value for rate changes (b/s)",
+                    MakeTraceSourceAccessor(&CompactMinstrelWifiManager::m_currentRate),
+                    "ns3::TracedValueCallback::Uint64");
+        return tid;
+    }
+
+    CompactMinstrelWifiManager()
+        : m_currentRate(0)
+    {
+        m_uniformRandomVariable = CreateObject<UniformRandomVariable>();
+    }
+
+    void SetupPhy(const Ptr<WifiPhy> phy) override
+    {
+        for (const auto& mode : phy->GetModeList())
+        {
+            WifiTxVector txVector;
+            txVector.SetMode(mode);
+            txVector.SetPreambleType(WIFI_PREAMBLE_LONG);
+            m_calcTxTime[mode] = phy->CalculateTxDuration(m_pktLen, txVector, phy->GetPhyBand());
+        }
+        WifiRemoteStationManager::SetupPhy(phy);
+    }
+
+    int64_t AssignStreams(int64_t stream) override
+    {
+        m_uniformRandomVariable->SetStream(stream);
+        return 1;
+    }
+
+    /**
+     * \return the number of peers with a row in the tables.
+     */
+    uint32_t GetNPeers() const
+    {
+        return m_nRows - m_freeRows.size();
+    }
+
+  protected:
+    void DoInitialize() override
+    {
+        NS_ABORT_MSG_IF(GetHtSupported(), "CompactMinstrelWifiManager does not support HT rates");
+        m_nextStatsUpdate = Simulator::Now() + m_updateStats;
+        WifiRemoteStationManager::DoInitialize();
+    }
+
+  private:
+    static constexpr uint32_t NO_ROW = 0xffffffff; //!< Peer without a row yet
+
+    /// A peer: the index of its row in the tables
+    struct Station : public WifiRemoteStation
+    {
+        ~Station() override
+        {
+            if (m_row != NO_ROW)
+            {
+                m_manager->m_freeRows.push_back(m_row);
+                m_manager->m_nModes[m_row] = 0;
+            }
+        }
+
+        CompactMinstrelWifiManager* m_manager; //!< Manager owning the row
+        uint32_t m_row{NO_ROW};                //!< Row of the peer
+    };
+
+    /// Flags of a peer
+    enum Flags : uint8_t
+    {
+        SAMPLING = 1 << 0, //!< Sending at a sampled rate
+        DEFERRED = 1 << 1, //!< The sampled rate is slower than the best: sampled later
+    };
+
+    WifiRemoteStation* DoCreateStation() const override
+    {
+        auto station = new Station;
+        station->m_manager = const_cast<CompactMinstrelWifiManager*>(this);
+        return station;
+    }
+
+    /**
+     * \param st A peer.
+     * \return its row, allocated if its supported rates are known; NO_ROW if not.
+     */
+    uint32_t GetRow(WifiRemoteStation* st)
+    {
+        auto station = static_cast<Station*>(st);
+        if (station->m_row == NO_ROW && GetNSupported(station) > 1)
+        {
+            station->m_row = AllocateRow(GetNSupported(station));
+            InitRow(station, station->m_row);
+        }
+        return station->m_row;
+    }
+
+    /**
+     * \param nModes The number of rates of the peer.
+     * \return a free row, the tables grown as needed.
+     */
+    uint32_t AllocateRow(uint8_t nModes)
+    {
+        if (nModes > m_stride)
+        {
+            Restride(nModes);
+        }
+        if (!m_freeRows.empty())
+        {
+            uint32_t row = m_freeRows.back();
+            m_freeRows.pop_back();
+            return row;
+        }
+        uint32_t row = m_nRows++;
+        for (auto* column : {&m_maxTpRate,
+                             &m_maxTpRate2,
+                             &m_maxProbRate,
+                             &m_sampleRate,
+                             &m_txrate,
+                             &m_nModes,
+                             &m_col,
+                             &m_index,
+                             &m_flags})
+        {
+            column->resize(m_nRows);
+        }
+        m_totalPackets.resize(m_nRows);
+        m_samplePackets.resize(m_nRows);
+        m_samplesDeferred.resize(m_nRows);
+        m_shortRetry.resize(m_nRows);
+        m_longRetry.resize(m_nRows);
+        ResizeRates();
+        return row;
+    }
+
+    /// Size the per-rate tables for m_nRows rows of m_stride rates.
+    void ResizeRates()
+    {
+        std::size_t size = static_cast<std::size_t>(m_nRows) * m_stride;
+        m_perfectTxTime.resize(size);
+        m_attempts.resize(size);
+        m_successes.resize(size);
+        m_throughput.resize(size);
+        m_ewmaProb.resize(size);
+        for (auto* column : {&m_retryCount, &m_adjustedRetryCount, &m_samplesSkipped, &m_sampled})
+        {
+            column->resize(size);
+        }
+        m_sampleLimit.resize(size);
+        m_sampleTable.resize(size * m_sampleCol);
+    }
+
+    /**
+     * \brief Widen the rows of the per-rate tables.
+     *
+     * \param stride The new number of rates per row.
+     */
+    void Restride(uint8_t stride)
+    {
+        uint8_t old = m_stride;
+        auto widen = [this, old, stride](auto& column, std::size_t width) {
+            std::remove_reference_t<decltype(column)> wide(std::size_t(m_nRows) * stride * width);
+            for (uint32_t row = 0; row < m_nRows; row++)
+            {
+                std::copy_n(column.begin() + std::size_t(row) * old * width,
+                            old * width,
+                            wide.begin() + std::size_t(row) * stride * width);
+            }
+            column.swap(wide);
+        };
+        widen(m_perfectTxTime, 1);
+        widen(m_attempts, 1);
+        widen(m_successes, 1);
+        widen(m_throughput, 1);
+        widen(m_ewmaProb, 1);
+        widen(m_retryCount, 1);
+        widen(m_adjustedRetryCount, 1);
+        widen(m_samplesSkipped, 1);
+        widen(m_sampled, 1);
+        widen(m_sampleLimit, 1);
+        widen(m_sampleTable, m_sampleCol);
+        m_stride = stride;
+    }
+
+    /**
+     * \brief Initialize the row of a peer, as Minstrel initializes a station.
+     *
+     * \param station The peer.
+     * \param row Its row.
+     */
+    void InitRow(WifiRemoteStation* station, uint32_t row)
+    {
+        uint8_t nModes = GetNSupported(station);
+        m_maxTpRate[row] = 0;
+        m_maxTpRate2[row] = 0;
+        m_maxProbRate[row] = 0;
+        m_sampleRate[row] = 0;
+        m_txrate[row] = 0;
+        m_nModes[row] = nModes;
+        m_flags[row] = 0;
+        m_totalPackets[row] = 0;
+        m_samplePackets[row] = 0;
+        m_samplesDeferred[row] = 0;
+        m_shortRetry[row] = 0;
+        m_longRetry[row] = 0;
+
+        std::size_t base = std::size_t(row) * m_stride;
+        for (uint8_t i = 0; i < nModes; i++)
+        {
+            std::size_t r = base + i;
+            m_attempts[r] = 0;
+            m_successes[r] = 0;
+            m_throughput[r] = 0;
+            m_ewmaProb[r] = 0;
+            m_samplesSkipped[r] = 0;
+            m_sampled[r] = 0;
+            m_sampleLimit[r] = -1;
+            Time perfectTxTime = m_calcTxTime.at(GetSupported(station, i));
+            m_perfectTxTime[r] = perfectTxTime.GetMicroSeconds();
+            m_retryCount[r] = 1;
+            m_adjustedRetryCount[r] = 1;
+            // as minstrel.c::ath_rate_ctl_reset: from 2 to 10 retries, within 6 ms
+            for (uint32_t retries = 2; retries < 11; retries++)
+            {
+                if (CalculateTimeUnicastPacket(perfectTxTime, retries) > MilliSeconds(6))
+                {
+                    break;
+                }
+                m_retryCount[r] = retries;
+                m_adjustedRetryCount[r] = retries;
+            }
+        }
+
+        // sample table: every column a random permutation of the rates
+        m_col[row] = 0;
+        m_index[row] = 0;
+        uint8_t* table = &m_sampleTable[base * m_sampleCol];
+        std::fill_n(table, std::size_t(m_stride) * m_sampleCol, 0);
+        for (uint8_t col = 0; col < m_sampleCol; col++)
+        {
+            for (uint8_t i = 0; i < nModes; i++)
+            {
+                int uv = m_uniformRandomVariable->GetInteger(0, nModes);
+                uint16_t newIndex = (i + uv) % nModes;
+                while (table[newIndex * m_sampleCol + col] != 0)
+                {
+                    newIndex = (newIndex + 1) % nModes;
+                }
+                table[newIndex * m_sampleCol + col] = i;
+            }
+        }
+    }
+
+    /**
+     * \param dataTransmissionTime The transmission time of a packet.
+     * \param longRetries The number of retransmissions.
+     * \return the time taken by the packet with its retransmissions and backoffs.
+     */
+    Time CalculateTimeUnicastPacket(Time dataTransmissionTime, uint32_t longRetries) const
+    {
+        Ptr<WifiPhy> phy = GetPhy();
+        Time attempt = dataTransmissionTime + phy->GetSifs() + phy->GetAckTxTime();
+        Time tt = attempt;
+        uint32_t cw = 31;
+        for (uint32_t retry = 0; retry < longRetries; retry++)
+        {
+            tt += attempt + (cw / 2.0) * phy->GetSlot();
+            cw = std::min<uint32_t>(1023, (cw + 1) * 2);
+        }
+        return tt;
+    }
+
+    /// Update the statistics of every peer, once per UpdateStatistics.
+    void UpdateStats()
+    {
+        if (Simulator::Now() < m_nextStatsUpdate)
+        {
+            return;
+        }
+        m_nextStatsUpdate = Simulator::Now() + m_updateStats;
+        for (uint32_t row = 0; row < m_nRows; row++)
+        {
+            if (m_nModes[row] != 0)
+            {
+                UpdateRowStats(row);
+            }
+        }
+    }
+
+    /**
+     * \brief Update the success probabilities and the best rates of a peer.
+     *
+     * \param row The row of the peer.
+     */
+    void UpdateRowStats(uint32_t row)
+    {
+        std::size_t base = std::size_t(row) * m_stride;
+        uint8_t nModes = m_nModes[row];
+        for (std::size_t r = base; r < base + nModes; r++)
+        {
+            int64_t txTime = m_perfectTxTime[r] == 0 ? 1000000 : m_perfectTxTime[r];
+            if (m_attempts[r] != 0)
+            {
+                m_samplesSkipped[r] = 0;
+                // probability of success, from 0 to 18000
+                uint32_t prob = (m_successes[r] * 18000) / m_attempts[r];
+                if (m_sampled[r])
+                {
+                    prob = (prob * (100 - m_ewmaLevel) + m_ewmaProb[r] * m_ewmaLevel) / 100;
+                }
+                m_ewmaProb[r] = prob;
+                m_throughput[r] = prob * static_cast<uint32_t>(1000000 / txTime);
+            }
+            else if (m_samplesSkipped[r] < UINT8_MAX)
+            {
+                m_samplesSkipped[r]++;
+            }
+            m_sampled[r] |= (m_successes[r] != 0);
+            m_successes[r] = 0;
+            m_attempts[r] = 0;
+
+            // sample less often below 10% and above 95% of success
+            if (m_ewmaProb[r] > 17100 || m_ewmaProb[r] < 1800)
+            {
+                if (m_retryCount[r] > 2)
+                {
+                    m_adjustedRetryCount[r] = 2;
+                }
+                m_sampleLimit[r] = 4;
+            }
+            else
+            {
+                m_sampleLimit[r] = -1;
+                m_adjustedRetryCount[r] = m_retryCount[r];
+            }
+            if (m_adjustedRetryCount[r] == 0)
+            {
+                m_adjustedRetryCount[r] = 2;
+            }
+        }
+
+        uint8_t maxTp = 0;
+        uint32_t max = 0;
+        for (uint8_t i = 0; i < nModes; i++)
+        {
+            if (max < m_throughput[base + i])
+            {
+                maxTp = i;
+                max = m_throughput[base + i];
+            }
+        }
+        uint8_t maxTp2 = 0;
+        max = 0;
+        for (uint8_t i = 0; i < nModes; i++)
+        {
+            if (i != maxTp && max < m_throughput[base + i])
+            {
+                maxTp2 = i;
+                max = m_throughput[base + i];
+            }
+        }
+        uint8_t maxProb = 0;
+        max = 0;
+        for (uint8_t i = 0; i < nModes; i++)
+        {
+            if (m_ewmaProb[base + i] >= 95 * 180 &&
+                m_throughput[base + i] >= m_throughput[base + maxProb])
+            {
+                maxProb = i;
+                max = m_ewmaProb[base + i];
+            }
+            else if (m_ewmaProb[base + i] >= max)
+            {
+                maxProb = i;
+                max = m_ewmaProb[base + i];
+            }
+        }
+
+        m_maxTpRate[row] = maxTp;
+        m_maxTpRate2[row] = maxTp2;
+        m_maxProbRate[row] = maxProb;
+        if (maxTp > m_txrate[row])
+        {
+            m_txrate[row] = maxTp;
+        }
+    }
+
+    /**
+     * \param row The row of a peer.
+     * \param rate A rate of the peer.
+     * \return the retries allowed at the rate.
+     */
+    uint32_t Retries(uint32_t row, uint8_t rate) const
+    {
+        return m_adjustedRetryCount[std::size_t(row) * m_stride + rate];
+    }
+
+    /**
+     * \brief Pick the rate of the next attempt after a failure, along the retry chain.
+     *
+     * \param row The row of the peer.
+     */
+    void UpdateRate(uint32_t row)
+    {
+        uint32_t retry = ++m_longRetry[row];
+        m_attempts[std::size_t(row) * m_stride + m_txrate[row]]++;
+
+        // the chain: best throughput, second best (or the sampled rate), most probable, lowest
+        uint8_t first = m_maxTpRate[row];
+        uint8_t second = m_maxTpRate2[row];
+        if (m_flags[row] & SAMPLING)
+        {
+            first = (m_flags[row] & DEFERRED) ? m_maxTpRate[row] : m_sampleRate[row];
+            second = (m_flags[row] & DEFERRED) ? m_sampleRate[row] : m_maxTpRate[row];
+        }
+        uint32_t end = Retries(row, first);
+        if (retry < end)
+        {
+            m_txrate[row] = first;
+            return;
+        }
+        end += Retries(row, second);
+        if (retry <= end)
+        {
+            m_txrate[row] = second;
+            return;
+        }
+        end += Retries(row, m_maxProbRate[row]);
+        m_txrate[row] = (retry <= end) ? m_maxProbRate[row] : 0;
+    }
+
+    /**
+     * \param row The row of a peer.
+     * \return the next rate of the sample table of the peer.
+     */
+    uint8_t GetNextSample(uint32_t row)
+    {
+        std::size_t base = std::size_t(row) * m_stride;
+        uint8_t rate = m_sampleTable[(base + m_index[row]) * m_sampleCol + m_col[row]];
+        m_index[row]++;
+        if (m_index[row] > m_nModes[row] - 2)
+        {
+            m_index[row] = 0;
+            m_col[row]++;
+            if (m_col[row] >= m_sampleCol)
+            {
+                m_col[row] = 0;
+            }
+        }
+        return rate;
+    }
+
+    /**
+     * \brief Pick the rate of the next packet: the best one, or a rate to sample.
+     *
+     * \param row The row of a peer.
+     * \return the rate.
+     */
+    uint8_t FindRate(uint32_t row)
+    {
+        if (m_totalPackets[row] == 0)
+        {
+            return 0;
+        }
+        int delta = (m_totalPackets[row] * m_lookAroundRate / 100) -
+                    (m_samplePackets[row] + m_samplesDeferred[row] / 2);
+        if (delta < 0)
+        {
+            return m_maxTpRate[row];
+        }
+        uint8_t nModes = m_nModes[row];
+        if (delta > nModes * 2)
+        {
+            // too much sampling backlog: skip it rather than bursting samples
+            m_samplePackets[row] += delta - nModes * 2;
+        }
+        uint8_t idx = GetNextSample(row);
+        m_sampleRate[row] = idx;
+        std::size_t base = std::size_t(row) * m_stride;
+        std::size_t r = base + idx;
+        if (m_perfectTxTime[r] > m_perfectTxTime[base + m_maxTpRate[row]] &&
+            m_samplesSkipped[r] < 20)
+        {
+            // slower than the best rate: sampled second in the retry chain
+            m_flags[row] |= SAMPLING | DEFERRED;
+            m_samplesDeferred[row]++;
+            return m_maxTpRate[row];
+        }
+        if (m_sampleLimit[r] == 0)
+        {
+            m_flags[row] &= ~SAMPLING;
+            return m_maxTpRate[row];
+        }
+        m_flags[row] |= SAMPLING;
+        if (m_sampleLimit[r] > 0)
+        {
+            m_sampleLimit[r]--;
+        }
+        return idx;
+    }
+
+    /**
+     * \brief Count a packet done with, sampled or not.
+     *
+     * \param row The row of the peer.
+     */
+    void UpdatePacketCounters(uint32_t row)
+    {
+        m_totalPackets[row]++;
+        if ((m_flags[row] & SAMPLING) &&
+            (!(m_flags[row] & DEFERRED) || m_longRetry[row] >= Retries(row, m_maxTpRate[row])))
+        {
+            m_samplePackets[row]++;
+        }
+        if (m_samplesDeferred[row] > 0)
+        {
+            m_samplesDeferred[row]--;
+        }
+        if (m_totalPackets[row] == INT32_MAX)
+        {
+            m_samplesDeferred[row] = 0;
+            m_samplePackets[row] = 0;
+            m_totalPackets[row] = 0;
+        }
+        m_flags[row] = 0;
+    }
+
+    /**
+     * \brief End a packet: update the statistics if due and pick the next rate.
+     *
+     * \param row The row of the peer.
+     */
+    void EndPacket(uint32_t row)
+    {
+        m_flags[row] = 0;
+        m_shortRetry[row] = 0;
+        m_longRetry[row] = 0;
+        UpdateStats();
+        m_txrate[row] = FindRate(row);
+    }
+
+    void DoReportRxOk(WifiRemoteStation* station, double rxSnr, WifiMode txMode) override
+    {
+    }
+
+    void DoReportRtsFailed(WifiRemoteStation* station) override
+    {
+        uint32_t row = GetRow(station);
+        if (row != NO_ROW)
+        {
+            m_shortRetry[row]++;
+        }
+    }
+
+    void DoReportRtsOk(WifiRemoteStation* station,
+                       double ctsSnr,
+                       WifiMode ctsMode,
+                       double rtsSnr) override
+    {
+    }
+
+    void DoReportFinalRtsFailed(WifiRemoteStation* station) override
+    {
+        uint32_t row = GetRow(station);
+        if (row != NO_ROW)
+        {
+            UpdatePacketCounters(row);
+            m_shortRetry[row] = 0;
+        }
+    }
+
+    void DoReportDataFailed(WifiRemoteStation* station) override
+    {
+        uint32_t row = GetRow(station);
+        if (row != NO_ROW)
+        {
+            UpdateRate(row);
+        }
+    }
+
+    void DoReportDataOk(WifiRemoteStation* station,
+                        double ackSnr,
+                        WifiMode ackMode,
+                        double dataSnr,
+                        uint16_t dataChannelWidth,
+                        uint8_t dataNss) override
+    {
+        uint32_t row = GetRow(station);
+        if (row == NO_ROW)
+        {
+            return;
+        }
+        std::size_t r = std::size_t(row) * m_stride + m_txrate[row];
+        m_successes[r]++;
+        m_attempts[r]++;
+        UpdatePacketCounters(row);
+        EndPacket(row);
+    }
+
+    void DoReportFinalDataFailed(WifiRemoteStation* station) override
+    {
+        uint32_t row = GetRow(station);
+        if (row == NO_ROW)
+        {
+            return;
+        }
+        UpdatePacketCounters(row);
+        EndPacket(row);
+    }
+
+    /**
+     * \param station A peer.
+     * \return its channel width, at most 20 MHz (22 for DSSS).
+     */
+    uint16_t GetWidth(WifiRemoteStation* station) const
+    {
+        uint16_t channelWidth = GetChannelWidth(station);
+        return (channelWidth > 20 && channelWidth != 22) ? 20 : channelWidth;
+    }
+
+    WifiTxVector DoGetDataTxVector(WifiRemoteStation* station, uint16_t allowedWidth) override
+    {
+        uint32_t row = GetRow(station);
+        uint16_t channelWidth = GetWidth(station);
+        WifiMode mode = GetSupported(station, row == NO_ROW ? 0 : m_txrate[row]);
+        uint64_t rate = mode.GetDataRate(channelWidth);
+        if (m_currentRate != rate && (row == NO_ROW || !(m_flags[row] & SAMPLING)))
+        {
+            m_currentRate = rate;
+        }
+        return WifiTxVector(
+            mode,
+            GetDefaultTxPowerLevel(),
+            GetPreambleForTransmission(mode.GetModulationClass(), GetShortPreambleEnabled()),
+            800,
+            1,
+            1,
+            0,
+            channelWidth,
+            GetAggregation(station));
+    }
+
+    WifiTxVector DoGetRtsTxVector(WifiRemoteStation* station) override
+    {
+        WifiMode mode =
+            GetUseNonErpProtection() ? GetNonErpSupported(station, 0) : GetSupported(station, 0);
+        return WifiTxVector(
+            mode,
+            GetDefaultTxPowerLevel(),
+            GetPreambleForTransmission(mode.GetModulationClass(), GetShortPreambleEnabled()),
+            800,
+            1,
+            1,
+            0,
+            GetWidth(station),
+            GetAggregation(station));
+    }
+
+    Time m_updateStats;       //!< Statistics update interval
+    Time m_nextStatsUpdate;   //!< Time of the next update of the statistics
+    uint8_t m_lookAroundRate; //!< Percentage of packets sent at a sampled rate
+    uint8_t m_ewmaLevel;      //!< EWMA level, in percent
+    uint8_t m_sampleCol;      //!< Columns of the sample tables
+    uint32_t m_pktLen;        //!< Packet length for the transmission times
+
+    std::map<WifiMode, Time> m_calcTxTime;              //!< Transmission time of every mode
+    Ptr<UniformRandomVariable> m_uniformRandomVariable; //!< Sample table permutations
+    TracedValue<uint64_t> m_currentRate;                //!< Current rate (b/s)
+
+    uint32_t m_nRows{0};              //!< Rows of the tables
+    uint8_t m_stride{0};              //!< Rates per row of the per-rate tables
+    std::vector<uint32_t> m_freeRows; //!< Rows of deleted peers, to reuse
+
+    // per peer
+    std::vector<uint8_t> m_maxTpRate;       //!< Best throughput rate
+    std::vector<uint8_t> m_maxTpRate2;      //!< Second best throughput rate
+    std::vector<uint8_t> m_maxProbRate;     //!< Most probable rate
+    std::vector<uint8_t> m_sampleRate;      //!< Rate being sampled
+    std::vector<uint8_t> m_txrate;          //!< Rate of the current attempt
+    std::vector<uint8_t> m_nModes;          //!< Number of rates, 0 for a free row
+    std::vector<uint8_t> m_col;             //!< Column of the next sample
+    std::vector<uint8_t> m_index;           //!< Index of the next sample
+    std::vector<uint8_t> m_flags;           //!< Flags
+    std::vector<int32_t> m_totalPackets;    //!< Packets sent
+    std::vector<int32_t> m_samplePackets;   //!< Packets sent at a sampled rate
+    std::vector<int32_t> m_samplesDeferred; //!< Samples deferred, slower than the best rate
+    std::vector<uint32_t> m_shortRetry;     //!< RTS retries of the current packet
+    std::vector<uint32_t> m_longRetry;      //!< Data retries of the current packet
+
+    // per peer and rate
+    std::vector<int64_t> m_perfectTxTime;      //!< Transmission time without loss (us)
+    std::vector<uint32_t> m_attempts;          //!< Attempts since the last update
+    std::vector<uint32_t> m_successes;         //!< Successes since the last update
+    std::vector<uint32_t> m_throughput;        //!< Expected throughput
+    std::vector<uint16_t> m_ewmaProb;          //!< EWMA of the probability of success
+    std::vector<uint8_t> m_retryCount;         //!< Retries within 6 ms
+    std::vector<uint8_t> m_adjustedRetryCount; //!< Retries allowed
+    std::vector<uint8_t> m_samplesSkipped;     //!< Updates without an attempt
+    std::vector<uint8_t> m_sampled;            //!< True once an attempt succeeded
+    std::vector<int8_t> m_sampleLimit;         //!< Samples left, -1 for no limit
+    std::vector<uint8_t> m_sampleTable;        //!< Sample tables, rate x column
+};
+
+NS_OBJECT_ENSURE_REGISTERED(CompactMinstrelWifiManager);
+
+} // namespace ns3
+
+#endif /* COMPACT_MINSTREL_WIFI_MANAGER_H */
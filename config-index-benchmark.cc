@@ -0,0 +1,118 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Compares Config::Set path resolution with ConfigIndex (config-index.h)
+// on a large adhoc Wi-Fi topology:
+//
+//  - one wildcard set of an attribute of every PHY
+//  - one set per node, through a "/NodeList/<i>/..." path
+//
+// ./ns3 run "config-index-benchmark --numNodes=10000 --perNodeSets=1000"
+//
+
+#include "config-index.h"
+
+#include "ns3/command-line.h"
+#include "ns3/config.h"
+#include "ns3/double.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/log.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-helper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ConfigIndexBenchmark");
+
+/**
+ * \param start The start of the measurement.
+ * \return the wall-clock time elapsed since start, in milliseconds.
+ */
+static double
+ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t numNodes = 10000;
+    uint32_t perNodeSets = 1000;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("numNodes", "number of nodes", numNodes);
+    cmd.AddValue("perNodeSets", "number of per-node sets to time", perNodeSets);
+    cmd.Parse(argc, argv);
+    perNodeSets = std::min(perNodeSets, numNodes);
+
+    NodeContainer c;
+    c.Create(numNodes);
+
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211a);
+    YansWifiPhyHelper wifiPhy;
+    wifiPhy.SetChannel(YansWifiChannelHelper::Default().Create());
+    WifiMacHelper wifiMac;
+    wifiMac.SetType("ns3::AdhocWifiMac");
+    auto start = std::chrono::steady_clock::now();
+    wifi.Install(wifiPhy, wifiMac, c);
+    InternetStackHelper internet;
+    internet.Install(c);
+    std::cout << "Topology setup:        " << ElapsedMs(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    Config::Set("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/TxPowerStart",
+                DoubleValue(15));
+    std::cout << "Config wildcard set:   " << ElapsedMs(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < perNodeSets; i++)
+    {
+        std::ostringstream path;
+        path << "/NodeList/" << i << "/DeviceList/*/$ns3::WifiNetDevice/Phy/TxPowerEnd";
+        Config::Set(path.str(), DoubleValue(15));
+    }
+    std::cout << "Config per-node sets:  " << ElapsedMs(start) << " ms for " << perNodeSets
+              << " nodes" << std::endl;
+
+    ConfigIndex configIndex;
+    start = std::chrono::steady_clock::now();
+    configIndex.Find("ns3::WifiPhy");
+    std::cout << "Index build:           " << ElapsedMs(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    uint32_t count = configIndex.Set("ns3::WifiPhy", "TxPowerStart", DoubleValue(16));
+    std::cout << "Index wildcard set:    " << ElapsedMs(start) << " ms (" << count << " PHYs)"
+              << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < perNodeSets; i++)
+    {
+        configIndex.Set(i, "ns3::WifiPhy", "TxPowerEnd", DoubleValue(16));
+    }
+    std::cout << "Index per-node sets:   " << ElapsedMs(start) << " ms for " << perNodeSets
+              << " nodes" << std::endl;
+
+    Simulator::Destroy();
+    return 0;
+}
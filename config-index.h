@@ -0,0 +1,287 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CONFIG_INDEX_H
+#define CONFIG_INDEX_H
+
+#include "ns3/abort.h"
+#include "ns3/node-list.h"
+#include "ns3/object-ptr-container.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Index of the objects reachable from the NodeList, by type and by node.
+ *
+ * A wildcard Config::Set such as
+ * "/NodeList/ * /DeviceList/ * /$ns3::WifiNetDevice/Phy/TxPowerStart"
+ * walks and matches every node, device and aggregated object on each call,
+ * and so does a per-node "/NodeList/5/..." path, since container segments
+ * are matched against every element.  The index walks the object graph once
+ * (aggregates, pointer attributes and object containers) and then answers
+ * "every object of type T", optionally restricted to one node, directly.
+ *
+ * The index is built lazily on first use, rebuilt when nodes have been
+ * created since, and released on Simulator::Destroy.  Call Invalidate ()
+ * after adding devices or applications to existing nodes.
+ */
+class ConfigIndex
+{
+  public:
+    ConfigIndex() = default;
+
+    ~ConfigIndex()
+    {
+        if (m_destroyEvent.PeekEventImpl() != nullptr)
+        {
+            Simulator::Cancel(m_destroyEvent);
+        }
+    }
+
+    ConfigIndex(const ConfigIndex&) = delete;
+    ConfigIndex& operator=(const ConfigIndex&) = delete;
+
+    /**
+     * \brief Set an attribute on every object of a type, or of a subclass of it.
+     *
+     * \param typeName The type, e.g. "ns3::WifiPhy".
+     * \param attribute The attribute name.
+     * \param value The new value.
+     * \return the number of objects set.
+     */
+    uint32_t Set(const std::string& typeName,
+                 const std::string& attribute,
+                 const AttributeValue& value)
+    {
+        uint32_t count = 0;
+        for (const auto& object : Find(typeName))
+        {
+            object->SetAttribute(attribute, value);
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * \brief Set an attribute on the objects of a type reachable from one node.
+     *
+     * \param nodeId The node id.
+     * \param typeName The type, e.g. "ns3::WifiPhy".
+     * \param attribute The attribute name.
+     * \param value The new value.
+     * \return the number of objects set.
+     */
+    uint32_t Set(uint32_t nodeId,
+                 const std::string& typeName,
+                 const std::string& attribute,
+                 const AttributeValue& value)
+    {
+        Update();
+        NS_ABORT_MSG_UNLESS(nodeId < m_nodeObjects.size(), "No node " << nodeId);
+        TypeId tid = TypeId::LookupByName(typeName);
+        uint32_t count = 0;
+        for (const auto& object : m_nodeObjects[nodeId])
+        {
+            if (Matches(object->GetInstanceTypeId(), tid))
+            {
+                object->SetAttribute(attribute, value);
+                count++;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * \param typeName The type name.
+     * \return every indexed object of that type or of a subclass of it.
+     */
+    std::vector<Ptr<Object>> Find(const std::string& typeName)
+    {
+        Update();
+        TypeId tid = TypeId::LookupByName(typeName);
+        std::vector<Ptr<Object>> objects;
+        for (const auto& [instanceTid, instances] : m_byType)
+        {
+            if (Matches(instanceTid, tid))
+            {
+                objects.insert(objects.end(), instances.begin(), instances.end());
+            }
+        }
+        return objects;
+    }
+
+    /**
+     * \return the number of indexed objects of each instance type.
+     */
+    std::map<TypeId, std::size_t> CountByType()
+    {
+        Update();
+        std::map<TypeId, std::size_t> counts;
+        for (const auto& [tid, instances] : m_byType)
+        {
+            counts[tid] = instances.size();
+        }
+        return counts;
+    }
+
+    /**
+     * \param nodeId The node id.
+     * \return the number of indexed objects first reached from the node.
+     */
+    std::size_t CountByNode(uint32_t nodeId)
+    {
+        Update();
+        return nodeId < m_nodeObjects.size() ? m_nodeObjects[nodeId].size() : 0;
+    }
+
+    /**
+     * \brief Drop the index; it is rebuilt on next use.
+     */
+    void Invalidate()
+    {
+        m_nodeObjects.clear();
+        m_byType.clear();
+        m_indexedNodes = 0;
+        m_built = false;
+    }
+
+    /**
+     * \return the number of times the index was built.
+     */
+    uint32_t GetBuildCount() const
+    {
+        return m_buildCount;
+    }
+
+  private:
+    /**
+     * \param instanceTid The type of an object.
+     * \param tid The requested type.
+     * \return true if instanceTid is tid or a subclass of it.
+     */
+    static bool Matches(TypeId instanceTid, TypeId tid)
+    {
+        return instanceTid == tid || instanceTid.IsChildOf(tid);
+    }
+
+    /**
+     * Release the index when the simulator is destroyed.
+     */
+    void DoDestroy()
+    {
+        Invalidate();
+        m_destroyEvent = EventId();
+    }
+
+    /**
+     * Build the index if it is missing or nodes were created since.
+     */
+    void Update()
+    {
+        if (m_built && m_indexedNodes == NodeList::GetNNodes())
+        {
+            return;
+        }
+        if (m_destroyEvent.PeekEventImpl() == nullptr)
+        {
+            m_destroyEvent = Simulator::ScheduleDestroy(&ConfigIndex::DoDestroy, this);
+        }
+        m_nodeObjects.assign(NodeList::GetNNodes(), {});
+        m_byType.clear();
+        std::set<Object*> visited;
+        for (auto it = NodeList::Begin(); it != NodeList::End(); ++it)
+        {
+            Visit(*it, (*it)->GetId(), visited);
+        }
+        m_indexedNodes = NodeList::GetNNodes();
+        m_built = true;
+        m_buildCount++;
+    }
+
+    /**
+     * Index an object and everything reachable from it, attributing them to a node.
+     *
+     * \param object The object.
+     * \param nodeId The node the walk started from.
+     * \param visited Objects already indexed.
+     */
+    void Visit(Ptr<Object> object, uint32_t nodeId, std::set<Object*>& visited)
+    {
+        if (!object || !visited.insert(PeekPointer(object)).second)
+        {
+            return;
+        }
+        m_nodeObjects[nodeId].push_back(object);
+        m_byType[object->GetInstanceTypeId()].push_back(object);
+
+        Object::AggregateIterator aggregates = object->GetAggregateIterator();
+        while (aggregates.HasNext())
+        {
+            Visit(ConstCast<Object>(aggregates.Next()), nodeId, visited);
+        }
+
+        for (TypeId tid = object->GetInstanceTypeId(); tid != Object::GetTypeId();
+             tid = tid.GetParent())
+        {
+            for (std::size_t i = 0; i < tid.GetAttributeN(); i++)
+            {
+                TypeId::AttributeInformation info = tid.GetAttribute(i);
+                if (!(info.flags & TypeId::ATTR_GET))
+                {
+                    continue;
+                }
+                if (dynamic_cast<const PointerChecker*>(PeekPointer(info.checker)))
+                {
+                    PointerValue ptr;
+                    if (object->GetAttributeFailSafe(info.name, ptr))
+                    {
+                        Visit(ptr.Get<Object>(), nodeId, visited);
+                    }
+                }
+                else if (dynamic_cast<const ObjectPtrContainerChecker*>(
+                             PeekPointer(info.checker)))
+                {
+                    ObjectPtrContainerValue container;
+                    if (object->GetAttributeFailSafe(info.name, container))
+                    {
+                        for (auto it = container.Begin(); it != container.End(); ++it)
+                        {
+                            Visit(it->second, nodeId, visited);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<std::vector<Ptr<Object>>> m_nodeObjects;  //!< Indexed objects, by node id
+    std::map<TypeId, std::vector<Ptr<Object>>> m_byType; //!< Indexed objects, by instance type
+    uint32_t m_indexedNodes{0};                          //!< Number of nodes when built
+    bool m_built{false};                                 //!< Whether the index is valid
+    uint32_t m_buildCount{0};                            //!< Number of builds
+    EventId m_destroyEvent;                              //!< Release on Simulator::Destroy
+};
+
+} // namespace ns3
+
+#endif /* CONFIG_INDEX_H */
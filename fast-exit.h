@@ -0,0 +1,212 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FAST_EXIT_H
+#define FAST_EXIT_H
+
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/simulator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Process exit that skips Simulator::Destroy.
+ *
+ * Simulator::Destroy disposes every object of the topology one at a time,
+ * which on large grids takes longer than the run itself, only for the
+ * process to exit right after.  When fast exit is enabled, Finish () flushes
+ * the registered output streams, the standard streams and stdio, and ends
+ * the process with std::_Exit, leaving the memory to the kernel.
+ *
+ * Only registered streams are flushed: register every file still open at
+ * the end of the run (ascii traces, routing table dumps, plot files).
+ * Streams that cannot be reached, such as the files behind pcap traces, are
+ * only flushed by their destructors; a program that enables them calls
+ * RequireDestroy () and Finish () then falls back to Simulator::Destroy.
+ *
+ * With verification on, Finish () checks that every registered stream is
+ * still good and that the size of its file matches what was written to it,
+ * and exits with status 1 otherwise.
+ */
+class FastExit
+{
+  public:
+    /**
+     * \brief Enable or disable fast exit.
+     *
+     * \param enable Whether Finish () may skip Simulator::Destroy.
+     * \param verify Whether to check the registered files before exiting.
+     */
+    static void Enable(bool enable, bool verify = false)
+    {
+        GetState().enabled = enable;
+        GetState().verify = verify;
+    }
+
+    /**
+     * \brief Require a full Simulator::Destroy, e.g. because pcap tracing is on.
+     */
+    static void RequireDestroy()
+    {
+        GetState().destroyRequired = true;
+    }
+
+    /**
+     * \return true if Finish () will skip Simulator::Destroy.
+     */
+    static bool IsActive()
+    {
+        return GetState().enabled && !GetState().destroyRequired;
+    }
+
+    /**
+     * \brief Register a stream to flush before exiting.
+     *
+     * \param os The stream; it must stay alive until Finish ().
+     * \param filename The file written by the stream, checked when verifying;
+     *        empty if the stream is not a file.
+     */
+    static void Register(std::ostream* os, const std::string& filename = "")
+    {
+        GetState().streams.push_back({os, filename});
+    }
+
+    /**
+     * \brief Register a trace stream to flush before exiting.
+     *
+     * \param stream The stream wrapper; it is kept alive until exit.
+     * \param filename The file written by the stream.
+     */
+    static void Register(Ptr<OutputStreamWrapper> stream, const std::string& filename)
+    {
+        GetState().wrappers.push_back(stream);
+        Register(stream->GetStream(), filename);
+    }
+
+    /**
+     * \brief Flush the registered streams, the standard streams and stdio.
+     */
+    static void Flush()
+    {
+        for (const auto& stream : GetState().streams)
+        {
+            stream.os->flush();
+        }
+        std::cout.flush();
+        std::cerr.flush();
+        std::clog.flush();
+        std::fflush(nullptr);
+    }
+
+    /**
+     * \brief End the program.
+     *
+     * If fast exit is active, flush everything and exit the process with the
+     * given status; otherwise run Simulator::Destroy and return the status.
+     *
+     * \param status The exit status.
+     * \return status, when the process does not exit.
+     */
+    static int Finish(int status)
+    {
+        if (!IsActive())
+        {
+            Simulator::Destroy();
+            GetState().streams.clear();
+            GetState().wrappers.clear();
+            return status;
+        }
+        Flush();
+        if (GetState().verify && !Verify())
+        {
+            status = 1;
+        }
+        std::_Exit(status);
+    }
+
+  private:
+    /// A registered stream
+    struct Stream
+    {
+        std::ostream* os;     //!< The stream
+        std::string filename; //!< Its file, if any
+    };
+
+    /// Fast exit configuration and registered streams
+    struct State
+    {
+        bool enabled{false};                            //!< Whether fast exit is enabled
+        bool verify{false};                             //!< Whether to check the files on exit
+        bool destroyRequired{false};                    //!< Whether Simulator::Destroy is needed
+        std::vector<Stream> streams;                    //!< Streams to flush
+        std::vector<Ptr<OutputStreamWrapper>> wrappers; //!< Trace streams kept alive
+    };
+
+    /**
+     * \return the process-wide state.
+     */
+    static State& GetState()
+    {
+        static State state;
+        return state;
+    }
+
+    /**
+     * Check that the registered files hold everything written to them.
+     *
+     * \return true if no output was lost.
+     */
+    static bool Verify()
+    {
+        bool ok = true;
+        for (const auto& stream : GetState().streams)
+        {
+            if (!stream.os->good())
+            {
+                std::cerr << "FastExit: stream for '" << stream.filename << "' is in error"
+                          << std::endl;
+                ok = false;
+                continue;
+            }
+            if (stream.filename.empty())
+            {
+                continue;
+            }
+            struct stat st;
+            std::streamoff size = stat(stream.filename.c_str(), &st) == 0 ? st.st_size : -1;
+            std::streamoff written = stream.os->tellp();
+            if (size != written)
+            {
+                std::cerr << "FastExit: " << stream.filename << " holds " << size << " bytes, "
+                          << written << " written" << std::endl;
+                ok = false;
+            }
+        }
+        return ok;
+    }
+};
+
+} // namespace ns3
+
+#endif /* FAST_EXIT_H */
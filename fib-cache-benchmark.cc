@@ -0,0 +1,357 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Forwarding cost of multi-hop routing, with and without the FibCache
+// (fib-cache.h) in the Ipv4ListRouting of every node.
+//
+// By default, gridSize x gridSize nodes are linked to their horizontal and
+// vertical neighbors by point-to-point links and run OLSR, with static
+// routing behind it, as wifi-multirate does.  Once OLSR has converged,
+// numFlows UDP flows between random nodes cross the grid.  Every
+// churnInterval seconds a random link goes down and the previous one comes
+// back up: OLSR recomputes its tables, and the caches drop the destinations
+// whose route changed.
+//
+// With --chain=1, numHops + 1 nodes are chained instead and run static
+// routing only.  Every node holds numRoutes host routes to unused
+// destinations plus the route to the end of the chain, and the first node
+// sends numPackets UDP packets to the last one.  Every churnInterval seconds
+// one more host route is added on every node, as an operator editing static
+// routes would do, and the caches empty themselves.
+//
+// ./ns3 run "fib-cache-benchmark --gridSize=10 --numFlows=50 --fib=0"
+// ./ns3 run "fib-cache-benchmark --gridSize=10 --numFlows=50 --fib=1"
+// ./ns3 run "fib-cache-benchmark --chain=1 --numPackets=20000 --churnInterval=1 --fib=0"
+// ./ns3 run "fib-cache-benchmark --chain=1 --numPackets=20000 --churnInterval=1 --fib=1"
+//
+
+#include "fib-cache.h"
+
+#include "ns3/command-line.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-list-routing-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/log.h"
+#include "ns3/olsr-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/string.h"
+#include "ns3/udp-client-server-helper.h"
+#include "ns3/uinteger.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("FibCacheBenchmark");
+
+uint32_t g_churnRoutes = 0; //!< Host routes added by the route churn
+
+/**
+ * \param start The start of the measurement.
+ * \return the wall-clock time elapsed since start, in milliseconds.
+ */
+double
+ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+/**
+ * \brief Bring the link taken down last back up, and take a random one down.
+ *
+ * \param links The links of the grid.
+ * \param down The link down, links.size () for none.
+ * \param uv The link draw.
+ * \param interval The time to the next churn.
+ */
+void
+ChurnLinks(const std::vector<Ipv4InterfaceContainer>* links,
+           uint32_t down,
+           Ptr<UniformRandomVariable> uv,
+           Time interval)
+{
+    if (down < links->size())
+    {
+        for (uint32_t end = 0; end < 2; end++)
+        {
+            (*links)[down].Get(end).first->SetUp((*links)[down].Get(end).second);
+        }
+    }
+    down = uv->GetInteger(0, links->size() - 1);
+    for (uint32_t end = 0; end < 2; end++)
+    {
+        (*links)[down].Get(end).first->SetDown((*links)[down].Get(end).second);
+    }
+    Simulator::Schedule(interval, &ChurnLinks, links, down, uv, interval);
+}
+
+/**
+ * \brief Add a host route on every node.
+ *
+ * \param nodes The nodes.
+ * \param interval The time to the next churn.
+ */
+void
+ChurnRoutes(NodeContainer nodes, Time interval)
+{
+    Ipv4StaticRoutingHelper staticRouting;
+    Ipv4Address destination(0xac100000 + g_churnRoutes++); // 172.16/12
+    for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+    {
+        staticRouting.GetStaticRouting((*it)->GetObject<Ipv4>())->AddHostRouteTo(destination, 1);
+    }
+    Simulator::Schedule(interval, &ChurnRoutes, nodes, interval);
+}
+
+/**
+ * \brief Build the OLSR grid and its random flows.
+ *
+ * \param c The nodes, created.
+ * \param gridSize The nodes per side of the grid.
+ * \param numFlows The number of flows.
+ * \param numPackets The packets sent by each flow.
+ * \param warmup The time given to OLSR to converge before the flows.
+ * \param churnInterval The interval between link failures, zero for none.
+ * \param fib Whether to cache the forwarding decisions.
+ * \param links The links of the grid, filled.
+ * \return the sink applications.
+ */
+ApplicationContainer
+SetupGrid(NodeContainer& c,
+          uint32_t gridSize,
+          uint32_t numFlows,
+          uint32_t numPackets,
+          Time warmup,
+          Time churnInterval,
+          bool fib,
+          std::vector<Ipv4InterfaceContainer>& links)
+{
+    c.Create(gridSize * gridSize);
+
+    OlsrHelper olsr;
+    Ipv4StaticRoutingHelper staticRouting;
+    Ipv4ListRoutingHelper list;
+    list.Add(staticRouting, 0);
+    list.Add(olsr, 10);
+    if (fib)
+    {
+        FibCacheHelper::Install(list);
+    }
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(list);
+    internet.Install(c);
+
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("1Gbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("1us"));
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.252");
+    for (uint32_t i = 0; i < c.GetN(); i++)
+    {
+        if (i % gridSize + 1 < gridSize)
+        {
+            links.push_back(address.Assign(p2p.Install(c.Get(i), c.Get(i + 1))));
+            address.NewNetwork();
+        }
+        if (i + gridSize < c.GetN())
+        {
+            links.push_back(address.Assign(p2p.Install(c.Get(i), c.Get(i + gridSize))));
+            address.NewNetwork();
+        }
+    }
+
+    // flows between random distinct nodes, addressed to an interface of the sink
+    Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
+    UdpServerHelper server(9);
+    ApplicationContainer serverApps = server.Install(c);
+    ApplicationContainer clientApps;
+    for (uint32_t f = 0; f < numFlows; f++)
+    {
+        uint32_t source = uv->GetInteger(0, c.GetN() - 1);
+        uint32_t sink = uv->GetInteger(0, c.GetN() - 2);
+        sink += sink >= source ? 1 : 0;
+        Ptr<Ipv4> ipv4 = c.Get(sink)->GetObject<Ipv4>();
+        UdpClientHelper client(ipv4->GetAddress(1, 0).GetLocal(), 9);
+        client.SetAttribute("MaxPackets", UintegerValue(numPackets));
+        client.SetAttribute("Interval", TimeValue(MilliSeconds(1)));
+        client.SetAttribute("PacketSize", UintegerValue(64));
+        clientApps.Add(client.Install(c.Get(source)));
+    }
+    clientApps.Start(warmup);
+
+    if (churnInterval.IsStrictlyPositive())
+    {
+        Simulator::Schedule(warmup, &ChurnLinks, &links, links.size(), uv, churnInterval);
+    }
+    Simulator::Stop(warmup + Seconds(1) + MilliSeconds(numPackets));
+    return serverApps;
+}
+
+/**
+ * \brief Build the static chain, its host routes and its flow.
+ *
+ * \param c The nodes, created.
+ * \param numHops The number of hops of the chain.
+ * \param numRoutes The unused host routes on every node.
+ * \param numPackets The packets sent along the chain.
+ * \param churnInterval The interval between route additions, zero for none.
+ * \param fib Whether to cache the forwarding decisions.
+ * \param links The links of the chain, filled.
+ * \return the sink application.
+ */
+ApplicationContainer
+SetupChain(NodeContainer& c,
+           uint32_t numHops,
+           uint32_t numRoutes,
+           uint32_t numPackets,
+           Time churnInterval,
+           bool fib,
+           std::vector<Ipv4InterfaceContainer>& links)
+{
+    c.Create(numHops + 1);
+
+    Ipv4StaticRoutingHelper staticRouting;
+    Ipv4ListRoutingHelper list;
+    list.Add(staticRouting, 0);
+    if (fib)
+    {
+        FibCacheHelper::Install(list);
+    }
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(list);
+    internet.Install(c);
+
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("1Gbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("1us"));
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.252");
+    for (uint32_t i = 0; i < numHops; i++)
+    {
+        links.push_back(address.Assign(p2p.Install(c.Get(i), c.Get(i + 1))));
+        address.NewNetwork();
+    }
+    Ipv4Address sink = links.back().GetAddress(1);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < numHops; i++)
+    {
+        Ptr<Ipv4StaticRouting> routing =
+            staticRouting.GetStaticRouting(c.Get(i)->GetObject<Ipv4>());
+        Ipv4Address nextHop = links[i].GetAddress(1);
+        uint32_t interface = links[i].Get(0).second;
+        for (uint32_t r = 0; r < numRoutes; r++)
+        {
+            routing->AddHostRouteTo(Ipv4Address(0x0b000000 + r), nextHop, interface); // 11/8
+        }
+        routing->AddHostRouteTo(sink, nextHop, interface);
+    }
+    std::cout << "Routes installed in " << ElapsedMs(start) << " ms" << std::endl;
+
+    UdpServerHelper server(9);
+    ApplicationContainer serverApp = server.Install(c.Get(numHops));
+    UdpClientHelper client(sink, 9);
+    client.SetAttribute("MaxPackets", UintegerValue(numPackets));
+    client.SetAttribute("Interval", TimeValue(MicroSeconds(100)));
+    client.SetAttribute("PacketSize", UintegerValue(64));
+    ApplicationContainer clientApp = client.Install(c.Get(0));
+    clientApp.Start(Seconds(0.1));
+
+    if (churnInterval.IsStrictlyPositive())
+    {
+        Simulator::Schedule(churnInterval, &ChurnRoutes, c, churnInterval);
+    }
+    Simulator::Stop(Seconds(0.2) + MicroSeconds(100) * numPackets);
+    return serverApp;
+}
+
+int
+main(int argc, char* argv[])
+{
+    bool chain = false;
+    uint32_t gridSize = 10;
+    uint32_t numFlows = 50;
+    uint32_t numHops = 16;
+    uint32_t numRoutes = 5000;
+    uint32_t numPackets = 2000;
+    double warmup = 30;        // s
+    double churnInterval = 10; // s
+    bool fib = false;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("chain", "static host routes along a chain instead of the OLSR grid", chain);
+    cmd.AddValue("gridSize", "nodes per side of the grid", gridSize);
+    cmd.AddValue("numFlows", "number of UDP flows between random nodes of the grid", numFlows);
+    cmd.AddValue("numHops", "number of hops of the chain", numHops);
+    cmd.AddValue("numRoutes", "unused host routes on every node of the chain", numRoutes);
+    cmd.AddValue("numPackets", "packets sent by each flow", numPackets);
+    cmd.AddValue("warmup", "time (s) given to OLSR to converge before the flows", warmup);
+    cmd.AddValue("churnInterval",
+                 "interval between link failures, or route additions on the chain (s), "
+                 "0 for none",
+                 churnInterval);
+    cmd.AddValue("fib", "cache the forwarding decisions", fib);
+    cmd.Parse(argc, argv);
+
+    NodeContainer c;
+    std::vector<Ipv4InterfaceContainer> links;
+    ApplicationContainer serverApps =
+        chain ? SetupChain(c, numHops, numRoutes, numPackets, Seconds(churnInterval), fib, links)
+              : SetupGrid(c,
+                          gridSize,
+                          numFlows,
+                          numPackets,
+                          Seconds(warmup),
+                          Seconds(churnInterval),
+                          fib,
+                          links);
+
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Run();
+    double wall = ElapsedMs(start);
+
+    uint64_t received = 0;
+    for (uint32_t i = 0; i < serverApps.GetN(); i++)
+    {
+        received += DynamicCast<UdpServer>(serverApps.Get(i))->GetReceived();
+    }
+    std::cout << (fib ? "FIB cache" : "Ipv4ListRouting") << ": ";
+    if (chain)
+    {
+        std::cout << numHops << " hops, " << numRoutes + 1 << " host routes per node" << std::endl;
+        numFlows = 1;
+    }
+    else
+    {
+        std::cout << gridSize << "x" << gridSize << " OLSR grid, " << numFlows << " flows"
+                  << std::endl;
+    }
+    std::cout << "Received " << received << " of " << uint64_t(numFlows) * numPackets
+              << " packets, " << Simulator::GetEventCount() << " events in " << wall << " ms"
+              << std::endl;
+    if (fib)
+    {
+        FibCacheHelper::PrintStatistics(std::cout, c);
+    }
+    Simulator::Destroy();
+    return 0;
+}
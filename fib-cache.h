@@ -0,0 +1,496 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FIB_CACHE_H
+#define FIB_CACHE_H
+
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/ipv4-list-routing-helper.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4.h"
+#include "ns3/node-container.h"
+#include "ns3/olsr-routing-protocol.h"
+#include "ns3/output-stream-wrapper.h"
+
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Forwarding-table cache, the first protocol of an Ipv4ListRouting.
+ *
+ * Ipv4ListRouting asks each of its protocols in turn for every packet sent
+ * or forwarded; Ipv4StaticRouting scans all of its routes for the longest
+ * prefix and OLSR searches its table.  FibCache is added to the list at the
+ * highest priority (FibCacheHelper::Install) and remembers the route the
+ * other protocols of the list return for each unicast destination, for
+ * locally sent packets (RouteOutput without an output device) and for
+ * forwarded packets (RouteInput); the following lookups of that
+ * destination are answered with one hash lookup.  The list and its
+ * protocols are left in place, so Ipv4RoutingHelper::GetRouting<> and
+ * Ipv4StaticRoutingHelper::GetStaticRouting find them as usual.
+ *
+ * Cached routes are dropped when they may have changed:
+ *  - OLSR routes destination by destination: on the RoutingTableChanged
+ *    trace source of each OLSR protocol of the list, its table is compared
+ *    with the previous one and only the destinations whose next hop or
+ *    interface changed, appeared or disappeared are dropped;
+ *  - everything, on interface and address notifications, and when the
+ *    number of routes of an Ipv4StaticRouting of the list changes (checked
+ *    on every lookup); static route edits that keep the number of routes,
+ *    e.g. a removal and an addition between two packets, must be followed
+ *    by Invalidate ().
+ *
+ * A destination that no protocol routes is looked up twice: once by the
+ * cache and once more by the list.  Routes are cached by destination only:
+ * protocols that route on the source address or on the input interface
+ * must not be in the list.
+ */
+class FibCache : public Ipv4RoutingProtocol
+{
+  public:
+    static constexpr int16_t PRIORITY = INT16_MAX; //!< Priority of the cache in the list
+
+    /// Cache counters
+    struct Statistics
+    {
+        uint64_t hits{0};          //!< Lookups answered by the cache
+        uint64_t misses{0};        //!< Lookups passed to the other protocols
+        uint64_t invalidations{0}; //!< Destinations dropped on a routing table change
+        uint64_t rebuilds{0};      //!< Times the cache was emptied
+    };
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::FibCache")
+                                .SetParent<Ipv4RoutingProtocol>()
+                                .AddConstructor<FibCache>();
+        return tid;
+    }
+
+    /**
+     * \brief Empty the cache, e.g. after static routes were replaced.
+     */
+    void Invalidate()
+    {
+        if (!m_output.empty() || !m_forward.empty())
+        {
+            m_output.clear();
+            m_forward.clear();
+            m_statistics.rebuilds++;
+        }
+    }
+
+    /**
+     * \brief Drop the cached routes to one destination.
+     *
+     * \param destination The destination.
+     */
+    void Invalidate(Ipv4Address destination)
+    {
+        if (m_output.erase(destination) + m_forward.erase(destination) > 0)
+        {
+            m_statistics.invalidations++;
+        }
+    }
+
+    /**
+     * \return the cache counters.
+     */
+    const Statistics& GetStatistics() const
+    {
+        return m_statistics;
+    }
+
+    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
+                               const Ipv4Header& header,
+                               Ptr<NetDevice> oif,
+                               Socket::SocketErrno& sockerr) override
+    {
+        Ipv4Address destination = header.GetDestination();
+        if (oif || !IsUnicast(destination))
+        {
+            // left to the other protocols of the list
+            sockerr = Socket::ERROR_NOROUTETOHOST;
+            return nullptr;
+        }
+        CheckProtocols();
+        auto it = m_output.find(destination);
+        if (it != m_output.end())
+        {
+            m_statistics.hits++;
+            sockerr = Socket::ERROR_NOTERROR;
+            return it->second;
+        }
+        m_statistics.misses++;
+        for (const auto& protocol : m_protocols)
+        {
+            Ptr<Ipv4Route> route = protocol->RouteOutput(p, header, oif, sockerr);
+            if (route)
+            {
+                m_output[destination] = route;
+                sockerr = Socket::ERROR_NOTERROR;
+                return route;
+            }
+        }
+        sockerr = Socket::ERROR_NOROUTETOHOST;
+        return nullptr;
+    }
+
+    bool RouteInput(Ptr<const Packet> p,
+                    const Ipv4Header& header,
+                    Ptr<const NetDevice> idev,
+                    const UnicastForwardCallback& ucb,
+                    const MulticastForwardCallback& mcb,
+                    const LocalDeliverCallback& lcb,
+                    const ErrorCallback& ecb) override
+    {
+        // only forwarded unicast packets are cached; a packet that comes back
+        // to its own source is left to the other protocols, which drop it
+        Ipv4Address destination = header.GetDestination();
+        int32_t iif = m_ipv4->GetInterfaceForDevice(idev);
+        if (iif < 0 || !IsUnicast(destination) ||
+            m_ipv4->IsDestinationAddress(destination, iif) || !m_ipv4->IsForwarding(iif) ||
+            IsLocalAddress(header.GetSource()))
+        {
+            return false;
+        }
+        CheckProtocols();
+        auto it = m_forward.find(destination);
+        if (it != m_forward.end())
+        {
+            m_statistics.hits++;
+            ucb(it->second, p, header);
+            return true;
+        }
+        m_statistics.misses++;
+        UnicastForwardCallback forward = MakeBoundCallback(&FibCache::Forward, this, ucb);
+        for (const auto& protocol : m_protocols)
+        {
+            if (protocol->RouteInput(p, header, idev, forward, mcb, lcb, ecb))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void NotifyInterfaceUp(uint32_t interface) override
+    {
+        Invalidate();
+    }
+
+    void NotifyInterfaceDown(uint32_t interface) override
+    {
+        Invalidate();
+    }
+
+    void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override
+    {
+        Invalidate();
+    }
+
+    void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override
+    {
+        Invalidate();
+    }
+
+    void SetIpv4(Ptr<Ipv4> ipv4) override
+    {
+        m_ipv4 = ipv4;
+    }
+
+    void PrintRoutingTable(Ptr<OutputStreamWrapper> stream,
+                           Time::Unit unit = Time::S) const override
+    {
+        *stream->GetStream() << "FIB cache: " << m_output.size() + m_forward.size()
+                             << " entries, " << m_statistics.hits << " hits, "
+                             << m_statistics.misses << " misses, "
+                             << m_statistics.invalidations << " invalidations, "
+                             << m_statistics.rebuilds << " rebuilds" << std::endl;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_output.clear();
+        m_forward.clear();
+        m_protocols.clear();
+        m_statics.clear();
+        m_olsrs.clear();
+        m_ipv4 = nullptr;
+        Ipv4RoutingProtocol::DoDispose();
+    }
+
+  private:
+    /// Routes by destination
+    using RouteMap = std::unordered_map<Ipv4Address, Ptr<Ipv4Route>, Ipv4AddressHash>;
+    /// OLSR next hop and interface, by destination
+    using NextHopMap =
+        std::unordered_map<Ipv4Address, std::pair<Ipv4Address, uint32_t>, Ipv4AddressHash>;
+    /// A static routing protocol of the list, with its number of routes
+    using StaticTable = std::pair<Ptr<Ipv4StaticRouting>, uint32_t>;
+
+    /// An OLSR protocol of the list, with its last table
+    struct OlsrTable
+    {
+        Ptr<olsr::RoutingProtocol> protocol; //!< The protocol
+        NextHopMap routes;                   //!< Its routes at the last change
+    };
+
+    /**
+     * \param destination A destination address.
+     * \return true if packets to the destination may be cached.
+     */
+    static bool IsUnicast(Ipv4Address destination)
+    {
+        return !destination.IsMulticast() && !destination.IsBroadcast() &&
+               !destination.IsLocalhost() && !destination.IsAny();
+    }
+
+    /**
+     * \param address An address.
+     * \return true if the address is one of the addresses of the node.
+     */
+    bool IsLocalAddress(Ipv4Address address) const
+    {
+        for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+        {
+            for (uint32_t j = 0; j < m_ipv4->GetNAddresses(i); j++)
+            {
+                if (m_ipv4->GetAddress(i, j).GetLocal() == address)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * \brief Find the other protocols of the list on the first lookup, and
+     * empty the cache if a static routing table grew or shrank since the last.
+     */
+    void CheckProtocols()
+    {
+        if (!m_list)
+        {
+            FindProtocols();
+        }
+        for (auto& [routing, nRoutes] : m_statics)
+        {
+            if (routing->GetNRoutes() != nRoutes)
+            {
+                nRoutes = routing->GetNRoutes();
+                Invalidate();
+            }
+        }
+    }
+
+    /// Find the other protocols of the list and listen to the OLSR ones.
+    void FindProtocols()
+    {
+        m_list = DynamicCast<Ipv4ListRouting>(m_ipv4->GetRoutingProtocol());
+        NS_ABORT_MSG_UNLESS(m_list, "FibCache must be a protocol of an Ipv4ListRouting");
+        for (uint32_t i = 0; i < m_list->GetNRoutingProtocols(); i++)
+        {
+            int16_t priority;
+            Ptr<Ipv4RoutingProtocol> protocol = m_list->GetRoutingProtocol(i, priority);
+            if (protocol == this)
+            {
+                NS_ABORT_MSG_UNLESS(i == 0, "FibCache must have the highest priority of its list");
+                continue;
+            }
+            m_protocols.push_back(protocol);
+            if (Ptr<Ipv4StaticRouting> routing = DynamicCast<Ipv4StaticRouting>(protocol))
+            {
+                m_statics.emplace_back(routing, routing->GetNRoutes());
+            }
+            else if (Ptr<olsr::RoutingProtocol> olsr = DynamicCast<olsr::RoutingProtocol>(protocol))
+            {
+                m_olsrs.push_back({olsr, GetNextHops(olsr)});
+                bool connected = olsr->TraceConnectWithoutContext(
+                    "RoutingTableChanged",
+                    MakeCallback(&FibCache::NotifyRoutingTableChanged, this));
+                NS_ABORT_MSG_UNLESS(connected, "Cannot connect to RoutingTableChanged");
+            }
+        }
+    }
+
+    /**
+     * \param olsr An OLSR protocol.
+     * \return the next hop and interface of each of its destinations.
+     */
+    static NextHopMap GetNextHops(Ptr<olsr::RoutingProtocol> olsr)
+    {
+        NextHopMap routes;
+        for (const auto& entry : olsr->GetRoutingTableEntries())
+        {
+            routes[entry.destAddr] = {entry.nextAddr, entry.interface};
+        }
+        return routes;
+    }
+
+    /**
+     * Record the route chosen by the other protocols for a forwarded packet,
+     * and forward the packet.
+     *
+     * \param cache The cache.
+     * \param ucb The forwarding callback of the IP layer.
+     * \param route The route.
+     * \param p The packet.
+     * \param header Its IP header.
+     */
+    static void Forward(FibCache* cache,
+                        UnicastForwardCallback ucb,
+                        Ptr<Ipv4Route> route,
+                        Ptr<const Packet> p,
+                        const Ipv4Header& header)
+    {
+        cache->m_forward[header.GetDestination()] = route;
+        ucb(route, p, header);
+    }
+
+    /**
+     * \brief Drop the cached routes of the OLSR destinations whose route
+     * changed, appeared or disappeared.
+     *
+     * Called by the RoutingTableChanged trace source of the OLSR protocols,
+     * after every table computation.
+     */
+    void NotifyRoutingTableChanged(uint32_t /* size */)
+    {
+        for (auto& table : m_olsrs)
+        {
+            NextHopMap routes = GetNextHops(table.protocol);
+            for (const auto& [destination, nextHop] : routes)
+            {
+                auto it = table.routes.find(destination);
+                if (it == table.routes.end() || it->second != nextHop)
+                {
+                    Invalidate(destination);
+                }
+            }
+            for (const auto& [destination, nextHop] : table.routes)
+            {
+                if (routes.find(destination) == routes.end())
+                {
+                    Invalidate(destination);
+                }
+            }
+            table.routes.swap(routes);
+        }
+    }
+
+    Ptr<Ipv4> m_ipv4;                                  //!< The IP layer
+    Ptr<Ipv4ListRouting> m_list;                       //!< The list, once found
+    std::vector<Ptr<Ipv4RoutingProtocol>> m_protocols; //!< Other protocols of the list
+    std::vector<StaticTable> m_statics;                //!< Static protocols of the list
+    std::vector<OlsrTable> m_olsrs;                    //!< OLSR protocols of the list
+    RouteMap m_output;                                 //!< Routes of locally sent packets
+    RouteMap m_forward;                                //!< Routes of forwarded packets
+    Statistics m_statistics;                           //!< Cache counters
+};
+
+NS_OBJECT_ENSURE_REGISTERED(FibCache);
+
+/**
+ * Creates the FibCache of a node; added to an Ipv4ListRoutingHelper at the
+ * highest priority with Install.
+ */
+class FibCacheHelper : public Ipv4RoutingHelper
+{
+  public:
+    FibCacheHelper* Copy() const override
+    {
+        return new FibCacheHelper(*this);
+    }
+
+    Ptr<Ipv4RoutingProtocol> Create(Ptr<Node> node) const override
+    {
+        return CreateObject<FibCache>();
+    }
+
+    /**
+     * \brief Add a FibCache in front of the protocols of a list.
+     *
+     * \param list The helper of the list.
+     */
+    static void Install(Ipv4ListRoutingHelper& list)
+    {
+        list.Add(FibCacheHelper(), FibCache::PRIORITY);
+    }
+
+    /**
+     * \param node A node.
+     * \return its FibCache, or null.
+     */
+    static Ptr<FibCache> GetFibCache(Ptr<Node> node)
+    {
+        Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+        return ipv4 ? GetRouting<FibCache>(ipv4->GetRoutingProtocol()) : nullptr;
+    }
+
+    /**
+     * \param nodes The nodes.
+     * \return the sum of the counters of the caches installed on the nodes.
+     */
+    static FibCache::Statistics GetStatistics(NodeContainer nodes = NodeContainer::GetGlobal())
+    {
+        FibCache::Statistics total;
+        for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+        {
+            if (Ptr<FibCache> cache = GetFibCache(*it))
+            {
+                total.hits += cache->GetStatistics().hits;
+                total.misses += cache->GetStatistics().misses;
+                total.invalidations += cache->GetStatistics().invalidations;
+                total.rebuilds += cache->GetStatistics().rebuilds;
+            }
+        }
+        return total;
+    }
+
+    /**
+     * \param os The output stream.
+     * \param nodes The nodes.
+     */
+    static void PrintStatistics(std::ostream& os,
+                                NodeContainer nodes = NodeContainer::GetGlobal())
+    {
+        FibCache::Statistics total = GetStatistics(nodes);
+        os << "FIB cache: " << total.hits << " hits, " << total.misses << " misses, "
+           << total.invalidations << " invalidations, " << total.rebuilds << " rebuilds"
+           << std::endl;
+    }
+};
+
+} // namespace ns3
+
+#endif /* FIB_CACHE_H */
@@ -0,0 +1,472 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FILTERED_ASCII_TRACE_H
+#define FILTERED_ASCII_TRACE_H
+
+#include "ns3/abort.h"
+#include "ns3/amsdu-subframe-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/net-device-container.h"
+#include "ns3/nstime.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+#include "ns3/udp-header.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-mac-trailer.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy-state-helper.h"
+#include "ns3/wifi-phy.h"
+
+#include <cstdint>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace ns3
+{
+
+/**
+ * ASCII trace of the Wi-Fi PHYs, in the format of WifiPhyHelper::EnableAscii,
+ * that only formats the events passing a filter.
+ *
+ * Post-processing a full trace (e.g. grep ^t | grep Udp | grep -v olsr)
+ * formats and writes every event to keep a few.  Here the filter is applied
+ * before anything is formatted, from the cheapest test to the dearest:
+ *
+ *  - the event types (t, r and d for PHY drops) and the nodes select which
+ *    trace sources are connected at all, so excluded events cost nothing;
+ *  - the time window is a comparison with the current time;
+ *  - the protocols are found by deserializing the MAC, LLC, IPv4 and UDP
+ *    headers of a copy of the packet, only when a protocol filter is set.
+ *
+ * The filter is a list of key=value settings separated by ';':
+ *
+ *     events=tr;nodes=0,5,10;protocols=udp;exclude=olsr;start=30;stop=33
+ *
+ * Protocols are mgt, ctl, data, arp, ipv4, icmp, tcp, udp and olsr (UDP port
+ * 698); a packet is kept if it carries any of "protocols" (all if unset) and
+ * none of "exclude".  Frames are classified as single MPDUs, possibly
+ * carrying an A-MSDU, as sent by the non-HT PHYs of these programs.
+ */
+class FilteredAsciiTrace : public SimpleRefCount<FilteredAsciiTrace>
+{
+  public:
+    /// Protocols found in a frame
+    enum Protocol : uint16_t
+    {
+        MGT = 1 << 0,  //!< Management frame
+        CTL = 1 << 1,  //!< Control frame
+        DATA = 1 << 2, //!< Data frame
+        ARP = 1 << 3,  //!< ARP packet
+        IPV4 = 1 << 4, //!< IPv4 packet
+        ICMP = 1 << 5, //!< ICMP message
+        TCP = 1 << 6,  //!< TCP segment
+        UDP = 1 << 7,  //!< UDP datagram
+        OLSR = 1 << 8, //!< OLSR packet (UDP port 698)
+    };
+
+    /**
+     * \param stream The trace stream.
+     * \param filter The filter, empty to keep every event.
+     */
+    FilteredAsciiTrace(Ptr<OutputStreamWrapper> stream, const std::string& filter = "")
+        : m_stream(stream)
+    {
+        std::istringstream settings(filter);
+        std::string setting;
+        while (std::getline(settings, setting, ';'))
+        {
+            std::size_t equal = setting.find('=');
+            NS_ABORT_MSG_IF(equal == std::string::npos, "Bad trace filter setting " << setting);
+            std::string key = setting.substr(0, equal);
+            std::string value = setting.substr(equal + 1);
+            if (key == "events")
+            {
+                m_events = value;
+            }
+            else if (key == "nodes")
+            {
+                std::istringstream ids(value);
+                std::string id;
+                while (std::getline(ids, id, ','))
+                {
+                    m_nodes.insert(std::stoul(id));
+                }
+            }
+            else if (key == "protocols")
+            {
+                m_include = ParseProtocols(value);
+            }
+            else if (key == "exclude")
+            {
+                m_exclude = ParseProtocols(value);
+            }
+            else if (key == "start")
+            {
+                m_start = Seconds(std::stod(value));
+            }
+            else if (key == "stop")
+            {
+                m_stop = Seconds(std::stod(value));
+            }
+            else
+            {
+                NS_ABORT_MSG("Unknown trace filter key " << key);
+            }
+        }
+    }
+
+    /**
+     * \brief Trace the PHYs of the devices passing the node filter.
+     *
+     * \param devices The devices; those that are not WifiNetDevices are skipped.
+     * \return the number of PHYs traced.
+     */
+    uint32_t Enable(const NetDeviceContainer& devices)
+    {
+        uint32_t traced = 0;
+        for (auto it = devices.Begin(); it != devices.End(); ++it)
+        {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(*it);
+            uint32_t nodeId = (*it)->GetNode()->GetId();
+            if (!device || (!m_nodes.empty() && m_nodes.count(nodeId) == 0))
+            {
+                continue;
+            }
+            std::ostringstream oss;
+            oss << "/NodeList/" << nodeId << "/DeviceList/" << device->GetIfIndex()
+                << "/$ns3::WifiNetDevice/Phy/";
+            std::string context = oss.str();
+            Ptr<WifiPhy> phy = device->GetPhy();
+            Ptr<FilteredAsciiTrace> self(this);
+            if (HasEvent('t'))
+            {
+                NS_ABORT_MSG_UNLESS(phy->GetState()->TraceConnectWithoutContext(
+                                        "Tx",
+                                        MakeBoundCallback(&FilteredAsciiTrace::Transmit,
+                                                          self,
+                                                          context + "State/Tx")),
+                                    "Cannot connect to Tx of node " << nodeId);
+            }
+            if (HasEvent('r'))
+            {
+                NS_ABORT_MSG_UNLESS(phy->GetState()->TraceConnectWithoutContext(
+                                        "RxOk",
+                                        MakeBoundCallback(&FilteredAsciiTrace::Receive,
+                                                          self,
+                                                          context + "State/RxOk")),
+                                    "Cannot connect to RxOk of node " << nodeId);
+            }
+            if (HasEvent('d'))
+            {
+                NS_ABORT_MSG_UNLESS(phy->TraceConnectWithoutContext(
+                                        "PhyTxDrop",
+                                        MakeBoundCallback(&FilteredAsciiTrace::TxDrop,
+                                                          self,
+                                                          context + "PhyTxDrop")),
+                                    "Cannot connect to PhyTxDrop of node " << nodeId);
+                NS_ABORT_MSG_UNLESS(phy->TraceConnectWithoutContext(
+                                        "PhyRxDrop",
+                                        MakeBoundCallback(&FilteredAsciiTrace::RxDrop,
+                                                          self,
+                                                          context + "PhyRxDrop")),
+                                    "Cannot connect to PhyRxDrop of node " << nodeId);
+            }
+            traced++;
+        }
+        return traced;
+    }
+
+    /**
+     * \return the number of events written.
+     */
+    uint64_t GetWritten() const
+    {
+        return m_written;
+    }
+
+    /**
+     * \return the number of events of the traced sources discarded.
+     */
+    uint64_t GetDiscarded() const
+    {
+        return m_discarded;
+    }
+
+    /**
+     * \param packet A frame, starting with its MAC header.
+     * \return the protocols found in the frame.
+     */
+    static uint16_t Classify(Ptr<const Packet> packet)
+    {
+        Ptr<Packet> copy = packet->Copy();
+        WifiMacHeader mac;
+        copy->RemoveHeader(mac);
+        if (mac.IsMgt())
+        {
+            return MGT;
+        }
+        if (mac.IsCtl())
+        {
+            return CTL;
+        }
+        uint16_t found = DATA;
+        if (mac.IsQosData() && mac.IsQosAmsdu())
+        {
+            // the first subframe stands for the A-MSDU
+            AmsduSubframeHeader subframe;
+            if (copy->GetSize() < subframe.GetSerializedSize())
+            {
+                return found;
+            }
+            copy->RemoveHeader(subframe);
+        }
+        LlcSnapHeader llc;
+        if (copy->GetSize() < llc.GetSerializedSize())
+        {
+            return found;
+        }
+        copy->RemoveHeader(llc);
+        if (llc.GetType() == 0x0806)
+        {
+            return found | ARP;
+        }
+        Ipv4Header ip;
+        if (llc.GetType() != 0x0800 || copy->GetSize() < ip.GetSerializedSize())
+        {
+            return found;
+        }
+        copy->RemoveHeader(ip);
+        found |= IPV4;
+        if (ip.GetFragmentOffset() != 0)
+        {
+            // only the first fragment carries the transport header
+            return found;
+        }
+        UdpHeader udp;
+        switch (ip.GetProtocol())
+        {
+        case 1:
+            return found | ICMP;
+        case 6:
+            return found | TCP;
+        case UdpHeader::PROT_NUMBER:
+            if (copy->GetSize() < udp.GetSerializedSize())
+            {
+                return found | UDP;
+            }
+            copy->RemoveHeader(udp);
+            found |= UDP;
+            if (udp.GetSourcePort() == OLSR_PORT || udp.GetDestinationPort() == OLSR_PORT)
+            {
+                found |= OLSR;
+            }
+            return found;
+        default:
+            return found;
+        }
+    }
+
+    /**
+     * \param list Comma-separated protocol names.
+     * \return the protocols.
+     */
+    static uint16_t ParseProtocols(const std::string& list)
+    {
+        static const std::pair<const char*, uint16_t> names[] = {{"mgt", MGT},
+                                                                 {"ctl", CTL},
+                                                                 {"data", DATA},
+                                                                 {"arp", ARP},
+                                                                 {"ipv4", IPV4},
+                                                                 {"icmp", ICMP},
+                                                                 {"tcp", TCP},
+                                                                 {"udp", UDP},
+                                                                 {"olsr", OLSR}};
+        uint16_t protocols = 0;
+        std::istringstream iss(list);
+        std::string name;
+        while (std::getline(iss, name, ','))
+        {
+            bool known = false;
+            for (const auto& [protocolName, protocol] : names)
+            {
+                if (name == protocolName)
+                {
+                    protocols |= protocol;
+                    known = true;
+                }
+            }
+            NS_ABORT_MSG_UNLESS(known, "Unknown protocol " << name << " in trace filter");
+        }
+        return protocols;
+    }
+
+  private:
+    static constexpr uint16_t OLSR_PORT = 698; //!< OLSR UDP port
+
+    /**
+     * \param event The event type.
+     * \return true if the event type is traced.
+     */
+    bool HasEvent(char event) const
+    {
+        return m_events.find(event) != std::string::npos;
+    }
+
+    /**
+     * \param packet The frame of an event of a traced source.
+     * \return true if the event is to be written.
+     */
+    bool Keep(Ptr<const Packet> packet)
+    {
+        Time now = Simulator::Now();
+        bool keep = now >= m_start && (m_stop.IsZero() || now < m_stop);
+        if (keep && (m_include != 0 || m_exclude != 0))
+        {
+            uint16_t protocols = Classify(packet);
+            keep = (m_include == 0 || (protocols & m_include) != 0) &&
+                   (protocols & m_exclude) == 0;
+        }
+        if (keep)
+        {
+            m_written++;
+        }
+        else
+        {
+            m_discarded++;
+        }
+        return keep;
+    }
+
+    /**
+     * \param event The event type.
+     * \param context The trace context.
+     * \return the trace stream, with the event type, time and context written.
+     */
+    std::ostream& Begin(char event, const std::string& context)
+    {
+        std::ostream& os = *m_stream->GetStream();
+        os << event << " " << Simulator::Now().GetSeconds() << " " << context << " ";
+        return os;
+    }
+
+    /**
+     * \param os The trace stream.
+     * \param packet The frame, printed without its FCS as WifiPhyHelper does.
+     */
+    static void PrintFrame(std::ostream& os, Ptr<const Packet> packet)
+    {
+        Ptr<Packet> copy = packet->Copy();
+        WifiMacTrailer fcs;
+        copy->RemoveTrailer(fcs);
+        os << *copy << " " << fcs << std::endl;
+    }
+
+    /**
+     * \param trace The trace.
+     * \param context The trace context.
+     * \param packet The transmitted frame.
+     * \param mode The transmission mode.
+     * \param preamble The preamble.
+     * \param txLevel The transmit power level.
+     */
+    static void Transmit(Ptr<FilteredAsciiTrace> trace,
+                         std::string context,
+                         Ptr<const Packet> packet,
+                         WifiMode mode,
+                         WifiPreamble preamble,
+                         uint8_t txLevel)
+    {
+        if (trace->Keep(packet))
+        {
+            std::ostream& os = trace->Begin('t', context);
+            os << mode << " ";
+            PrintFrame(os, packet);
+        }
+    }
+
+    /**
+     * \param trace The trace.
+     * \param context The trace context.
+     * \param packet The received frame.
+     * \param snr The SNR.
+     * \param mode The reception mode.
+     * \param preamble The preamble.
+     */
+    static void Receive(Ptr<FilteredAsciiTrace> trace,
+                        std::string context,
+                        Ptr<const Packet> packet,
+                        double snr,
+                        WifiMode mode,
+                        WifiPreamble preamble)
+    {
+        if (trace->Keep(packet))
+        {
+            std::ostream& os = trace->Begin('r', context);
+            os << mode << " ";
+            PrintFrame(os, packet);
+        }
+    }
+
+    /**
+     * \param trace The trace.
+     * \param context The trace context.
+     * \param packet The frame dropped before transmission.
+     */
+    static void TxDrop(Ptr<FilteredAsciiTrace> trace, std::string context, Ptr<const Packet> packet)
+    {
+        if (trace->Keep(packet))
+        {
+            PrintFrame(trace->Begin('d', context), packet);
+        }
+    }
+
+    /**
+     * \param trace The trace.
+     * \param context The trace context.
+     * \param packet The frame dropped on reception.
+     * \param reason The reason of the drop.
+     */
+    static void RxDrop(Ptr<FilteredAsciiTrace> trace,
+                       std::string context,
+                       Ptr<const Packet> packet,
+                       WifiPhyRxfailureReason reason)
+    {
+        if (trace->Keep(packet))
+        {
+            std::ostream& os = trace->Begin('d', context);
+            os << reason << " ";
+            PrintFrame(os, packet);
+        }
+    }
+
+    Ptr<OutputStreamWrapper> m_stream; //!< Trace stream
+    std::string m_events{"tr"};        //!< Event types traced
+    std::set<uint32_t> m_nodes;        //!< Nodes traced, empty for all
+    uint16_t m_include{0};             //!< Protocols kept, 0 for all
+    uint16_t m_exclude{0};             //!< Protocols discarded
+    Time m_start;                      //!< Start of the time window
+    Time m_stop;                       //!< End of the time window, zero for none
+    uint64_t m_written{0};             //!< Events written
+    uint64_t m_discarded{0};           //!< Events discarded
+};
+
+} // namespace ns3
+
+#endif /* FILTERED_ASCII_TRACE_H */
@@ -0,0 +1,567 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include "ns3/abort.h"
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/callback.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+#include "ns3/tag.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * Byte tag holding the flow and the send time of a packet.
+ *
+ * A byte tag adds nothing to the packet on the air, so stamping does not
+ * change the simulated traffic, and unlike a packet tag it follows the bytes
+ * through A-MSDU aggregation and fragmentation.
+ */
+class LatencyTag : public Tag
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::LatencyTag").SetParent<Tag>().AddConstructor<LatencyTag>();
+        return tid;
+    }
+
+    LatencyTag() = default;
+
+    /**
+     * \param flow The flow of the packet.
+     * \param txTime The send time of the packet.
+     */
+    LatencyTag(uint32_t flow, Time txTime)
+        : m_flow(flow),
+          m_txTime(txTime.GetNanoSeconds())
+    {
+    }
+
+    TypeId GetInstanceTypeId() const override
+    {
+        return GetTypeId();
+    }
+
+    uint32_t GetSerializedSize() const override
+    {
+        return 12;
+    }
+
+    void Serialize(TagBuffer i) const override
+    {
+        i.WriteU32(m_flow);
+        i.WriteU64(m_txTime);
+    }
+
+    void Deserialize(TagBuffer i) override
+    {
+        m_flow = i.ReadU32();
+        m_txTime = i.ReadU64();
+    }
+
+    void Print(std::ostream& os) const override
+    {
+        os << "flow=" << m_flow << " txTime=" << m_txTime << "ns";
+    }
+
+    /**
+     * \return the flow of the packet.
+     */
+    uint32_t GetFlow() const
+    {
+        return m_flow;
+    }
+
+    /**
+     * \return the send time of the packet.
+     */
+    Time GetTxTime() const
+    {
+        return NanoSeconds(m_txTime);
+    }
+
+  private:
+    uint32_t m_flow{0};  //!< Flow of the packet
+    int64_t m_txTime{0}; //!< Send time (ns)
+};
+
+NS_OBJECT_ENSURE_REGISTERED(LatencyTag);
+
+/**
+ * Log-linear histogram of durations in nanoseconds, as in HdrHistogram.
+ *
+ * Values below 2^SUB_BITS ns have a bucket each; above, every power of two
+ * is split into 2^SUB_BITS equal buckets, so a bucket is at most 1/32 of
+ * its values wide and a quantile is within 3.1% of the exact one.  The
+ * buckets cover up to 2^MAX_BITS ns (18 minutes), larger values are counted
+ * in the last one: the histogram has a fixed size of about 9 KB, whatever
+ * the number of values.  Two histograms merge by adding their buckets, so
+ * the histograms of several replications give the quantiles of all of their
+ * values together.
+ */
+class LatencyHistogram
+{
+  public:
+    static constexpr uint32_t SUB_BITS = 5;  //!< Bits of a value kept exactly
+    static constexpr uint32_t MAX_BITS = 40; //!< Bits of the largest value bucketed
+
+    /**
+     * \param value A value (ns).
+     */
+    void Add(uint64_t value)
+    {
+        m_counts[GetIndex(value)]++;
+        m_count++;
+        m_sum += value;
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+
+    /**
+     * \param other The histogram to add to this one.
+     */
+    void Merge(const LatencyHistogram& other)
+    {
+        for (std::size_t i = 0; i < BUCKETS; i++)
+        {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+
+    /**
+     * \return the number of values.
+     */
+    uint64_t GetCount() const
+    {
+        return m_count;
+    }
+
+    /**
+     * \return the mean of the values (ns), 0 if none.
+     */
+    double GetMean() const
+    {
+        return m_count == 0 ? 0 : static_cast<double>(m_sum) / m_count;
+    }
+
+    /**
+     * \return the largest value (ns), 0 if none.
+     */
+    uint64_t GetMax() const
+    {
+        return m_max;
+    }
+
+    /**
+     * \param q The quantile, from 0 to 1.
+     * \return the middle of the bucket of the quantile (ns), within the
+     *         smallest and largest values; 0 if there are no values.
+     */
+    uint64_t GetQuantile(double q) const
+    {
+        if (m_count == 0)
+        {
+            return 0;
+        }
+        auto rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * m_count));
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        std::size_t i = 0;
+        while ((seen += m_counts[i]) < rank)
+        {
+            i++;
+        }
+        uint64_t low = GetLowest(i);
+        uint64_t width = GetLowest(i + 1) - low;
+        return std::clamp(low + width / 2, m_min, m_max);
+    }
+
+    /**
+     * \brief Write the histogram on one line, non-empty buckets only.
+     *
+     * \param os The output stream.
+     */
+    void Serialize(std::ostream& os) const
+    {
+        os << m_count << " " << m_sum << " " << m_min << " " << m_max << " "
+           << BUCKETS - std::count(m_counts.begin(), m_counts.end(), 0);
+        for (std::size_t i = 0; i < BUCKETS; i++)
+        {
+            if (m_counts[i] != 0)
+            {
+                os << " " << i << " " << m_counts[i];
+            }
+        }
+    }
+
+    /**
+     * \brief Read a histogram written by Serialize ().
+     *
+     * \param is The input stream.
+     * \return false if the input is invalid.
+     */
+    bool Deserialize(std::istream& is)
+    {
+        *this = LatencyHistogram();
+        std::size_t buckets;
+        if (!(is >> m_count >> m_sum >> m_min >> m_max >> buckets))
+        {
+            return false;
+        }
+        for (std::size_t n = 0; n < buckets; n++)
+        {
+            std::size_t i;
+            uint64_t count;
+            if (!(is >> i >> count) || i >= BUCKETS)
+            {
+                return false;
+            }
+            m_counts[i] = count;
+        }
+        return true;
+    }
+
+  private:
+    /// Number of buckets
+    static constexpr std::size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) << SUB_BITS;
+
+    /**
+     * \param value A value.
+     * \return the index of its bucket.
+     */
+    static std::size_t GetIndex(uint64_t value)
+    {
+        if (value < (uint64_t{1} << SUB_BITS))
+        {
+            return value;
+        }
+        uint32_t shift = 63 - __builtin_clzll(value) - SUB_BITS;
+        // the SUB_BITS + 1 leading bits: from 2^SUB_BITS to 2^(SUB_BITS + 1) - 1
+        std::size_t index = (static_cast<std::size_t>(shift) << SUB_BITS) + (value >> shift);
+        return std::min(index, BUCKETS - 1);
+    }
+
+    /**
+     * \param index The index of a bucket, or the number of buckets.
+     * \return the smallest value of the bucket.
+     */
+    static uint64_t GetLowest(std::size_t index)
+    {
+        if (index < (std::size_t{1} << SUB_BITS))
+        {
+            return index;
+        }
+        uint32_t shift = (index >> SUB_BITS) - 1;
+        uint64_t leading = (index & ((std::size_t{1} << SUB_BITS) - 1)) + (uint64_t{1} << SUB_BITS);
+        return leading << shift;
+    }
+
+    std::array<uint64_t, BUCKETS> m_counts{};             //!< Values per bucket
+    uint64_t m_count{0};                                  //!< Number of values
+    uint64_t m_sum{0};                                    //!< Sum of the values
+    uint64_t m_min{std::numeric_limits<uint64_t>::max()}; //!< Smallest value
+    uint64_t m_max{0};                                    //!< Largest value
+};
+
+/**
+ * End-to-end delay and jitter of the packets of a set of flows.
+ *
+ * The sources stamp their packets with a LatencyTag, either directly
+ * (Stamp ()) or as the IPv4 layer of their node sends them (EnableSource ()),
+ * and the sinks pass the packets they receive to Receive (), or connect the
+ * Rx trace of a PacketSink (EnableSink ()).  Every flow has a delay
+ * histogram and a jitter histogram, the latter of the delay variation
+ * between consecutive packets received (|D(i) - D(i-1)|, the IPDV of RFC
+ * 3393), which unlike the smoothed jitter of RFC 3550 can be merged across
+ * replications.  Flows are numbered by the sources; recorders of different
+ * replications merge flow by flow.  This costs two histograms per flow and
+ * one tag per packet, against a FlowMonitor probe and flow classification
+ * at every node for every packet.
+ */
+class LatencyRecorder : public SimpleRefCount<LatencyRecorder>
+{
+  public:
+    /**
+     * \brief Stamp a packet about to be sent.
+     *
+     * \param flow The flow of the packet.
+     * \param packet The packet.
+     */
+    static void Stamp(uint32_t flow, Ptr<const Packet> packet)
+    {
+        packet->AddByteTag(LatencyTag(flow, Simulator::Now()));
+    }
+
+    /**
+     * \brief Stamp the UDP packets sent by an application with a Remote
+     * attribute, such as OnOffApplication or BurstSender.
+     *
+     * The Tx trace of the application cannot be used: OnOffApplication fires
+     * it after Send (), and UdpSocketImpl sends a copy of the packet, which
+     * does not get the tags added afterwards.  The packets are stamped by the
+     * SendOutgoing trace of the IPv4 layer instead, still at the time they
+     * are sent, when their destination address and port are the Remote of
+     * the application.  Applications of the same node sending to the same
+     * Remote cannot be told apart: their packets go to the first flow.
+     *
+     * \param app The application.
+     * \param flow The flow of its packets.
+     */
+    static void EnableSource(Ptr<Application> app, uint32_t flow)
+    {
+        AddressValue remote;
+        app->GetAttribute("Remote", remote);
+        NS_ABORT_MSG_UNLESS(InetSocketAddress::IsMatchingType(remote.Get()),
+                            "LatencyRecorder sources must send to an IPv4 address");
+        NS_ABORT_MSG_UNLESS(app->GetNode()->GetObject<Ipv4>()->TraceConnectWithoutContext(
+                                "SendOutgoing",
+                                MakeBoundCallback(&LatencyRecorder::StampOutgoing,
+                                                  flow,
+                                                  InetSocketAddress::ConvertFrom(remote.Get()))),
+                            "Cannot connect to SendOutgoing of node " << app->GetNode()->GetId());
+    }
+
+    /**
+     * \brief Record the packets received by a PacketSink.
+     *
+     * \param sink The sink.
+     */
+    void EnableSink(Ptr<Application> sink)
+    {
+        NS_ABORT_MSG_UNLESS(
+            sink->TraceConnectWithoutContext("Rx", MakeCallback(&LatencyRecorder::SinkRx, this)),
+            "Cannot connect to Rx of node " << sink->GetNode()->GetId());
+    }
+
+    /**
+     * \brief Record a packet received; aborts if it was not stamped, as its
+     * delay would be missing from the histograms.
+     *
+     * \param packet The packet.
+     */
+    void Receive(Ptr<const Packet> packet)
+    {
+        LatencyTag tag;
+        NS_ABORT_MSG_UNLESS(packet->FindFirstMatchingByteTag(tag),
+                            "Packet of " << packet->GetSize()
+                                         << " bytes received without a LatencyTag");
+        auto delay = static_cast<uint64_t>((Simulator::Now() - tag.GetTxTime()).GetNanoSeconds());
+        Flow& flow = m_flows[tag.GetFlow()];
+        flow.delay.Add(delay);
+        if (flow.delay.GetCount() > 1)
+        {
+            flow.jitter.Add(delay > flow.lastDelay ? delay - flow.lastDelay
+                                                   : flow.lastDelay - delay);
+        }
+        flow.lastDelay = delay;
+    }
+
+    /**
+     * \param other The recorder whose flows to add to this one.
+     */
+    void Merge(const LatencyRecorder& other)
+    {
+        for (const auto& [id, flow] : other.m_flows)
+        {
+            m_flows[id].delay.Merge(flow.delay);
+            m_flows[id].jitter.Merge(flow.jitter);
+        }
+    }
+
+    /**
+     * \brief Write the histograms of the flows, one flow per line.
+     *
+     * \param os The output stream.
+     */
+    void Serialize(std::ostream& os) const
+    {
+        os << "latency " << m_flows.size() << "\n";
+        for (const auto& [id, flow] : m_flows)
+        {
+            os << id << " ";
+            flow.delay.Serialize(os);
+            os << " ";
+            flow.jitter.Serialize(os);
+            os << "\n";
+        }
+    }
+
+    /**
+     * \brief Read the histograms written by Serialize () and merge them.
+     *
+     * \param is The input stream.
+     * \return false if the input is invalid.
+     */
+    bool Deserialize(std::istream& is)
+    {
+        std::string word;
+        std::size_t flows;
+        if (!(is >> word >> flows) || word != "latency")
+        {
+            return false;
+        }
+        for (std::size_t n = 0; n < flows; n++)
+        {
+            uint32_t id;
+            Flow flow;
+            if (!(is >> id) || !flow.delay.Deserialize(is) || !flow.jitter.Deserialize(is))
+            {
+                return false;
+            }
+            m_flows[id].delay.Merge(flow.delay);
+            m_flows[id].jitter.Merge(flow.jitter);
+        }
+        return true;
+    }
+
+    /**
+     * \brief Print the delay quantiles and the jitter of every flow, and of
+     * all the flows together if more than one, in milliseconds.
+     *
+     * \param os The output stream.
+     */
+    void Print(std::ostream& os) const
+    {
+        os << "flow\tpackets\tp50\tp99\tp99.9\tmax\tjitter\tjitterP99 (ms)" << std::endl;
+        Flow all;
+        for (const auto& [id, flow] : m_flows)
+        {
+            os << id;
+            PrintFlow(os, flow);
+            all.delay.Merge(flow.delay);
+            all.jitter.Merge(flow.jitter);
+        }
+        if (m_flows.size() > 1)
+        {
+            os << "all";
+            PrintFlow(os, all);
+        }
+    }
+
+    /**
+     * \param q The quantile, from 0 to 1.
+     * \return the delay quantile of all the flows together.
+     */
+    Time GetDelayQuantile(double q) const
+    {
+        LatencyHistogram all;
+        for (const auto& [id, flow] : m_flows)
+        {
+            all.Merge(flow.delay);
+        }
+        return NanoSeconds(all.GetQuantile(q));
+    }
+
+  private:
+    /// Histograms of a flow
+    struct Flow
+    {
+        LatencyHistogram delay;  //!< End-to-end delay
+        LatencyHistogram jitter; //!< Delay variation between consecutive packets
+        uint64_t lastDelay{0};   //!< Delay of the last packet received (ns)
+    };
+
+    /**
+     * \brief Stamp a packet sent by the IPv4 layer of a source, if it goes to
+     * the Remote of its application.
+     *
+     * \param flow The flow of the application.
+     * \param remote The Remote of the application.
+     * \param header The IPv4 header of the packet.
+     * \param packet The packet, starting with its UDP header.
+     * \param interface The output interface.
+     */
+    static void StampOutgoing(uint32_t flow,
+                              InetSocketAddress remote,
+                              const Ipv4Header& header,
+                              Ptr<const Packet> packet,
+                              uint32_t interface)
+    {
+        UdpHeader udp;
+        LatencyTag tag;
+        if (header.GetDestination() != remote.GetIpv4() ||
+            header.GetProtocol() != UdpL4Protocol::PROT_NUMBER ||
+            packet->PeekHeader(udp) == 0 || udp.GetDestinationPort() != remote.GetPort() ||
+            packet->FindFirstMatchingByteTag(tag))
+        {
+            return;
+        }
+        Stamp(flow, packet);
+    }
+
+    /**
+     * \param packet A packet received by a PacketSink.
+     * \param from Its source.
+     */
+    void SinkRx(Ptr<const Packet> packet, const Address& from)
+    {
+        Receive(packet);
+    }
+
+    /**
+     * \param os The output stream.
+     * \param flow The flow to print the histograms of, after its name.
+     */
+    static void PrintFlow(std::ostream& os, const Flow& flow)
+    {
+        const LatencyHistogram& delay = flow.delay;
+        os << "\t" << delay.GetCount() << std::fixed << std::setprecision(3) << "\t"
+           << delay.GetQuantile(0.5) / 1e6 << "\t" << delay.GetQuantile(0.99) / 1e6 << "\t"
+           << delay.GetQuantile(0.999) / 1e6 << "\t" << delay.GetMax() / 1e6 << "\t"
+           << flow.jitter.GetMean() / 1e6 << "\t" << flow.jitter.GetQuantile(0.99) / 1e6
+           << std::endl;
+        os.unsetf(std::ios::floatfield);
+        os << std::setprecision(6);
+    }
+
+    std::map<uint32_t, Flow> m_flows; //!< Histograms, by flow
+};
+
+} // namespace ns3
+
+#endif /* LATENCY_HISTOGRAM_H */
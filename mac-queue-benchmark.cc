@@ -0,0 +1,369 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Cost of the MAC queue operations of a saturated sender with many
+// receivers, as in scenarios 3 and 4 of wifi-multirate, for two queue
+// organizations:
+//  - one FIFO list holding the packets of every receiver and TID, walked to
+//    find the packets of a station, count them for the block ack window and
+//    dequeue them (the organization of WifiMacQueue before it was split into
+//    container queues);
+//  - one FIFO per (receiver, TID), with the lifetime expiry driven by time
+//    buckets: every slot of the last MaxDelay holds the queues that received
+//    a packet in that slot, and when the slot expires only the heads of
+//    those queues are checked.
+//
+// Every slot, about --load packets arrive for random (receiver, TID) pairs
+// and the queue is served once: the next non-empty pair in round-robin
+// order sends an A-MPDU of up to --aggregation packets.  Both organizations
+// run the same arrivals and must serve, expire and drop the same packets.
+//
+// ./ns3 run "mac-queue-benchmark --receivers=64 --load=1.5"
+//
+
+#include "ns3/abort.h"
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("MacQueueBenchmark");
+
+namespace
+{
+
+/// A queued packet
+struct QueuedPacket
+{
+    uint32_t key;      //!< Receiver and TID
+    uint64_t enqueued; //!< Enqueue slot
+};
+
+/// Queue counters
+struct QueueStats
+{
+    uint64_t served{0};  //!< Packets sent
+    uint64_t expired{0}; //!< Packets dropped at the end of their lifetime
+    uint64_t dropped{0}; //!< Packets dropped because the queue was full
+    uint64_t visited{0}; //!< Queue entries examined
+
+    /**
+     * \param other Other counters.
+     * \return true if the same packets were served, expired and dropped.
+     */
+    bool SameOutcome(const QueueStats& other) const
+    {
+        return served == other.served && expired == other.expired && dropped == other.dropped;
+    }
+};
+
+/**
+ * All packets in one list.
+ */
+class ListQueue
+{
+  public:
+    /**
+     * \param maxSize The maximum number of packets.
+     * \param maxDelay The packet lifetime, in slots.
+     */
+    ListQueue(uint32_t maxSize, uint64_t maxDelay)
+        : m_maxSize(maxSize),
+          m_maxDelay(maxDelay)
+    {
+    }
+
+    /**
+     * \param packet The packet to enqueue.
+     */
+    void Enqueue(const QueuedPacket& packet)
+    {
+        if (m_items.size() >= m_maxSize)
+        {
+            m_stats.dropped++;
+            return;
+        }
+        m_items.push_back(packet);
+    }
+
+    /**
+     * \param now The current slot.
+     */
+    void Expire(uint64_t now)
+    {
+        while (!m_items.empty() && m_items.front().enqueued + m_maxDelay <= now)
+        {
+            m_items.pop_front();
+            m_stats.expired++;
+        }
+    }
+
+    /**
+     * \param key A (receiver, TID) pair.
+     * \return the number of packets queued for the pair.
+     */
+    uint32_t Count(uint32_t key)
+    {
+        uint32_t count = 0;
+        for (const auto& item : m_items)
+        {
+            m_stats.visited++;
+            count += item.key == key ? 1 : 0;
+        }
+        return count;
+    }
+
+    /**
+     * \param key A (receiver, TID) pair.
+     * \param max The maximum number of packets to dequeue.
+     */
+    void Dequeue(uint32_t key, uint32_t max)
+    {
+        for (auto it = m_items.begin(); it != m_items.end() && max > 0;)
+        {
+            m_stats.visited++;
+            if (it->key == key)
+            {
+                it = m_items.erase(it);
+                m_stats.served++;
+                max--;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    /**
+     * \return the counters.
+     */
+    const QueueStats& GetStats() const
+    {
+        return m_stats;
+    }
+
+  private:
+    std::list<QueuedPacket> m_items; //!< Queued packets, oldest first
+    uint32_t m_maxSize;              //!< Maximum number of packets
+    uint64_t m_maxDelay;             //!< Packet lifetime (slots)
+    QueueStats m_stats;              //!< Counters
+};
+
+/**
+ * One FIFO per (receiver, TID), with bucketed lifetime expiry.
+ */
+class StationQueues
+{
+  public:
+    /**
+     * \param keys The number of (receiver, TID) pairs.
+     * \param maxSize The maximum number of packets.
+     * \param maxDelay The packet lifetime, in slots.
+     */
+    StationQueues(uint32_t keys, uint32_t maxSize, uint64_t maxDelay)
+        : m_queues(keys),
+          m_buckets(maxDelay + 1),
+          m_maxSize(maxSize),
+          m_maxDelay(maxDelay)
+    {
+    }
+
+    /**
+     * \param packet The packet to enqueue.
+     */
+    void Enqueue(const QueuedPacket& packet)
+    {
+        if (m_size >= m_maxSize)
+        {
+            m_stats.dropped++;
+            return;
+        }
+        m_queues[packet.key].push_back(packet.enqueued);
+        m_buckets[packet.enqueued % m_buckets.size()].push_back(packet.key);
+        m_size++;
+    }
+
+    /**
+     * \param now The current slot.
+     */
+    void Expire(uint64_t now)
+    {
+        if (now < m_maxDelay)
+        {
+            return;
+        }
+        // the packets enqueued in this slot expire now, unless already sent
+        uint64_t slot = now - m_maxDelay;
+        std::vector<uint32_t>& bucket = m_buckets[slot % m_buckets.size()];
+        for (uint32_t key : bucket)
+        {
+            m_stats.visited++;
+            std::deque<uint64_t>& queue = m_queues[key];
+            if (!queue.empty() && queue.front() == slot)
+            {
+                queue.pop_front();
+                m_size--;
+                m_stats.expired++;
+            }
+        }
+        bucket.clear();
+    }
+
+    /**
+     * \param key A (receiver, TID) pair.
+     * \return the number of packets queued for the pair.
+     */
+    uint32_t Count(uint32_t key)
+    {
+        m_stats.visited++;
+        return m_queues[key].size();
+    }
+
+    /**
+     * \param key A (receiver, TID) pair.
+     * \param max The maximum number of packets to dequeue.
+     */
+    void Dequeue(uint32_t key, uint32_t max)
+    {
+        std::deque<uint64_t>& queue = m_queues[key];
+        for (; max > 0 && !queue.empty(); max--)
+        {
+            m_stats.visited++;
+            queue.pop_front();
+            m_size--;
+            m_stats.served++;
+        }
+    }
+
+    /**
+     * \return the counters.
+     */
+    const QueueStats& GetStats() const
+    {
+        return m_stats;
+    }
+
+  private:
+    std::vector<std::deque<uint64_t>> m_queues;   //!< Enqueue slots, by (receiver, TID)
+    std::vector<std::vector<uint32_t>> m_buckets; //!< Pairs enqueued to, by slot modulo
+    uint32_t m_size{0};                           //!< Number of queued packets
+    uint32_t m_maxSize;                           //!< Maximum number of packets
+    uint64_t m_maxDelay;                          //!< Packet lifetime (slots)
+    QueueStats m_stats;                           //!< Counters
+};
+
+/**
+ * \brief Run the arrivals and services of a saturated sender.
+ *
+ * \param queue The queue.
+ * \param keys The number of (receiver, TID) pairs.
+ * \param load The mean number of arrivals per slot.
+ * \param aggregation The maximum number of packets per A-MPDU.
+ * \param slots The number of slots.
+ * \return the wall-clock time, in milliseconds.
+ */
+template <typename Queue>
+double
+RunQueue(Queue& queue, uint32_t keys, double load, uint32_t aggregation, uint64_t slots)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> fraction(0, 1);
+    uint32_t next = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t now = 0; now < slots; now++)
+    {
+        auto arrivals = static_cast<uint32_t>(load + fraction(rng));
+        for (uint32_t i = 0; i < arrivals; i++)
+        {
+            queue.Enqueue({static_cast<uint32_t>(rng() % keys), now});
+        }
+        queue.Expire(now);
+        for (uint32_t k = 0; k < keys; k++)
+        {
+            uint32_t key = (next + k) % keys;
+            // block ack window check, then the A-MPDU for the station
+            uint32_t queued = queue.Count(key);
+            if (queued > 0)
+            {
+                queue.Dequeue(key, std::min(queued, aggregation));
+                next = key + 1;
+                break;
+            }
+        }
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+/**
+ * \param name The organization.
+ * \param stats Its counters.
+ * \param wall Its wall-clock time (ms).
+ */
+void
+Report(const std::string& name, const QueueStats& stats, double wall)
+{
+    std::cout << name << ": " << stats.served << " served, " << stats.expired << " expired, "
+              << stats.dropped << " dropped, " << stats.visited << " entries visited in " << wall
+              << " ms" << std::endl;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t receivers = 64;
+    uint32_t tids = 1;
+    double load = 1.5;
+    uint32_t aggregation = 1;
+    uint32_t maxSize = 500;
+    uint64_t maxDelay = 2000; // slots
+    uint64_t slots = 200000;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("receivers", "number of receivers", receivers);
+    cmd.AddValue("tids", "number of TIDs per receiver", tids);
+    cmd.AddValue("load", "mean packet arrivals per slot", load);
+    cmd.AddValue("aggregation", "maximum packets per A-MPDU", aggregation);
+    cmd.AddValue("maxSize", "queue capacity (packets)", maxSize);
+    cmd.AddValue("maxDelay", "packet lifetime (slots)", maxDelay);
+    cmd.AddValue("slots", "number of slots", slots);
+    cmd.Parse(argc, argv);
+
+    uint32_t keys = receivers * tids;
+    ListQueue list(maxSize, maxDelay);
+    double listWall = RunQueue(list, keys, load, aggregation, slots);
+    Report("Single list", list.GetStats(), listWall);
+
+    StationQueues stations(keys, maxSize, maxDelay);
+    double stationsWall = RunQueue(stations, keys, load, aggregation, slots);
+    Report("Per-station queues", stations.GetStats(), stationsWall);
+
+    NS_ABORT_MSG_IF(!list.GetStats().SameOutcome(stations.GetStats()),
+                    "the two organizations served different packets");
+    return 0;
+}
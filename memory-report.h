@@ -0,0 +1,208 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MEMORY_REPORT_H
+#define MEMORY_REPORT_H
+
+#include "config-index.h"
+
+#include "ns3/node-list.h"
+#include "ns3/queue.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace ns3
+{
+
+/**
+ * Report of where the memory of a run goes.
+ *
+ * The report lists:
+ *  - the process resident set (current and peak) and, with glibc, the bytes
+ *    in use on the heap, which include packets, buffers and every container;
+ *  - the objects reachable from the NodeList, by TypeId, with their count
+ *    and their shallow size (count times sizeof, as recorded by
+ *    NS_OBJECT_ENSURE_REGISTERED; 0 when the type did not record it);
+ *  - the packets and bytes held by every queue (Wi-Fi MAC queues,
+ *    traffic control and device queues), by queue type;
+ *  - the number of objects per node.
+ *
+ * Shallow sizes do not include what an object owns through containers
+ * (e.g. Minstrel station tables, ARP cache entries, OLSR sets): these
+ * modules do not expose the sizes of their tables.  The report says so;
+ * the heap total, and the resident set, include them.
+ */
+class MemoryReport
+{
+  public:
+    /**
+     * \brief Print the report.
+     *
+     * \param os The output stream.
+     * \param top The number of types listed.
+     */
+    static void Print(std::ostream& os, uint32_t top = 20)
+    {
+        os << "Memory report at " << Simulator::Now().GetSeconds() << "s" << std::endl;
+        uint64_t heap = 0;
+        bool hasHeap = GetHeapInUse(heap);
+        os << "  resident: " << ReadStatus("VmRSS:") << " kB, peak: " << ReadStatus("VmHWM:")
+           << " kB";
+        if (hasHeap)
+        {
+            os << ", heap in use: " << heap / 1024 << " kB";
+        }
+        os << std::endl;
+
+        ConfigIndex index;
+        struct TypeUsage
+        {
+            TypeId tid;
+            std::size_t count;
+            std::size_t bytes;
+        };
+
+        std::vector<TypeUsage> usage;
+        std::size_t totalObjects = 0;
+        std::size_t totalBytes = 0;
+        for (const auto& [tid, count] : index.CountByType())
+        {
+            usage.push_back({tid, count, count * tid.GetSize()});
+            totalObjects += count;
+            totalBytes += count * tid.GetSize();
+        }
+        std::sort(usage.begin(), usage.end(), [](const TypeUsage& a, const TypeUsage& b) {
+            return a.bytes > b.bytes || (a.bytes == b.bytes && a.count > b.count);
+        });
+        os << "  objects: " << totalObjects << ", shallow size: " << totalBytes / 1024 << " kB"
+           << " (without the contents of their containers: Minstrel stations, ARP entries,"
+           << " OLSR sets)" << std::endl;
+        for (std::size_t i = 0; i < std::min<std::size_t>(top, usage.size()); i++)
+        {
+            os << std::setw(12) << usage[i].count << std::setw(12) << usage[i].bytes << "  "
+               << usage[i].tid.GetName() << std::endl;
+        }
+
+        std::map<std::string, std::pair<uint64_t, uint64_t>> queues;
+        for (const auto& object : index.Find("ns3::QueueBase"))
+        {
+            Ptr<QueueBase> queue = DynamicCast<QueueBase>(object);
+            auto& [packets, bytes] = queues[queue->GetInstanceTypeId().GetName()];
+            packets += queue->GetNPackets();
+            bytes += queue->GetNBytes();
+        }
+        for (const auto& [name, occupancy] : queues)
+        {
+            os << "  queued in " << name << ": " << occupancy.first << " packets, "
+               << occupancy.second << " bytes" << std::endl;
+        }
+
+        uint32_t nNodes = NodeList::GetNNodes();
+        if (nNodes > 0)
+        {
+            std::size_t maxObjects = 0;
+            uint32_t maxNode = 0;
+            for (uint32_t i = 0; i < nNodes; i++)
+            {
+                if (index.CountByNode(i) > maxObjects)
+                {
+                    maxObjects = index.CountByNode(i);
+                    maxNode = i;
+                }
+            }
+            os << "  per node: " << totalObjects / nNodes << " objects on average, "
+               << maxObjects << " on node " << maxNode;
+            if (hasHeap)
+            {
+                os << ", " << heap / nNodes / 1024 << " kB of heap on average";
+            }
+            os << std::endl;
+        }
+    }
+
+    /**
+     * \brief Print the report at a given simulation time.
+     *
+     * \param delay The time from now.
+     * \param os The output stream; it must outlive the event.
+     * \param top The number of types listed.
+     */
+    static void Schedule(Time delay, std::ostream* os, uint32_t top = 20)
+    {
+        Simulator::Schedule(delay, &MemoryReport::PrintTo, os, top);
+    }
+
+  private:
+    /**
+     * Print the report.
+     *
+     * \param os The output stream.
+     * \param top The number of types listed.
+     */
+    static void PrintTo(std::ostream* os, uint32_t top)
+    {
+        Print(*os, top);
+    }
+
+    /**
+     * \param key A key of /proc/self/status, e.g. "VmRSS:".
+     * \return its value, in kB, or 0 if unavailable.
+     */
+    static uint64_t ReadStatus(const std::string& key)
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, key.size(), key) == 0)
+            {
+                return std::stoull(line.substr(key.size()));
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * \param bytes Set to the number of bytes allocated on the heap and not freed.
+     * \return false if the C library does not report it (glibc before 2.33, or not glibc).
+     */
+    static bool GetHeapInUse(uint64_t& bytes)
+    {
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+        struct mallinfo2 info = mallinfo2();
+        bytes = info.uordblks + info.hblkhd;
+        return true;
+#endif
+#endif
+        bytes = 0;
+        return false;
+    }
+};
+
+} // namespace ns3
+
+#endif /* MEMORY_REPORT_H */
@@ -0,0 +1,364 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Measures the cost of building, walking and tearing down the per-node
+// object graphs of a large adhoc Wi-Fi grid (device, MAC, PHY, station
+// manager, queues, IP stack, OLSR), with the default allocator or with a
+// slab allocator.
+//
+// With --slab=1 every small allocation (up to 512 bytes) made after the
+// command line is parsed comes from 64 KiB pages dedicated to one size
+// class, carved out of a single reserved address range.  The helpers build
+// the topology one node at a time, so each node's objects end up packed in
+// a few pages instead of being spread over the whole heap, and a free is a
+// push on a per-class free list.
+//
+// ./ns3 run "node-build-benchmark --numNodes=10000"
+// ./ns3 run "node-build-benchmark --numNodes=10000 --slab=1"
+//
+
+#include "ns3/command-line.h"
+#include "ns3/double.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/log.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/olsr-helper.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-helper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("NodeBuildBenchmark");
+
+namespace
+{
+
+/**
+ * Size-class slab allocator backing the global operator new once enabled.
+ */
+class SlabArena
+{
+  public:
+    static constexpr std::size_t GRANULE = 16;                     //!< Size class step
+    static constexpr std::size_t MAX_SIZE = 512;                   //!< Largest slab allocation
+    static constexpr std::size_t N_CLASSES = MAX_SIZE / GRANULE;   //!< Number of size classes
+    static constexpr std::size_t PAGE_SHIFT = 16;                  //!< 64 KiB pages
+    static constexpr std::size_t PAGE_SIZE = 1 << PAGE_SHIFT;      //!< Page size
+    static constexpr std::size_t RESERVED = std::size_t(64) << 30; //!< Reserved address space
+
+    /**
+     * Reserve the address range and route small allocations to the arena.
+     */
+    void Enable()
+    {
+        void* base = mmap(nullptr,
+                          RESERVED,
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                          -1,
+                          0);
+        if (base == MAP_FAILED)
+        {
+            return;
+        }
+        m_pageClass = static_cast<uint8_t*>(std::malloc(RESERVED >> PAGE_SHIFT));
+        m_base = static_cast<char*>(base);
+        m_enabled = true;
+    }
+
+    /**
+     * \param size The requested size.
+     * \return a block from the arena, or nullptr if the request is not for the arena.
+     */
+    void* Allocate(std::size_t size)
+    {
+        if (!m_enabled || size == 0 || size > MAX_SIZE)
+        {
+            return nullptr;
+        }
+        std::size_t cls = (size - 1) / GRANULE;
+        Lock();
+        void* block = m_freeLists[cls];
+        if (block)
+        {
+            m_freeLists[cls] = *static_cast<void**>(block);
+        }
+        else
+        {
+            std::size_t blockSize = (cls + 1) * GRANULE;
+            if (m_cursor[cls] == nullptr || m_cursor[cls] + blockSize > m_limit[cls])
+            {
+                if ((m_pages + 1) << PAGE_SHIFT > RESERVED)
+                {
+                    Unlock();
+                    return nullptr;
+                }
+                m_pageClass[m_pages] = static_cast<uint8_t>(cls);
+                m_cursor[cls] = m_base + (m_pages << PAGE_SHIFT);
+                m_limit[cls] = m_cursor[cls] + PAGE_SIZE;
+                m_pages++;
+            }
+            block = m_cursor[cls];
+            m_cursor[cls] += blockSize;
+        }
+        Unlock();
+        return block;
+    }
+
+    /**
+     * \param block A block.
+     * \return true if the block came from the arena and was released.
+     */
+    bool Free(void* block)
+    {
+        char* p = static_cast<char*>(block);
+        if (!m_base || p < m_base || p >= m_base + RESERVED)
+        {
+            return false;
+        }
+        std::size_t cls = m_pageClass[(p - m_base) >> PAGE_SHIFT];
+        Lock();
+        *static_cast<void**>(block) = m_freeLists[cls];
+        m_freeLists[cls] = block;
+        Unlock();
+        return true;
+    }
+
+    /**
+     * \return the number of bytes of pages in use.
+     */
+    std::size_t GetPagesBytes() const
+    {
+        return m_pages << PAGE_SHIFT;
+    }
+
+  private:
+    /// Acquire the arena lock
+    void Lock()
+    {
+        while (m_lock.test_and_set(std::memory_order_acquire))
+        {
+        }
+    }
+
+    /// Release the arena lock
+    void Unlock()
+    {
+        m_lock.clear(std::memory_order_release);
+    }
+
+    bool m_enabled{false};                      //!< Whether new allocations use the arena
+    char* m_base{nullptr};                      //!< Start of the reserved range
+    std::size_t m_pages{0};                     //!< Pages handed out so far
+    uint8_t* m_pageClass{nullptr};              //!< Size class of each page
+    void* m_freeLists[N_CLASSES]{};             //!< Freed blocks, by size class
+    char* m_cursor[N_CLASSES]{};                //!< Next free byte of the current page, by class
+    char* m_limit[N_CLASSES]{};                 //!< End of the current page, by class
+    std::atomic_flag m_lock = ATOMIC_FLAG_INIT; //!< Arena lock
+};
+
+SlabArena g_arena; //!< The arena behind operator new
+
+/**
+ * \param size The requested size.
+ * \return a block from the arena or from malloc.
+ */
+void*
+Allocate(std::size_t size)
+{
+    if (void* block = g_arena.Allocate(size))
+    {
+        return block;
+    }
+    return std::malloc(size ? size : 1);
+}
+
+/**
+ * \param block A block returned by Allocate.
+ */
+void
+Free(void* block)
+{
+    if (block && !g_arena.Free(block))
+    {
+        std::free(block);
+    }
+}
+
+/**
+ * \param start The start of the measurement.
+ * \return the wall-clock time elapsed since start, in milliseconds.
+ */
+double
+ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+} // namespace
+
+void*
+operator new(std::size_t size)
+{
+    void* block = Allocate(size);
+    if (!block)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void*
+operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void*
+operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return Allocate(size);
+}
+
+void*
+operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return Allocate(size);
+}
+
+void
+operator delete(void* block) noexcept
+{
+    Free(block);
+}
+
+void
+operator delete[](void* block) noexcept
+{
+    Free(block);
+}
+
+void
+operator delete(void* block, std::size_t) noexcept
+{
+    Free(block);
+}
+
+void
+operator delete[](void* block, std::size_t) noexcept
+{
+    Free(block);
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t numNodes = 10000;
+    double distance = 30; // m
+    bool slab = false;
+    bool routing = true;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("numNodes", "number of nodes", numNodes);
+    cmd.AddValue("distance", "grid spacing (m)", distance);
+    cmd.AddValue("slab", "allocate small objects from per-size-class slabs", slab);
+    cmd.AddValue("routing", "install OLSR", routing);
+    cmd.Parse(argc, argv);
+
+    if (slab)
+    {
+        g_arena.Enable();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    NodeContainer c;
+    c.Create(numNodes);
+
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211a);
+    wifi.SetRemoteStationManager("ns3::MinstrelWifiManager");
+    YansWifiPhyHelper wifiPhy;
+    wifiPhy.SetChannel(YansWifiChannelHelper::Default().Create());
+    WifiMacHelper wifiMac;
+    wifiMac.SetType("ns3::AdhocWifiMac");
+    NetDeviceContainer devices = wifi.Install(wifiPhy, wifiMac, c);
+
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator("ns3::GridPositionAllocator",
+                                  "DeltaX",
+                                  DoubleValue(distance),
+                                  "DeltaY",
+                                  DoubleValue(distance),
+                                  "GridWidth",
+                                  UintegerValue(std::max<uint32_t>(1, std::sqrt(numNodes))),
+                                  "LayoutType",
+                                  StringValue("RowFirst"));
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(c);
+
+    InternetStackHelper internet;
+    OlsrHelper olsr;
+    if (routing)
+    {
+        internet.SetRoutingHelper(olsr);
+    }
+    internet.Install(c);
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.0.0.0");
+    address.Assign(devices);
+    std::cout << "Setup:    " << ElapsedMs(start) << " ms" << std::endl;
+
+    // touch every node's object graph, as the event handlers of a run do
+    start = std::chrono::steady_clock::now();
+    double sum = 0;
+    for (uint32_t i = 0; i < numNodes; i++)
+    {
+        Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(devices.Get(i));
+        sum += device->GetPhy()->GetTxPowerStart();
+        sum += device->GetMac()->GetAddress() == Mac48Address() ? 1 : 0;
+        sum += c.Get(i)->GetObject<MobilityModel>()->GetPosition().x;
+        sum += c.Get(i)->GetObject<Ipv4>()->GetNInterfaces();
+    }
+    std::cout << "Walk:     " << ElapsedMs(start) << " ms (" << sum << ")" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    Simulator::Stop(Seconds(0.1));
+    Simulator::Run();
+    std::cout << "Run:      " << ElapsedMs(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    Simulator::Destroy();
+    std::cout << "Teardown: " << ElapsedMs(start) << " ms" << std::endl;
+    if (slab)
+    {
+        std::cout << "Slab pages: " << g_arena.GetPagesBytes() / 1024 << " kB" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,403 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OLSR_DENSE_SETS_H
+#define OLSR_DENSE_SETS_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * The neighborhood of an OLSR node, as seen by MPR selection: the symmetric
+ * one-hop neighbors with their willingness, and for each of them the strict
+ * two-hop neighbors it reaches.  Neighbors are numbered locally, one-hop
+ * neighbors from 0 to GetN () - 1 and two-hop neighbors from 0 to nTwoHop - 1.
+ */
+struct MprNeighborhood
+{
+    static constexpr uint8_t WILL_NEVER = 0;   //!< Never selected as MPR
+    static constexpr uint8_t WILL_DEFAULT = 3; //!< Default willingness
+    static constexpr uint8_t WILL_ALWAYS = 7;  //!< Always selected as MPR
+
+    std::vector<uint8_t> willingness;            //!< Willingness of each one-hop neighbor
+    std::vector<std::vector<uint32_t>> coverage; //!< Two-hop neighbors of each one-hop neighbor
+    uint32_t nTwoHop{0};                         //!< Number of two-hop neighbors
+
+    /**
+     * \return the number of one-hop neighbors.
+     */
+    uint32_t GetN() const
+    {
+        return willingness.size();
+    }
+};
+
+/**
+ * MPR selection with the heuristic of RFC 3626, section 8.3.1:
+ *  1. select the neighbors with willingness WILL_ALWAYS;
+ *  2. select the neighbors that are the only ones to reach some two-hop
+ *     neighbor;
+ *  3. while two-hop neighbors are uncovered, select the neighbor of highest
+ *     willingness, then highest reachability (uncovered two-hop neighbors it
+ *     reaches), then highest degree.
+ *
+ * ComputeList follows the structure of the OLSR routing protocol, which
+ * keeps the uncovered two-hop neighbors as a list of (neighbor, two-hop
+ * neighbor) tuples and rescans it for every reachability computation and
+ * removal.  ComputeBitset keeps, for every one-hop neighbor, the two-hop
+ * neighbors it reaches as a bitset: reachability is a popcount of an AND
+ * with the uncovered set, and the sole providers of step 2 come out of two
+ * OR-accumulated bitsets.  Both select the same set, in the same order.
+ */
+class MprSelection
+{
+  public:
+    /**
+     * \param hood The neighborhood.
+     * \return the selected one-hop neighbors, in increasing order.
+     */
+    static std::vector<uint32_t> ComputeList(const MprNeighborhood& hood)
+    {
+        std::vector<bool> selected(hood.GetN(), false);
+        std::vector<std::pair<uint32_t, uint32_t>> n2;
+        for (uint32_t y = 0; y < hood.GetN(); y++)
+        {
+            if (hood.willingness[y] == MprNeighborhood::WILL_NEVER)
+            {
+                continue;
+            }
+            for (uint32_t z : hood.coverage[y])
+            {
+                n2.emplace_back(y, z);
+            }
+        }
+        auto cover = [&n2](uint32_t y) {
+            std::vector<uint32_t> covered;
+            for (const auto& [neighbor, twoHop] : n2)
+            {
+                if (neighbor == y)
+                {
+                    covered.push_back(twoHop);
+                }
+            }
+            n2.erase(std::remove_if(n2.begin(),
+                                    n2.end(),
+                                    [&covered](const std::pair<uint32_t, uint32_t>& tuple) {
+                                        return std::find(covered.begin(),
+                                                         covered.end(),
+                                                         tuple.second) != covered.end();
+                                    }),
+                     n2.end());
+        };
+
+        for (uint32_t y = 0; y < hood.GetN(); y++)
+        {
+            if (hood.willingness[y] == MprNeighborhood::WILL_ALWAYS)
+            {
+                selected[y] = true;
+                cover(y);
+            }
+        }
+
+        std::vector<uint32_t> soleProviders;
+        for (const auto& [neighbor, twoHop] : n2)
+        {
+            bool onlyOne = true;
+            for (const auto& other : n2)
+            {
+                if (other.second == twoHop && other.first != neighbor)
+                {
+                    onlyOne = false;
+                    break;
+                }
+            }
+            if (onlyOne)
+            {
+                soleProviders.push_back(neighbor);
+            }
+        }
+        for (uint32_t y : soleProviders)
+        {
+            if (!selected[y])
+            {
+                selected[y] = true;
+                cover(y);
+            }
+        }
+
+        while (!n2.empty())
+        {
+            uint32_t best = 0;
+            uint32_t bestReach = 0;
+            for (uint32_t y = 0; y < hood.GetN(); y++)
+            {
+                uint32_t reach = 0;
+                for (const auto& tuple : n2)
+                {
+                    reach += tuple.first == y ? 1 : 0;
+                }
+                if (reach > 0 && (bestReach == 0 || Better(hood, y, reach, best, bestReach)))
+                {
+                    best = y;
+                    bestReach = reach;
+                }
+            }
+            selected[best] = true;
+            cover(best);
+        }
+        return Collect(selected);
+    }
+
+    /**
+     * \param hood The neighborhood.
+     * \return the selected one-hop neighbors, in increasing order.
+     */
+    static std::vector<uint32_t> ComputeBitset(const MprNeighborhood& hood)
+    {
+        std::size_t words = (hood.nTwoHop + 63) / 64;
+        std::vector<std::vector<uint64_t>> reaches(hood.GetN(), std::vector<uint64_t>(words, 0));
+        std::vector<uint64_t> uncovered(words, 0);
+        for (uint32_t y = 0; y < hood.GetN(); y++)
+        {
+            if (hood.willingness[y] == MprNeighborhood::WILL_NEVER)
+            {
+                continue;
+            }
+            for (uint32_t z : hood.coverage[y])
+            {
+                reaches[y][z / 64] |= uint64_t(1) << (z % 64);
+            }
+            for (std::size_t w = 0; w < words; w++)
+            {
+                uncovered[w] |= reaches[y][w];
+            }
+        }
+        std::vector<bool> selected(hood.GetN(), false);
+        auto cover = [&](uint32_t y) {
+            for (std::size_t w = 0; w < words; w++)
+            {
+                uncovered[w] &= ~reaches[y][w];
+            }
+        };
+
+        for (uint32_t y = 0; y < hood.GetN(); y++)
+        {
+            if (hood.willingness[y] == MprNeighborhood::WILL_ALWAYS)
+            {
+                selected[y] = true;
+                cover(y);
+            }
+        }
+
+        // bits reached by at least one, and by at least two, candidates
+        std::vector<uint64_t> once(words, 0);
+        std::vector<uint64_t> twice(words, 0);
+        for (uint32_t y = 0; y < hood.GetN(); y++)
+        {
+            for (std::size_t w = 0; w < words; w++)
+            {
+                uint64_t bits = reaches[y][w] & uncovered[w];
+                twice[w] |= once[w] & bits;
+                once[w] |= bits;
+            }
+        }
+        std::vector<uint32_t> soleProviders;
+        for (uint32_t y = 0; y < hood.GetN(); y++)
+        {
+            for (std::size_t w = 0; w < words; w++)
+            {
+                if (reaches[y][w] & uncovered[w] & once[w] & ~twice[w])
+                {
+                    soleProviders.push_back(y);
+                    break;
+                }
+            }
+        }
+        for (uint32_t y : soleProviders)
+        {
+            if (!selected[y])
+            {
+                selected[y] = true;
+                cover(y);
+            }
+        }
+
+        while (std::any_of(uncovered.begin(), uncovered.end(), [](uint64_t w) { return w != 0; }))
+        {
+            uint32_t best = 0;
+            uint32_t bestReach = 0;
+            for (uint32_t y = 0; y < hood.GetN(); y++)
+            {
+                uint32_t reach = 0;
+                for (std::size_t w = 0; w < words; w++)
+                {
+                    reach += __builtin_popcountll(reaches[y][w] & uncovered[w]);
+                }
+                if (reach > 0 && (bestReach == 0 || Better(hood, y, reach, best, bestReach)))
+                {
+                    best = y;
+                    bestReach = reach;
+                }
+            }
+            selected[best] = true;
+            cover(best);
+        }
+        return Collect(selected);
+    }
+
+  private:
+    /**
+     * \param hood The neighborhood.
+     * \param y A candidate.
+     * \param reach Its reachability.
+     * \param best The best candidate so far.
+     * \param bestReach Its reachability.
+     * \return true if y is preferred to best.
+     */
+    static bool Better(const MprNeighborhood& hood,
+                       uint32_t y,
+                       uint32_t reach,
+                       uint32_t best,
+                       uint32_t bestReach)
+    {
+        if (hood.willingness[y] != hood.willingness[best])
+        {
+            return hood.willingness[y] > hood.willingness[best];
+        }
+        if (reach != bestReach)
+        {
+            return reach > bestReach;
+        }
+        return hood.coverage[y].size() > hood.coverage[best].size();
+    }
+
+    /**
+     * \param selected The selection flags.
+     * \return the selected indices.
+     */
+    static std::vector<uint32_t> Collect(const std::vector<bool>& selected)
+    {
+        std::vector<uint32_t> mprs;
+        for (uint32_t y = 0; y < selected.size(); y++)
+        {
+            if (selected[y])
+            {
+                mprs.push_back(y);
+            }
+        }
+        return mprs;
+    }
+};
+
+/**
+ * OLSR duplicate set (RFC 3626, section 3.4) as a hash table keyed by
+ * (originator, message sequence number).
+ *
+ * The OLSR routing protocol keeps duplicate tuples in a vector and scans it
+ * for every received message, so the cost of a lookup grows with the number
+ * of originators times the duplicate hold time, i.e. with density squared in
+ * a flooded network.  Here a lookup is O(1), and every insertion is queued
+ * in order: OLSR holds all duplicates for the same time, so the queue is in
+ * expiration order and purging pops the expired entries from its front,
+ * without visiting the others.  An entry inserted with an earlier expiration
+ * than its predecessor is purged late, when they have expired, but lookups
+ * still compare against its expiration time.
+ */
+class DuplicateIndex
+{
+  public:
+    /**
+     * \param originator The message originator.
+     * \param sequence The message sequence number.
+     * \param now The current time.
+     * \return true if the message was already recorded and has not expired.
+     */
+    bool IsDuplicate(Ipv4Address originator, uint16_t sequence, Time now)
+    {
+        Purge(now);
+        auto it = m_entries.find(Key(originator, sequence));
+        return it != m_entries.end() && it->second > now;
+    }
+
+    /**
+     * \brief Record a message.
+     *
+     * \param originator The message originator.
+     * \param sequence The message sequence number.
+     * \param expires The expiration time of the entry.
+     */
+    void Insert(Ipv4Address originator, uint16_t sequence, Time expires)
+    {
+        uint64_t key = Key(originator, sequence);
+        Time& entry = m_entries[key];
+        entry = std::max(entry, expires);
+        m_expiries.emplace_back(expires, key);
+    }
+
+    /**
+     * \return the number of entries, expired or not.
+     */
+    std::size_t GetSize() const
+    {
+        return m_entries.size();
+    }
+
+  private:
+    /**
+     * \param originator The message originator.
+     * \param sequence The message sequence number.
+     * \return the hash key.
+     */
+    static uint64_t Key(Ipv4Address originator, uint16_t sequence)
+    {
+        return (uint64_t(originator.Get()) << 16) | sequence;
+    }
+
+    /**
+     * Drop the expired entries at the front of the expiration queue.
+     *
+     * \param now The current time.
+     */
+    void Purge(Time now)
+    {
+        while (!m_expiries.empty() && m_expiries.front().first <= now)
+        {
+            auto it = m_entries.find(m_expiries.front().second);
+            // a later insertion of the key extended it: its own record erases it
+            if (it != m_entries.end() && it->second <= now)
+            {
+                m_entries.erase(it);
+            }
+            m_expiries.pop_front();
+        }
+    }
+
+    std::unordered_map<uint64_t, Time> m_entries;     //!< Expiration time, by key
+    std::deque<std::pair<Time, uint64_t>> m_expiries; //!< (expiration, key), in insertion order
+};
+
+} // namespace ns3
+
+#endif /* OLSR_DENSE_SETS_H */
@@ -0,0 +1,369 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Control-plane cost of OLSR against node density.
+//
+// For every grid spacing, the program
+//  - runs OLSR alone (no data traffic) on a grid of numNodes nodes whose
+//    radio range is exactly --range, and reports the wall-clock time and the
+//    number of events per simulated second;
+//  - takes the one-hop and two-hop neighborhoods of up to --samples nodes
+//    from the same topology and times MPR selection with the list-based
+//    structure of the OLSR routing protocol and with bitsets
+//    (olsr-dense-sets.h), checking that both select the same MPRs;
+//  - replays the TC floods that one node receives in --simulationTime
+//    seconds (every originator every 5 s, one copy per MPR of the node, with
+//    OLSR's emission and forwarding jitter) into a linearly scanned
+//    duplicate set and into a hashed one.
+//
+// ./ns3 run "olsr-density-benchmark --numNodes=400 --distances=50,35,25,20"
+//
+
+#include "olsr-dense-sets.h"
+#include "scenario-generator.h"
+
+#include "ns3/abort.h"
+#include "ns3/command-line.h"
+#include "ns3/double.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/log.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/olsr-helper.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/string.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-helper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("OlsrDensityBenchmark");
+
+/**
+ * \param start The start of the measurement.
+ * \return the wall-clock time elapsed since start, in milliseconds.
+ */
+double
+ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+/**
+ * \param generator The topology.
+ * \param node A node.
+ * \param range The radio range (m).
+ * \return the MPR selection input of the node.
+ */
+MprNeighborhood
+BuildNeighborhood(const ScenarioGenerator& generator, uint32_t node, double range)
+{
+    std::vector<uint32_t> oneHop = generator.GetNeighbors(node, 1);
+    std::vector<uint32_t> upToTwo = generator.GetNeighbors(node, 2);
+    std::vector<uint32_t> twoHop;
+    std::set_difference(upToTwo.begin(),
+                        upToTwo.end(),
+                        oneHop.begin(),
+                        oneHop.end(),
+                        std::back_inserter(twoHop));
+
+    MprNeighborhood hood;
+    hood.willingness.assign(oneHop.size(), MprNeighborhood::WILL_DEFAULT);
+    hood.coverage.resize(oneHop.size());
+    hood.nTwoHop = twoHop.size();
+    for (uint32_t y = 0; y < oneHop.size(); y++)
+    {
+        for (uint32_t z : generator.GetNodesWithin(generator.GetPosition(oneHop[y]), range))
+        {
+            auto it = std::lower_bound(twoHop.begin(), twoHop.end(), z);
+            if (it != twoHop.end() && *it == z)
+            {
+                hood.coverage[y].push_back(it - twoHop.begin());
+            }
+        }
+    }
+    return hood;
+}
+
+/**
+ * Duplicate tuple, as stored by the OLSR routing protocol.
+ */
+struct DuplicateTuple
+{
+    Ipv4Address originator; //!< Originator address
+    uint16_t sequence;      //!< Message sequence number
+    Time expires;           //!< Expiration time
+};
+
+/**
+ * One copy of a TC message reaching a node.
+ */
+struct FloodArrival
+{
+    Time time;              //!< Arrival time
+    Ipv4Address originator; //!< Originator address
+    uint16_t sequence;      //!< Message sequence number
+};
+
+/**
+ * \brief Draw the TC floods received by one node, sorted by arrival time.
+ *
+ * Each originator emits every 5 s from a random phase, each emission
+ * delayed by a jitter of up to OLSR's MAXJITTER (0.5 s), from a random
+ * initial sequence number.  Each copy of a message comes through 1 to 4
+ * relays, each adding its own forwarding jitter of up to MAXJITTER, so the
+ * copies of a message and the messages of different originators interleave.
+ *
+ * \param numNodes The number of originators.
+ * \param copies The number of copies of each message received.
+ * \param simulationTime The replayed duration (s).
+ * \return the arrivals.
+ */
+std::vector<FloodArrival>
+DrawFloods(uint32_t numNodes, uint32_t copies, double simulationTime)
+{
+    const double tcInterval = 5;
+    const double maxJitter = 0.5;
+    Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
+    std::vector<FloodArrival> arrivals;
+    for (uint32_t o = 0; o < numNodes; o++)
+    {
+        Ipv4Address originator(0x0a000001 + o);
+        auto sequence = static_cast<uint16_t>(uv->GetInteger(0, 65535));
+        for (double emission = uv->GetValue(0, tcInterval); emission < simulationTime;
+             emission += tcInterval)
+        {
+            double sent = emission + uv->GetValue(0, maxJitter);
+            for (uint32_t copy = 0; copy < std::max<uint32_t>(copies, 1); copy++)
+            {
+                double arrival = sent;
+                for (uint32_t relay = uv->GetInteger(1, 4); relay > 0; relay--)
+                {
+                    arrival += uv->GetValue(0, maxJitter);
+                }
+                arrivals.push_back({Seconds(arrival), originator, sequence});
+            }
+            sequence++;
+        }
+    }
+    std::stable_sort(arrivals.begin(),
+                     arrivals.end(),
+                     [](const FloodArrival& a, const FloodArrival& b) { return a.time < b.time; });
+    return arrivals;
+}
+
+/**
+ * Replay the TC floods received by one node into a duplicate set.
+ *
+ * \param arrivals The TC messages received, sorted by arrival time.
+ * \param hashed Whether to use DuplicateIndex rather than a tuple vector.
+ * \return the number of messages found to be new.
+ */
+uint64_t
+ReplayFloods(const std::vector<FloodArrival>& arrivals, bool hashed)
+{
+    const Time holdTime = Seconds(30);
+    DuplicateIndex index;
+    std::vector<DuplicateTuple> tuples;
+    uint64_t fresh = 0;
+    for (const auto& arrival : arrivals)
+    {
+        Time now = arrival.time;
+        // the OLSR routing protocol drops each tuple in its expiration event;
+        // tuples are appended in arrival order, so in expiration order
+        while (!hashed && !tuples.empty() && tuples.front().expires <= now)
+        {
+            tuples.erase(tuples.begin());
+        }
+        bool duplicate;
+        if (hashed)
+        {
+            duplicate = index.IsDuplicate(arrival.originator, arrival.sequence, now);
+        }
+        else
+        {
+            duplicate =
+                std::any_of(tuples.begin(), tuples.end(), [&](const DuplicateTuple& tuple) {
+                    return tuple.originator == arrival.originator &&
+                           tuple.sequence == arrival.sequence;
+                });
+        }
+        if (duplicate)
+        {
+            continue;
+        }
+        fresh++;
+        if (hashed)
+        {
+            index.Insert(arrival.originator, arrival.sequence, now + holdTime);
+        }
+        else
+        {
+            tuples.push_back({arrival.originator, arrival.sequence, now + holdTime});
+        }
+    }
+    return fresh;
+}
+
+/**
+ * \brief Run OLSR alone on the topology.
+ *
+ * \param generator The topology.
+ * \param range The radio range (m).
+ * \param simulationTime The simulated duration (s).
+ * \return the wall-clock time of the run, in milliseconds.
+ */
+double
+RunOlsr(const ScenarioGenerator& generator, double range, double simulationTime)
+{
+    NodeContainer c;
+    c.Create(generator.GetN());
+
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211a);
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                 "DataMode",
+                                 StringValue("OfdmRate6Mbps"));
+    YansWifiChannelHelper wifiChannel;
+    wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
+    wifiChannel.AddPropagationLoss("ns3::RangePropagationLossModel",
+                                   "MaxRange",
+                                   DoubleValue(range));
+    YansWifiPhyHelper wifiPhy;
+    wifiPhy.SetChannel(wifiChannel.Create());
+    WifiMacHelper wifiMac;
+    wifiMac.SetType("ns3::AdhocWifiMac");
+    NetDeviceContainer devices = wifi.Install(wifiPhy, wifiMac, c);
+
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator(generator.GetPositionAllocator());
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(c);
+
+    OlsrHelper olsr;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(olsr);
+    internet.Install(c);
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.0.0.0");
+    address.Assign(devices);
+
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Stop(Seconds(simulationTime));
+    Simulator::Run();
+    return ElapsedMs(start);
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t numNodes = 400;
+    std::string distances = "50,35,25,20";
+    double range = 100;         // m
+    double simulationTime = 20; // s
+    uint32_t samples = 32;
+    bool olsr = true;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("numNodes", "number of nodes", numNodes);
+    cmd.AddValue("distances", "comma-separated grid spacings (m)", distances);
+    cmd.AddValue("range", "radio range (m)", range);
+    cmd.AddValue("simulationTime", "simulated time of each OLSR run (s)", simulationTime);
+    cmd.AddValue("samples", "nodes whose MPRs are computed", samples);
+    cmd.AddValue("olsr", "run the OLSR simulations", olsr);
+    cmd.Parse(argc, argv);
+
+    std::cout << std::setw(8) << "spacing" << std::setw(8) << "N1" << std::setw(8) << "N2"
+              << std::setw(8) << "MPRs" << std::setw(12) << "list(us)" << std::setw(12)
+              << "bitset(us)" << std::setw(12) << "dup-list" << std::setw(12) << "dup-hash"
+              << std::setw(12) << "olsr(ms/s)" << std::setw(12) << "events/s" << std::endl;
+
+    std::istringstream list(distances);
+    std::string token;
+    while (std::getline(list, token, ','))
+    {
+        double distance = std::stod(token);
+        ScenarioGenerator generator;
+        generator.SetSpacing(distance);
+        generator.SetRange(range);
+        generator.Generate(numNodes);
+
+        uint32_t step = std::max<uint32_t>(1, numNodes / std::max<uint32_t>(1, samples));
+        std::vector<MprNeighborhood> hoods;
+        double oneHop = 0;
+        double twoHop = 0;
+        for (uint32_t node = step / 2; node < numNodes && hoods.size() < samples; node += step)
+        {
+            hoods.push_back(BuildNeighborhood(generator, node, range));
+            oneHop += hoods.back().GetN();
+            twoHop += hoods.back().nTwoHop;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::vector<uint32_t>> listMprs;
+        for (const auto& hood : hoods)
+        {
+            listMprs.push_back(MprSelection::ComputeList(hood));
+        }
+        double listUs = ElapsedMs(start) * 1000 / hoods.size();
+        start = std::chrono::steady_clock::now();
+        double mprs = 0;
+        for (uint32_t i = 0; i < hoods.size(); i++)
+        {
+            std::vector<uint32_t> bitsetMprs = MprSelection::ComputeBitset(hoods[i]);
+            NS_ABORT_MSG_IF(bitsetMprs != listMprs[i], "MPR sets differ for sample " << i);
+            mprs += bitsetMprs.size();
+        }
+        double bitsetUs = ElapsedMs(start) * 1000 / hoods.size();
+
+        auto copies = static_cast<uint32_t>(mprs / hoods.size());
+        std::vector<FloodArrival> arrivals = DrawFloods(numNodes, copies, simulationTime);
+        start = std::chrono::steady_clock::now();
+        uint64_t fresh = ReplayFloods(arrivals, false);
+        double dupList = ElapsedMs(start);
+        start = std::chrono::steady_clock::now();
+        NS_ABORT_MSG_IF(ReplayFloods(arrivals, true) != fresh, "duplicate sets disagree");
+        double dupHash = ElapsedMs(start);
+
+        double olsrMs = 0;
+        double events = 0;
+        if (olsr)
+        {
+            olsrMs = RunOlsr(generator, range, simulationTime) / simulationTime;
+            events = Simulator::GetEventCount() / simulationTime;
+            Simulator::Destroy();
+        }
+
+        std::cout << std::fixed << std::setprecision(1) << std::setw(8) << distance
+                  << std::setw(8) << oneHop / hoods.size() << std::setw(8)
+                  << twoHop / hoods.size() << std::setw(8) << mprs / hoods.size()
+                  << std::setw(12) << listUs << std::setw(12) << bitsetUs << std::setw(12)
+                  << dupList << std::setw(12) << dupHash << std::setw(12) << olsrMs
+                  << std::setw(12) << std::setprecision(0) << events << std::endl;
+    }
+    std::cout << "dup-list and dup-hash: wall-clock ms to replay the TC floods one node "
+                 "receives in "
+              << simulationTime << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REPLICATION_POOL_H
+#define REPLICATION_POOL_H
+
+#include "ns3/abort.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <poll.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Runs independent simulations in parallel, each in a worker forked from
+ * the current process.
+ *
+ * The simulator, the node list, the random number streams and the attribute
+ * defaults are process-wide, so two simulations cannot share a process, not
+ * even in different threads.  Forking gives every run its own copy of them
+ * while sharing, copy-on-write, what was set up before: the loaded
+ * libraries, the registered TypeIds and the parsed configuration.  A worker
+ * therefore starts without reloading anything, but must only build its
+ * simulation after the fork: Run () is called before any Simulator use.
+ *
+ * Each task returns its result as a string, sent back to the parent over a
+ * pipe.  The worker then exits without tearing its simulation down.  With a
+ * single job, the tasks run in turn in the current process.
+ */
+class ReplicationPool
+{
+  public:
+    /**
+     * \param jobs The maximum number of workers running at once.
+     */
+    explicit ReplicationPool(uint32_t jobs)
+        : m_jobs(std::max<uint32_t>(jobs, 1))
+    {
+    }
+
+    /**
+     * \brief Run tasks, up to the number of jobs at a time.
+     *
+     * \param count The number of tasks.
+     * \param task The task, called with its index.
+     * \return the results of the tasks, by index.
+     */
+    std::vector<std::string> Run(uint32_t count, const std::function<std::string(uint32_t)>& task)
+    {
+        std::vector<std::string> results(count);
+        if (m_jobs == 1)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                results[i] = task(i);
+            }
+            return results;
+        }
+
+        std::vector<Worker> running;
+        uint32_t next = 0;
+        while (next < count || !running.empty())
+        {
+            while (next < count && running.size() < m_jobs)
+            {
+                running.push_back(Start(next++, task));
+            }
+            std::vector<pollfd> fds;
+            for (const auto& worker : running)
+            {
+                fds.push_back({worker.fd, POLLIN, 0});
+            }
+            poll(fds.data(), fds.size(), -1);
+            for (std::size_t i = fds.size(); i-- > 0;)
+            {
+                if (fds[i].revents == 0)
+                {
+                    continue;
+                }
+                Worker& worker = running[i];
+                char buffer[4096];
+                ssize_t n = read(worker.fd, buffer, sizeof(buffer));
+                if (n > 0)
+                {
+                    worker.output.append(buffer, n);
+                    continue;
+                }
+                close(worker.fd);
+                int status = 0;
+                waitpid(worker.pid, &status, 0);
+                NS_ABORT_MSG_IF(!WIFEXITED(status) || WEXITSTATUS(status) != 0,
+                                "Replication " << worker.index << " failed");
+                results[worker.index] = std::move(worker.output);
+                running.erase(running.begin() + i);
+            }
+        }
+        return results;
+    }
+
+  private:
+    /// A running task
+    struct Worker
+    {
+        pid_t pid;          //!< Process of the task
+        int fd;             //!< Read end of its result pipe
+        uint32_t index;     //!< Index of the task
+        std::string output; //!< Result received so far
+    };
+
+    /**
+     * \param index The index of the task.
+     * \param task The task.
+     * \return the worker running it.
+     */
+    static Worker Start(uint32_t index, const std::function<std::string(uint32_t)>& task)
+    {
+        int fds[2];
+        NS_ABORT_MSG_IF(pipe(fds) != 0, "Cannot create the result pipe");
+        // buffered output would otherwise be written by both processes
+        std::cout.flush();
+        std::fflush(nullptr);
+        pid_t pid = fork();
+        NS_ABORT_MSG_IF(pid < 0, "Cannot fork a replication");
+        if (pid == 0)
+        {
+            close(fds[0]);
+            std::string result = task(index);
+            for (std::size_t written = 0; written < result.size();)
+            {
+                ssize_t n = write(fds[1], result.data() + written, result.size() - written);
+                if (n <= 0)
+                {
+                    _exit(1);
+                }
+                written += n;
+            }
+            std::cout.flush();
+            std::fflush(nullptr);
+            _exit(0);
+        }
+        close(fds[1]);
+        return {pid, fds[0], index, ""};
+    }
+
+    uint32_t m_jobs; //!< Maximum number of workers running at once
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_POOL_H */
@@ -0,0 +1,445 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "ns3/global-value.h"
+#include "ns3/hash.h"
+#include "ns3/string.h"
+#include "ns3/type-id.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * On-disk cache of the results of simulation runs, keyed by their complete
+ * configuration.
+ *
+ * The key of a run hashes the command line arguments, the initial value of
+ * every attribute of every registered TypeId (which includes Config::SetDefault
+ * and --ns3::Type::Attribute overrides), every GlobalValue (RngRun, RngSeed,
+ * simulator implementation...), the contents of the input files registered
+ * with AddInput (), the contents of the executable and the path, size and
+ * modification time of every shared library mapped into the process, and the
+ * name of the point when a program runs several configurations in turn.  When
+ * the executable cannot be read, the build is unknown and the cache is
+ * bypassed: every Begin () misses and End () stores nothing.
+ *
+ * Begin () looks the key up.  On a hit, it restores the stored output files,
+ * writes the stored standard output to std::cout and returns true, and
+ * GetValue () returns the stored result.  On a miss, it starts copying
+ * std::cout; End () then stores what was printed, the given result and the
+ * output files registered with AddOutput () since the previous End (), which
+ * must be complete (closed or flushed) by then.  With forceRerun set, every
+ * Begin () misses and End () replaces the stored entry.
+ *
+ * Each entry is a directory named after the key, holding the full text the
+ * key was computed from, so a hash collision is detected and treated as a
+ * miss.  Entries are written to a temporary directory first and renamed, so
+ * concurrent runs of a sweep can share a store.
+ */
+class ResultCache
+{
+  public:
+    ResultCache() = default;
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    ~ResultCache()
+    {
+        StopCapture();
+    }
+
+    /**
+     * \brief Enable the cache.
+     *
+     * \param directory The store directory, empty to disable the cache.
+     * \param forceRerun Whether to run and store even if an entry exists.
+     */
+    void Enable(const std::string& directory, bool forceRerun = false)
+    {
+        m_directory = directory;
+        m_forceRerun = forceRerun;
+    }
+
+    /**
+     * \return true if the cache is enabled.
+     */
+    bool IsEnabled() const
+    {
+        return !m_directory.empty();
+    }
+
+    /**
+     * \param argc The argument count.
+     * \param argv The arguments; the cache options themselves are skipped.
+     * \param ignored Other options left out of the key, by name, such as
+     *        the options of a process pool that do not change the results.
+     */
+    void SetArguments(int argc, char** argv, const std::vector<std::string>& ignored = {})
+    {
+        m_arguments.clear();
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg(argv[i]);
+            std::string name = arg.substr(0, arg.find('='));
+            name.erase(0, name.find_first_not_of('-'));
+            if (name != "resultCache" && name != "forceRerun" &&
+                std::find(ignored.begin(), ignored.end(), name) == ignored.end())
+            {
+                m_arguments += arg + "\n";
+            }
+        }
+    }
+
+    /**
+     * \brief Register an input file of the run, whose contents are part of
+     * the key of the following Begin () calls.
+     *
+     * \param filename The file name.
+     */
+    void AddInput(const std::string& filename)
+    {
+        m_inputs.push_back(filename);
+    }
+
+    /**
+     * \brief Register an output file of the run, stored by End ().
+     *
+     * \param filename The file name.
+     */
+    void AddOutput(const std::string& filename)
+    {
+        m_outputs.push_back(filename);
+    }
+
+    /**
+     * \brief Look up a run.
+     *
+     * \param point The configuration point within the program, if several.
+     * \return true if the run was found and its outputs replayed.
+     */
+    bool Begin(const std::string& point = "")
+    {
+        if (!IsEnabled())
+        {
+            return false;
+        }
+        if (GetBuildId().empty())
+        {
+            std::cerr << "ResultCache: cannot identify the build, results are not cached"
+                      << std::endl;
+            m_directory.clear();
+            return false;
+        }
+        m_configuration = GetConfiguration(point);
+        m_entry = std::filesystem::path(m_directory) / Hex(Hash64(m_configuration));
+        if (!m_forceRerun && Replay())
+        {
+            m_outputs.clear();
+            return true;
+        }
+        m_capture.Start(std::cout);
+        return false;
+    }
+
+    /**
+     * \return the result stored with the entry found by Begin ().
+     */
+    const std::string& GetValue() const
+    {
+        return m_value;
+    }
+
+    /**
+     * \brief Store the run started by a missed Begin ().
+     *
+     * \param value The result of the run.
+     */
+    void End(const std::string& value = "")
+    {
+        if (!IsEnabled() || !m_capture.IsActive())
+        {
+            return;
+        }
+        std::string out = StopCapture();
+        std::vector<std::string> outputs;
+        outputs.swap(m_outputs);
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        fs::path tmp = m_entry;
+        tmp += ".tmp." + std::to_string(getpid());
+        fs::create_directories(tmp, ec);
+        std::ofstream(tmp / "configuration", std::ios::binary) << m_configuration;
+        std::ofstream(tmp / "stdout", std::ios::binary) << out;
+        std::ofstream(tmp / "value", std::ios::binary) << value;
+        std::ofstream manifest(tmp / "outputs");
+        for (std::size_t i = 0; i < outputs.size(); i++)
+        {
+            fs::copy_file(outputs[i],
+                          tmp / ("output" + std::to_string(i)),
+                          fs::copy_options::overwrite_existing,
+                          ec);
+            if (ec)
+            {
+                std::cerr << "ResultCache: cannot store " << outputs[i] << ": " << ec.message()
+                          << std::endl;
+                fs::remove_all(tmp, ec);
+                return;
+            }
+            manifest << outputs[i] << "\n";
+        }
+        manifest.close();
+        fs::remove_all(m_entry, ec);
+        fs::rename(tmp, m_entry, ec);
+        if (ec)
+        {
+            // another run stored the same entry first
+            fs::remove_all(tmp, ec);
+        }
+    }
+
+    /**
+     * \param value A result.
+     * \return the result printed with enough digits to read it back exactly.
+     */
+    static std::string Format(double value)
+    {
+        std::ostringstream oss;
+        oss << std::setprecision(17) << value;
+        return oss.str();
+    }
+
+  private:
+    /// Copies what is written to a stream while passing it through
+    class Capture : public std::streambuf
+    {
+      public:
+        /**
+         * \param os The stream to copy.
+         */
+        void Start(std::ostream& os)
+        {
+            m_stream = &os;
+            m_target = os.rdbuf(this);
+            m_copy.clear();
+        }
+
+        /**
+         * \return the text written since Start ().
+         */
+        std::string Stop()
+        {
+            m_stream->rdbuf(m_target);
+            m_stream = nullptr;
+            return std::move(m_copy);
+        }
+
+        /**
+         * \return true between Start () and Stop ().
+         */
+        bool IsActive() const
+        {
+            return m_stream != nullptr;
+        }
+
+      protected:
+        int overflow(int c) override
+        {
+            if (c != traits_type::eof())
+            {
+                m_copy.push_back(static_cast<char>(c));
+                return m_target->sputc(static_cast<char>(c));
+            }
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override
+        {
+            m_copy.append(s, n);
+            return m_target->sputn(s, n);
+        }
+
+        int sync() override
+        {
+            return m_target->pubsync();
+        }
+
+      private:
+        std::ostream* m_stream{nullptr};   //!< The copied stream
+        std::streambuf* m_target{nullptr}; //!< Its original buffer
+        std::string m_copy;                //!< The text written so far
+    };
+
+    /**
+     * \return the text captured so far, once capture is stopped.
+     */
+    std::string StopCapture()
+    {
+        return m_capture.IsActive() ? m_capture.Stop() : std::string();
+    }
+
+    /**
+     * Restore the stored entry, if any.
+     *
+     * \return true on a hit.
+     */
+    bool Replay()
+    {
+        namespace fs = std::filesystem;
+        if (ReadFile(m_entry / "configuration") != m_configuration)
+        {
+            return false;
+        }
+        std::ifstream manifest(m_entry / "outputs");
+        std::string filename;
+        std::error_code ec;
+        for (std::size_t i = 0; std::getline(manifest, filename); i++)
+        {
+            fs::copy_file(m_entry / ("output" + std::to_string(i)),
+                          filename,
+                          fs::copy_options::overwrite_existing,
+                          ec);
+            if (ec)
+            {
+                return false;
+            }
+        }
+        m_value = ReadFile(m_entry / "value");
+        std::cout << ReadFile(m_entry / "stdout") << std::flush;
+        return true;
+    }
+
+    /**
+     * \param point The configuration point within the program.
+     * \return the text the key is computed from.
+     */
+    std::string GetConfiguration(const std::string& point) const
+    {
+        std::ostringstream oss;
+        oss << "build " << GetBuildId() << "\n";
+        oss << "arguments\n" << m_arguments;
+        for (const auto& filename : m_inputs)
+        {
+            oss << "input " << filename << " " << Hex(Hash64(ReadFile(filename))) << "\n";
+        }
+        oss << "point " << point << "\n";
+        for (auto it = GlobalValue::Begin(); it != GlobalValue::End(); ++it)
+        {
+            StringValue value;
+            (*it)->GetValue(value);
+            oss << (*it)->GetName() << "=" << value.Get() << "\n";
+        }
+        for (uint16_t i = 0; i < TypeId::GetRegisteredN(); i++)
+        {
+            TypeId tid = TypeId::GetRegistered(i);
+            for (std::size_t j = 0; j < tid.GetAttributeN(); j++)
+            {
+                TypeId::AttributeInformation info = tid.GetAttribute(j);
+                oss << tid.GetName() << "::" << info.name << "="
+                    << info.initialValue->SerializeToString(info.checker) << "\n";
+            }
+        }
+        return oss.str();
+    }
+
+    /**
+     * \return a hash of the executable and the identity of the mapped
+     *         libraries, empty if the executable cannot be read.
+     */
+    static std::string GetBuildId()
+    {
+        static std::string id;
+        if (id.empty())
+        {
+            std::string identity = ReadFile("/proc/self/exe");
+            if (identity.empty())
+            {
+                return id;
+            }
+            std::ifstream maps("/proc/self/maps");
+            std::string line;
+            std::string last;
+            while (std::getline(maps, line))
+            {
+                std::size_t slash = line.find('/');
+                if (slash == std::string::npos || line.find(".so", slash) == std::string::npos)
+                {
+                    continue;
+                }
+                std::string path = line.substr(slash);
+                struct stat st;
+                if (path != last && stat(path.c_str(), &st) == 0)
+                {
+                    identity += path + " " + std::to_string(st.st_size) + " " +
+                                std::to_string(st.st_mtime) + "\n";
+                }
+                last = path;
+            }
+            id = Hex(Hash64(identity));
+        }
+        return id;
+    }
+
+    /**
+     * \param path A file.
+     * \return its contents, empty if it cannot be read.
+     */
+    static std::string ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream is(path, std::ios::binary);
+        std::ostringstream oss;
+        oss << is.rdbuf();
+        return oss.str();
+    }
+
+    /**
+     * \param hash A hash.
+     * \return its hexadecimal representation.
+     */
+    static std::string Hex(uint64_t hash)
+    {
+        std::ostringstream oss;
+        oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return oss.str();
+    }
+
+    std::string m_directory;            //!< Store directory, empty if disabled
+    bool m_forceRerun{false};           //!< Whether to ignore stored entries
+    std::string m_arguments;            //!< Command line arguments
+    std::vector<std::string> m_inputs;  //!< Input files of the runs
+    std::vector<std::string> m_outputs; //!< Output files of the current run
+    std::string m_configuration;        //!< Key text of the current run
+    std::filesystem::path m_entry;      //!< Entry directory of the current run
+    std::string m_value;                //!< Result of the entry found
+    Capture m_capture;                  //!< Standard output copy of the current run
+};
+
+} // namespace ns3
+
+#endif /* RESULT_CACHE_H */
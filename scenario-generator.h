@@ -0,0 +1,527 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCENARIO_GENERATOR_H
+#define SCENARIO_GENERATOR_H
+
+#include "ns3/abort.h"
+#include "ns3/position-allocator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Node placement and traffic endpoints for topologies of any size.
+ *
+ * The generator places nodes on a grid, uniformly in a disk or in clusters,
+ * with the same mean density as the grid for a given spacing, and indexes
+ * them in a uniform grid of cells of one hop range.  A lookup of the nodes
+ * around a point then visits only the cells overlapping the search radius,
+ * so k-hop neighborhoods, nearest nodes and source/destination pairs cost
+ * the same on 100 or 100,000 nodes.
+ *
+ * Hops are counted on the unit-disk graph of the hop range: two nodes are
+ * one hop apart when they are within range of each other.
+ */
+class ScenarioGenerator
+{
+  public:
+    /// Node placement
+    enum Placement
+    {
+        GRID,        //!< Row-first grid, as GridPositionAllocator
+        RANDOM_DISK, //!< Uniform in a disk
+        CLUSTERED    //!< Uniform in disks around cluster centers
+    };
+
+    /**
+     * \param name "grid", "disk" or "clustered".
+     * \return the placement.
+     */
+    static Placement ParsePlacement(const std::string& name)
+    {
+        if (name == "grid")
+        {
+            return GRID;
+        }
+        if (name == "disk")
+        {
+            return RANDOM_DISK;
+        }
+        NS_ABORT_MSG_UNLESS(name == "clustered", "Unknown placement " << name);
+        return CLUSTERED;
+    }
+
+    /**
+     * \param placement The placement.
+     */
+    void SetPlacement(Placement placement)
+    {
+        m_placement = placement;
+    }
+
+    /**
+     * \param spacing The grid spacing (m); the other placements keep the same density.
+     */
+    void SetSpacing(double spacing)
+    {
+        m_spacing = spacing;
+    }
+
+    /**
+     * \param width The number of nodes per grid row; 0 for a square grid.
+     */
+    void SetGridWidth(uint32_t width)
+    {
+        m_gridWidth = width;
+    }
+
+    /**
+     * \param clusters The number of clusters.
+     * \param radius The radius of each cluster (m); 0 to hold each cluster
+     *        at the density of the grid.
+     */
+    void SetClusters(uint32_t clusters, double radius)
+    {
+        m_clusters = std::max<uint32_t>(1, clusters);
+        m_clusterRadius = radius;
+    }
+
+    /**
+     * \param range The hop range (m).
+     */
+    void SetRange(double range)
+    {
+        m_range = range;
+    }
+
+    /**
+     * \param stream The first stream index of the random variable.
+     * \return the number of streams used.
+     */
+    int64_t AssignStreams(int64_t stream)
+    {
+        GetUniform()->SetStream(stream);
+        return 1;
+    }
+
+    /**
+     * \brief Place the nodes and index them.
+     *
+     * \param numNodes The number of nodes.
+     */
+    void Generate(uint32_t numNodes)
+    {
+        m_positions.clear();
+        m_positions.reserve(numNodes);
+        // disk radius giving the density of the grid
+        double radius = m_spacing * std::sqrt(numNodes / M_PI);
+        switch (m_placement)
+        {
+        case GRID: {
+            uint32_t width = m_gridWidth;
+            if (width == 0)
+            {
+                width = std::max<uint32_t>(1, std::ceil(std::sqrt(numNodes)));
+            }
+            for (uint32_t i = 0; i < numNodes; i++)
+            {
+                m_positions.emplace_back(m_spacing * (i % width), m_spacing * (i / width), 0);
+            }
+            break;
+        }
+        case RANDOM_DISK:
+            for (uint32_t i = 0; i < numNodes; i++)
+            {
+                m_positions.push_back(DrawInDisk(Vector(radius, radius, 0), radius));
+            }
+            break;
+        case CLUSTERED: {
+            double clusterRadius = m_clusterRadius;
+            if (clusterRadius <= 0)
+            {
+                clusterRadius = m_spacing * std::sqrt(numNodes / m_clusters / M_PI);
+            }
+            std::vector<Vector> centers;
+            for (uint32_t i = 0; i < m_clusters; i++)
+            {
+                centers.push_back(DrawInDisk(Vector(radius, radius, 0), radius));
+            }
+            for (uint32_t i = 0; i < numNodes; i++)
+            {
+                m_positions.push_back(DrawInDisk(centers[i % m_clusters], clusterRadius));
+            }
+            break;
+        }
+        }
+        BuildIndex();
+    }
+
+    /**
+     * \return the number of nodes.
+     */
+    uint32_t GetN() const
+    {
+        return m_positions.size();
+    }
+
+    /**
+     * \param node The node index.
+     * \return its position.
+     */
+    const Vector& GetPosition(uint32_t node) const
+    {
+        return m_positions[node];
+    }
+
+    /**
+     * \return the lower left corner of the bounding box of the nodes.
+     */
+    Vector GetMin() const
+    {
+        return m_min;
+    }
+
+    /**
+     * \return the upper right corner of the bounding box of the nodes.
+     */
+    Vector GetMax() const
+    {
+        return m_max;
+    }
+
+    /**
+     * \return an allocator handing out the positions, in node order.
+     */
+    Ptr<ListPositionAllocator> GetPositionAllocator() const
+    {
+        Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator>();
+        for (const auto& position : m_positions)
+        {
+            allocator->Add(position);
+        }
+        return allocator;
+    }
+
+    /**
+     * \param center The center of the search.
+     * \param radius The search radius (m).
+     * \return the nodes within radius of center, in increasing order.
+     */
+    std::vector<uint32_t> GetNodesWithin(const Vector& center, double radius) const
+    {
+        std::vector<uint32_t> nodes;
+        int64_t x0 = CellX(center.x - radius);
+        int64_t x1 = CellX(center.x + radius);
+        int64_t y0 = CellY(center.y - radius);
+        int64_t y1 = CellY(center.y + radius);
+        for (int64_t y = std::max<int64_t>(0, y0); y <= std::min<int64_t>(m_cellsY - 1, y1); y++)
+        {
+            for (int64_t x = std::max<int64_t>(0, x0); x <= std::min<int64_t>(m_cellsX - 1, x1);
+                 x++)
+            {
+                uint32_t cell = y * m_cellsX + x;
+                for (uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; i++)
+                {
+                    uint32_t node = m_cellNodes[i];
+                    if (CalculateDistance(m_positions[node], center) <= radius)
+                    {
+                        nodes.push_back(node);
+                    }
+                }
+            }
+        }
+        std::sort(nodes.begin(), nodes.end());
+        return nodes;
+    }
+
+    /**
+     * \param node The node index.
+     * \param hops The number of hops.
+     * \return the nodes at most hops hops away from node, node excluded, in
+     *         increasing order.
+     */
+    std::vector<uint32_t> GetNeighbors(uint32_t node, uint32_t hops) const
+    {
+        std::unordered_set<uint32_t> reached{node};
+        std::vector<uint32_t> frontier{node};
+        for (uint32_t hop = 0; hop < hops && !frontier.empty(); hop++)
+        {
+            std::vector<uint32_t> next;
+            for (uint32_t from : frontier)
+            {
+                for (uint32_t to : GetNodesWithin(m_positions[from], m_range))
+                {
+                    if (reached.insert(to).second)
+                    {
+                        next.push_back(to);
+                    }
+                }
+            }
+            frontier.swap(next);
+        }
+        reached.erase(node);
+        std::vector<uint32_t> neighbors(reached.begin(), reached.end());
+        std::sort(neighbors.begin(), neighbors.end());
+        return neighbors;
+    }
+
+    /**
+     * \param point A point.
+     * \return the node nearest to the point; the lowest index on ties.
+     */
+    uint32_t GetNearest(const Vector& point) const
+    {
+        NS_ABORT_MSG_IF(m_positions.empty(), "No nodes");
+        int64_t cx = std::clamp<int64_t>(CellX(point.x), 0, m_cellsX - 1);
+        int64_t cy = std::clamp<int64_t>(CellY(point.y), 0, m_cellsY - 1);
+        uint32_t best = 0;
+        double bestDistance = std::numeric_limits<double>::infinity();
+        for (int64_t ring = 0; ring <= std::max(m_cellsX, m_cellsY); ring++)
+        {
+            // every cell of a farther ring is at least ring - 1 cells away
+            if ((ring - 1) * m_cellSize > bestDistance)
+            {
+                break;
+            }
+            for (int64_t y = cy - ring; y <= cy + ring; y++)
+            {
+                // the rows between the top and bottom of the ring only have two cells
+                int64_t step = std::abs(y - cy) == ring ? 1 : 2 * ring;
+                for (int64_t x = cx - ring; x <= cx + ring; x += step)
+                {
+                    if (x < 0 || y < 0 || x >= m_cellsX || y >= m_cellsY)
+                    {
+                        continue;
+                    }
+                    uint32_t cell = y * m_cellsX + x;
+                    for (uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; i++)
+                    {
+                        uint32_t node = m_cellNodes[i];
+                        double distance = CalculateDistance(m_positions[node], point);
+                        if (distance < bestDistance || (distance == bestDistance && node < best))
+                        {
+                            best = node;
+                            bestDistance = distance;
+                        }
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    /**
+     * \brief Pick senders spread over the area.
+     *
+     * The senders are the nodes nearest to the points of a square lattice of
+     * the given pitch, kept at least one pitch away from the edges of the
+     * bounding box; lattice points with no node within half a pitch are
+     * skipped.  On a 10x10 grid of 30 m with a pitch of 60 m these are
+     * the nodes 22, 24, 26, 42, ..., 66.
+     *
+     * \param pitch The distance between senders (m).
+     * \return the senders, without duplicates.
+     */
+    std::vector<uint32_t> SelectSenders(double pitch) const
+    {
+        std::vector<uint32_t> senders;
+        for (double y = m_min.y + pitch; y <= m_max.y - pitch + 1e-9; y += pitch)
+        {
+            for (double x = m_min.x + pitch; x <= m_max.x - pitch + 1e-9; x += pitch)
+            {
+                Vector point(x, y, 0);
+                double bestDistance = std::numeric_limits<double>::infinity();
+                uint32_t best = 0;
+                for (uint32_t node : GetNodesWithin(point, pitch / 2))
+                {
+                    if (CalculateDistance(m_positions[node], point) < bestDistance)
+                    {
+                        best = node;
+                        bestDistance = CalculateDistance(m_positions[node], point);
+                    }
+                }
+                if (bestDistance <= pitch / 2 &&
+                    std::find(senders.begin(), senders.end(), best) == senders.end())
+                {
+                    senders.push_back(best);
+                }
+            }
+        }
+        if (senders.empty() && !m_positions.empty())
+        {
+            senders.push_back(
+                GetNearest(Vector((m_min.x + m_max.x) / 2, (m_min.y + m_max.y) / 2, 0)));
+        }
+        return senders;
+    }
+
+    /**
+     * \brief Draw source/destination pairs.
+     *
+     * \param count The number of pairs.
+     * \param maxHops The largest number of hops between source and
+     *        destination; 0 for any destination.
+     * \return the pairs; sources without neighbors within maxHops are skipped.
+     */
+    std::vector<std::pair<uint32_t, uint32_t>> SelectPairs(uint32_t count, uint32_t maxHops)
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        if (GetN() < 2)
+        {
+            return pairs;
+        }
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t source = GetUniform()->GetInteger(0, GetN() - 1);
+            if (maxHops == 0)
+            {
+                uint32_t destination = GetUniform()->GetInteger(0, GetN() - 2);
+                pairs.emplace_back(source, destination >= source ? destination + 1 : destination);
+                continue;
+            }
+            std::vector<uint32_t> neighbors = GetNeighbors(source, maxHops);
+            if (!neighbors.empty())
+            {
+                pairs.emplace_back(source,
+                                   neighbors[GetUniform()->GetInteger(0, neighbors.size() - 1)]);
+            }
+        }
+        return pairs;
+    }
+
+  private:
+    /**
+     * Created on first use: a random variable takes the next automatic
+     * stream when it is created, and a grid scenario that draws nothing
+     * here must leave the streams of the other variables as they were.
+     *
+     * \return the random variable of the placement and pair draws.
+     */
+    Ptr<UniformRandomVariable> GetUniform()
+    {
+        if (!m_uniform)
+        {
+            m_uniform = CreateObject<UniformRandomVariable>();
+        }
+        return m_uniform;
+    }
+
+    /**
+     * \param center The disk center.
+     * \param radius The disk radius.
+     * \return a point drawn uniformly in the disk.
+     */
+    Vector DrawInDisk(const Vector& center, double radius)
+    {
+        double r = radius * std::sqrt(GetUniform()->GetValue(0, 1));
+        double theta = GetUniform()->GetValue(0, 2 * M_PI);
+        return Vector(center.x + r * std::cos(theta), center.y + r * std::sin(theta), 0);
+    }
+
+    /**
+     * \param x A coordinate.
+     * \return the column of the cell holding it, possibly out of the index.
+     */
+    int64_t CellX(double x) const
+    {
+        return std::floor((x - m_min.x) / m_cellSize);
+    }
+
+    /**
+     * \param y A coordinate.
+     * \return the row of the cell holding it, possibly out of the index.
+     */
+    int64_t CellY(double y) const
+    {
+        return std::floor((y - m_min.y) / m_cellSize);
+    }
+
+    /**
+     * Sort the nodes into cells of one hop range.
+     */
+    void BuildIndex()
+    {
+        m_min = Vector(0, 0, 0);
+        m_max = Vector(0, 0, 0);
+        if (!m_positions.empty())
+        {
+            m_min = m_max = m_positions.front();
+        }
+        for (const auto& position : m_positions)
+        {
+            m_min.x = std::min(m_min.x, position.x);
+            m_min.y = std::min(m_min.y, position.y);
+            m_max.x = std::max(m_max.x, position.x);
+            m_max.y = std::max(m_max.y, position.y);
+        }
+        // no more cells than a few per node, whatever the range
+        double width = m_max.x - m_min.x;
+        double height = m_max.y - m_min.y;
+        m_cellSize = std::max(m_range, std::sqrt(width * height / (4.0 * GetN() + 1)));
+        m_cellSize = std::max(m_cellSize, 1e-3);
+        m_cellsX = static_cast<int64_t>(width / m_cellSize) + 1;
+        m_cellsY = static_cast<int64_t>(height / m_cellSize) + 1;
+
+        // counting sort of the nodes by cell
+        m_cellStart.assign(m_cellsX * m_cellsY + 1, 0);
+        std::vector<uint32_t> cellOf(GetN());
+        for (uint32_t i = 0; i < GetN(); i++)
+        {
+            cellOf[i] = CellY(m_positions[i].y) * m_cellsX + CellX(m_positions[i].x);
+            m_cellStart[cellOf[i] + 1]++;
+        }
+        for (std::size_t cell = 1; cell < m_cellStart.size(); cell++)
+        {
+            m_cellStart[cell] += m_cellStart[cell - 1];
+        }
+        m_cellNodes.resize(GetN());
+        std::vector<uint32_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+        for (uint32_t i = 0; i < GetN(); i++)
+        {
+            m_cellNodes[fill[cellOf[i]]++] = i;
+        }
+    }
+
+    Placement m_placement{GRID};          //!< Node placement
+    double m_spacing{30};                 //!< Grid spacing (m)
+    uint32_t m_gridWidth{0};              //!< Nodes per grid row, 0 for a square grid
+    uint32_t m_clusters{10};              //!< Number of clusters
+    double m_clusterRadius{0};            //!< Cluster radius (m), 0 for grid density
+    double m_range{45};                   //!< Hop range (m)
+    Ptr<UniformRandomVariable> m_uniform; //!< Placement and pair draws
+    std::vector<Vector> m_positions;      //!< Node positions
+    Vector m_min;                         //!< Lower left corner of the nodes
+    Vector m_max;                         //!< Upper right corner of the nodes
+    double m_cellSize{1};                 //!< Side of an index cell (m)
+    int64_t m_cellsX{0};                  //!< Index columns
+    int64_t m_cellsY{0};                  //!< Index rows
+    std::vector<uint32_t> m_cellStart;    //!< First entry of each cell in m_cellNodes
+    std::vector<uint32_t> m_cellNodes;    //!< Node indices, sorted by cell
+};
+
+} // namespace ns3
+
+#endif /* SCENARIO_GENERATOR_H */
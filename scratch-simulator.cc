@@ -13,6 +13,8 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include "startup-probe.h"
+
 #include "ns3/core-module.h"
 
 using namespace ns3;
@@ -22,8 +24,10 @@ NS_LOG_COMPONENT_DEFINE("ScratchSimulator");
 int
 main(int argc, char* argv[])
 {
+    StartupProbe::Main();
     NS_LOG_UNCOND("Scratch Simulator");
 
+    StartupProbe::BeforeRun();
     Simulator::Run();
     Simulator::Destroy();
 
@@ -0,0 +1,814 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SHARED_MEMORY_SIMULATOR_IMPL_H
+#define SHARED_MEMORY_SIMULATOR_IMPL_H
+
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/event-impl.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/node-list.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/scheduler.h"
+#include "ns3/simulator-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <list>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Conservative parallel simulator for wireless topologies, on one host.
+ *
+ * The nodes are split into Partitions spatial partitions (PartitionNodes),
+ * and Run forks one process per partition after the topology is built: each
+ * process keeps the events of its own nodes and the global events (those
+ * without a node context, e.g. Simulator::Stop and the sampling timers),
+ * and drops the others.  Processes rather than threads, as ReplicationPool
+ * does for replications: the packets of a process share the Buffer free
+ * list, uid counters and non-atomic reference counts, which threads would
+ * race on.
+ *
+ * The only interaction between nodes is the channel.  A transmitting PHY
+ * (BatchedYansWifiPhy) posts the frame and its receivers to a shared-memory
+ * mailbox instead of scheduling them.  The processes run in windows of one
+ * lookahead: all of them process their events up to the earliest pending
+ * time T plus the lookahead, meet at a barrier, and read every posted
+ * frame; no frame posted in the window arrives before its end.  The
+ * lookahead is the smallest propagation delay between two PHYs of the
+ * channel (BatchedYansWifiPhy::GetLookahead).  The preamble time cannot be
+ * added to it: a PHY turns CCA-busy, and its MAC defers, when the energy of
+ * a frame reaches it, not at the end of the preamble.
+ *
+ * Every process reads the frames in the same order, that of the sending
+ * node and of its frames, and schedules the deliveries of its own nodes in
+ * it.  The windows, the events of each node and their relative order do
+ * not depend on the number of partitions, so Partitions=1 is the
+ * sequential reference run: the per-node results of Partitions=N match it
+ * bit for bit.  (They can differ from those of DefaultSimulatorImpl, which
+ * inserts the deliveries when the frame is sent rather than at the end of
+ * the window.)  This holds as long as
+ * - nodes interact through the channel only: an event of one node
+ *   scheduling an event of another aborts;
+ * - the propagation models draw no random values: the draws of a model
+ *   shared by all senders depend on the global order of transmissions;
+ * - the nodes do not move, and no object creates a random variable stream
+ *   after Run starts (the stream numbers come from a per-process counter);
+ * - Simulator::Stop is only called from global events.
+ *
+ * At the end of Run each process passes the string returned by the
+ * collect callback (SetCollectCallback) to the parent and exits; Run
+ * returns in the parent only, with the strings of all partitions in
+ * GetCollected.  The speedup depends on the number of events in a window:
+ * on a 10x10 grid the windows are too short to pay for the barriers, and
+ * it only serves as the correctness test; every process also holds the
+ * whole topology in memory.
+ */
+class SharedMemorySimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::SharedMemorySimulatorImpl")
+                .SetParent<SimulatorImpl>()
+                .AddConstructor<SharedMemorySimulatorImpl>()
+                .AddAttribute("Partitions",
+                              "The number of partitions, each run by its own process.",
+                              UintegerValue(1),
+                              MakeUintegerAccessor(&SharedMemorySimulatorImpl::m_partitions),
+                              MakeUintegerChecker<uint32_t>(1, 256))
+                .AddAttribute("MailboxSize",
+                              "The bytes a partition can post in one window.",
+                              UintegerValue(32 << 20),
+                              MakeUintegerAccessor(&SharedMemorySimulatorImpl::m_mailboxSize),
+                              MakeUintegerChecker<uint64_t>(1 << 16));
+        return tid;
+    }
+
+    /**
+     * \return the simulator implementation, if it is a SharedMemorySimulatorImpl.
+     */
+    static Ptr<SharedMemorySimulatorImpl> Get()
+    {
+        return DynamicCast<SharedMemorySimulatorImpl>(Simulator::GetImplementation());
+    }
+
+    SharedMemorySimulatorImpl()
+        : m_stop(false),
+          m_uid(EventId::UID::VALID),
+          m_currentUid(EventId::UID::INVALID),
+          m_currentTs(0),
+          m_currentContext(Simulator::NO_CONTEXT),
+          m_unscheduledEvents(0),
+          m_eventCount(0)
+    {
+    }
+
+    ~SharedMemorySimulatorImpl() override
+    {
+        if (m_shared != nullptr)
+        {
+            munmap(m_shared, m_sharedSize);
+        }
+    }
+
+    /**
+     * \brief Spread the nodes over the partitions in vertical strips.
+     *
+     * The nodes are sorted by x, then y, and cut into Partitions runs of
+     * equal size.  Nodes not passed here are spread by id.
+     *
+     * \param nodes The nodes, with their mobility models.
+     */
+    void PartitionNodes(const NodeContainer& nodes)
+    {
+        std::vector<std::tuple<double, double, uint32_t>> positions;
+        for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+        {
+            Ptr<MobilityModel> mobility = (*it)->GetObject<MobilityModel>();
+            NS_ABORT_MSG_UNLESS(mobility, "Node " << (*it)->GetId() << " has no mobility model");
+            Vector position = mobility->GetPosition();
+            positions.emplace_back(position.x, position.y, (*it)->GetId());
+        }
+        std::sort(positions.begin(), positions.end());
+        for (std::size_t i = 0; i < positions.size(); i++)
+        {
+            uint32_t node = std::get<2>(positions[i]);
+            if (m_partitionOf.size() <= node)
+            {
+                m_partitionOf.resize(node + 1, kUnassigned);
+            }
+            m_partitionOf[node] = i * m_partitions / positions.size();
+        }
+    }
+
+    /**
+     * \param lookahead The smallest delay between a frame being sent and
+     *        its first reception.
+     */
+    void SetLookahead(Time lookahead)
+    {
+        m_lookahead = lookahead;
+    }
+
+    /**
+     * \param receive Called with each posted message, in every process, in
+     *        the same order; it schedules the deliveries to the local nodes.
+     */
+    void SetReceiveCallback(Callback<void, const uint8_t*, uint32_t> receive)
+    {
+        m_receive = receive;
+    }
+
+    /**
+     * \param collect Called at the end of Run in every process; returns
+     *        what the parent gets back from that partition.
+     */
+    void SetCollectCallback(Callback<std::string> collect)
+    {
+        m_collect = collect;
+    }
+
+    /**
+     * \return the strings collected from the partitions, in partition
+     *         order, once Run has returned.
+     */
+    const std::vector<std::string>& GetCollected() const
+    {
+        return m_collected;
+    }
+
+    /**
+     * \param node A node id.
+     * \return whether the events of the node run in this process.
+     */
+    bool IsLocal(uint32_t node) const
+    {
+        return !m_running || GetPartition(node) == m_partition;
+    }
+
+    /**
+     * \brief Post a message to all partitions, from the running event.
+     *
+     * \param source The node the message comes from.
+     * \param earliest The earliest event the message leads to.
+     * \param data The message.
+     * \param size Its size.
+     */
+    void Post(uint32_t source, Time earliest, const uint8_t* data, uint32_t size)
+    {
+        NS_ABORT_MSG_UNLESS(m_running, "Messages are only posted while the simulation runs");
+        NS_ABORT_MSG_IF(static_cast<uint64_t>(earliest.GetTimeStep()) < m_windowEnd,
+                        "A message posted at " << TimeStep(m_currentTs).As(Time::NS)
+                                               << " leads to an event at "
+                                               << earliest.As(Time::NS)
+                                               << ", within the lookahead");
+        NS_ABORT_MSG_IF(m_written + sizeof(MessageHeader) + size > m_mailboxSize,
+                        "The messages of one window exceed the MailboxSize of "
+                            << m_mailboxSize << " bytes");
+        if (m_sequence.size() <= source)
+        {
+            m_sequence.resize(source + 1, 0);
+        }
+        MessageHeader header{size, source, m_sequence[source]++};
+        uint8_t* mailbox = GetMailbox(m_partition, m_window % 2);
+        std::memcpy(mailbox + m_written, &header, sizeof(header));
+        std::memcpy(mailbox + m_written + sizeof(header), data, size);
+        m_written += sizeof(header) + size;
+        m_posted = std::min(m_posted, static_cast<uint64_t>(earliest.GetTimeStep()));
+    }
+
+    void Destroy() override
+    {
+        while (!m_destroyEvents.empty())
+        {
+            Ptr<EventImpl> ev = m_destroyEvents.front().PeekEventImpl();
+            m_destroyEvents.pop_front();
+            if (!ev->IsCancelled())
+            {
+                ev->Invoke();
+            }
+        }
+    }
+
+    bool IsFinished() const override
+    {
+        return m_events->IsEmpty() || m_stop;
+    }
+
+    void Stop() override
+    {
+        m_stop = true;
+    }
+
+    EventId Stop(const Time& delay) override
+    {
+        return Simulator::Schedule(delay, &Simulator::Stop);
+    }
+
+    EventId Schedule(const Time& delay, EventImpl* event) override
+    {
+        return Insert(delay, m_currentContext, event);
+    }
+
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override
+    {
+        if (m_running && context != Simulator::NO_CONTEXT &&
+            GetPartition(context) != m_partition)
+        {
+            // a global event schedules the same event in the process of the node
+            NS_ABORT_MSG_IF(m_currentContext != Simulator::NO_CONTEXT && !m_exchanging,
+                            "Node " << m_currentContext << " schedules an event of node "
+                                    << context << " in another partition");
+            event->Unref();
+            return;
+        }
+        Insert(delay, context, event);
+    }
+
+    EventId ScheduleNow(EventImpl* event) override
+    {
+        return Insert(Time(0), m_currentContext, event);
+    }
+
+    EventId ScheduleDestroy(EventImpl* event) override
+    {
+        EventId id(Ptr<EventImpl>(event, false), m_currentTs, 0xffffffff, EventId::UID::DESTROY);
+        m_destroyEvents.push_back(id);
+        m_uid++;
+        return id;
+    }
+
+    void Remove(const EventId& id) override
+    {
+        if (id.GetUid() == EventId::UID::DESTROY)
+        {
+            for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+            {
+                if (*i == id)
+                {
+                    m_destroyEvents.erase(i);
+                    break;
+                }
+            }
+            return;
+        }
+        if (IsExpired(id))
+        {
+            return;
+        }
+        Scheduler::Event event;
+        event.impl = id.PeekEventImpl();
+        event.key.m_ts = id.GetTs();
+        event.key.m_context = id.GetContext();
+        event.key.m_uid = id.GetUid();
+        m_events->Remove(event);
+        event.impl->Cancel();
+        event.impl->Unref();
+        m_unscheduledEvents--;
+    }
+
+    void Cancel(const EventId& id) override
+    {
+        if (!IsExpired(id))
+        {
+            id.PeekEventImpl()->Cancel();
+        }
+    }
+
+    bool IsExpired(const EventId& id) const override
+    {
+        if (id.GetUid() == EventId::UID::DESTROY)
+        {
+            if (id.PeekEventImpl() == nullptr || id.PeekEventImpl()->IsCancelled())
+            {
+                return true;
+            }
+            for (const auto& destroy : m_destroyEvents)
+            {
+                if (destroy == id)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return id.PeekEventImpl() == nullptr || id.GetTs() < m_currentTs ||
+               (id.GetTs() == m_currentTs && id.GetUid() <= m_currentUid) ||
+               id.PeekEventImpl()->IsCancelled();
+    }
+
+    void Run() override
+    {
+        NS_ABORT_MSG_IF(m_lookahead.IsZero() || m_lookahead.IsNegative(),
+                        "SharedMemorySimulatorImpl needs a positive lookahead");
+        NS_ABORT_MSG_IF(m_receive.IsNull(), "SharedMemorySimulatorImpl needs a receive callback");
+        m_stop = false;
+        Fork();
+        while (true)
+        {
+            Slot& slot = GetSlot(m_partition, m_window % 2);
+            slot.next = m_events->IsEmpty() ? kNever : m_events->PeekNext().key.m_ts;
+            slot.posted = m_posted;
+            slot.stop = m_stop;
+            slot.written = m_written;
+            Wait();
+            Exchange();
+            uint64_t next = kNever;
+            bool stop = false;
+            for (uint32_t p = 0; p < m_partitions; p++)
+            {
+                const Slot& other = GetSlot(p, m_window % 2);
+                next = std::min({next, other.next, other.posted});
+                stop = stop || other.stop;
+            }
+            m_window++;
+            m_written = 0;
+            m_posted = kNever;
+            if (stop || next == kNever)
+            {
+                break;
+            }
+            m_windowEnd = next + m_lookahead.GetTimeStep();
+            while (!m_events->IsEmpty() && !m_stop &&
+                   m_events->PeekNext().key.m_ts < m_windowEnd)
+            {
+                ProcessOneEvent();
+            }
+        }
+        Join();
+    }
+
+    Time Now() const override
+    {
+        return TimeStep(m_currentTs);
+    }
+
+    Time GetDelayLeft(const EventId& id) const override
+    {
+        if (IsExpired(id))
+        {
+            return TimeStep(0);
+        }
+        return TimeStep(id.GetTs() - m_currentTs);
+    }
+
+    Time GetMaximumSimulationTime() const override
+    {
+        return TimeStep(0x7fffffffffffffffLL);
+    }
+
+    void SetScheduler(ObjectFactory schedulerFactory) override
+    {
+        Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler>();
+        if (m_events)
+        {
+            while (!m_events->IsEmpty())
+            {
+                scheduler->Insert(m_events->RemoveNext());
+            }
+        }
+        m_events = scheduler;
+    }
+
+    uint32_t GetSystemId() const override
+    {
+        return 0;
+    }
+
+    uint32_t GetContext() const override
+    {
+        return m_currentContext;
+    }
+
+    /**
+     * The global events are counted in the first partition only: the counts
+     * of the partitions add up to that of the sequential run.
+     *
+     * \return the number of events run by this process.
+     */
+    uint64_t GetEventCount() const override
+    {
+        return m_eventCount;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        if (m_events)
+        {
+            while (!m_events->IsEmpty())
+            {
+                m_events->RemoveNext().impl->Unref();
+            }
+        }
+        m_events = nullptr;
+        m_receive = MakeNullCallback<void, const uint8_t*, uint32_t>();
+        m_collect = MakeNullCallback<std::string>();
+        SimulatorImpl::DoDispose();
+    }
+
+  private:
+    /// What a process publishes at a barrier, on its own cache line
+    struct alignas(64) Slot
+    {
+        uint64_t next;    //!< Time of its earliest event
+        uint64_t posted;  //!< Earliest event its messages lead to
+        uint64_t written; //!< Bytes posted in the window
+        uint32_t stop;    //!< Whether it was stopped
+    };
+
+    /// The barrier, at the start of the shared memory
+    struct alignas(64) Control
+    {
+        std::atomic<uint32_t> arrived;    //!< Processes waiting
+        std::atomic<uint32_t> generation; //!< Barrier generation
+    };
+
+    /// Header of a posted message
+    struct MessageHeader
+    {
+        uint32_t size;     //!< Bytes of the message
+        uint32_t source;   //!< Node it comes from
+        uint64_t sequence; //!< Its rank among the messages of that node
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                  "The barrier needs address-free atomics");
+
+    static constexpr uint64_t kNever = std::numeric_limits<uint64_t>::max(); //!< No event
+    static constexpr uint32_t kUnassigned = 0xffffffff; //!< Node left to PartitionNodes
+
+    /**
+     * \param node A node id.
+     * \return its partition.
+     */
+    uint32_t GetPartition(uint32_t node) const
+    {
+        if (node < m_partitionOf.size() && m_partitionOf[node] != kUnassigned)
+        {
+            return m_partitionOf[node];
+        }
+        uint64_t nodes = std::max<uint64_t>(NodeList::GetNNodes(), node + 1);
+        return node * m_partitions / nodes;
+    }
+
+    /**
+     * A process publishes at the next barrier while the others may still
+     * read what it published at the last one: the slots alternate, as the
+     * mailboxes do.
+     *
+     * \param partition A partition.
+     * \param parity The parity of the window.
+     * \return its slot for the barriers of that parity.
+     */
+    Slot& GetSlot(uint32_t partition, uint32_t parity) const
+    {
+        return reinterpret_cast<Slot*>(m_shared + sizeof(Control))[2 * partition + parity];
+    }
+
+    /**
+     * \param partition A partition.
+     * \param parity The parity of the window.
+     * \return the mailbox the partition posts to in the windows of that parity.
+     */
+    uint8_t* GetMailbox(uint32_t partition, uint32_t parity) const
+    {
+        return m_shared + sizeof(Control) + 2 * m_partitions * sizeof(Slot) +
+               (2 * partition + parity) * m_mailboxSize;
+    }
+
+    /**
+     * \brief Schedule an event.
+     *
+     * \param delay The delay from now.
+     * \param context Its context.
+     * \param event The event.
+     * \return its id.
+     */
+    EventId Insert(const Time& delay, uint32_t context, EventImpl* event)
+    {
+        Time tAbsolute = delay + TimeStep(m_currentTs);
+        NS_ASSERT_MSG(tAbsolute.IsPositive(), "SharedMemorySimulatorImpl: negative delay");
+        Scheduler::Event ev;
+        ev.impl = event;
+        ev.key.m_ts = static_cast<uint64_t>(tAbsolute.GetTimeStep());
+        ev.key.m_context = context;
+        ev.key.m_uid = m_uid;
+        m_uid++;
+        m_unscheduledEvents++;
+        m_events->Insert(ev);
+        return EventId(event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+    }
+
+    /**
+     * \brief Run the next event.
+     */
+    void ProcessOneEvent()
+    {
+        Scheduler::Event next = m_events->RemoveNext();
+        NS_ASSERT(next.key.m_ts >= m_currentTs);
+        m_unscheduledEvents--;
+        if (next.key.m_context != Simulator::NO_CONTEXT || m_partition == 0)
+        {
+            m_eventCount++;
+        }
+        m_currentTs = next.key.m_ts;
+        m_currentContext = next.key.m_context;
+        m_currentUid = next.key.m_uid;
+        next.impl->Invoke();
+        next.impl->Unref();
+    }
+
+    /**
+     * \brief Map the shared memory, fork the partitions and drop the events
+     * of the nodes of the other partitions.
+     */
+    void Fork()
+    {
+        m_sharedSize = sizeof(Control) + 2 * m_partitions * sizeof(Slot) +
+                       2 * m_partitions * m_mailboxSize;
+        void* shared = mmap(nullptr,
+                            m_sharedSize,
+                            PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE,
+                            -1,
+                            0);
+        NS_ABORT_MSG_IF(shared == MAP_FAILED, "Cannot map " << m_sharedSize << " shared bytes");
+        m_shared = static_cast<uint8_t*>(shared);
+        new (m_shared) Control{{0}, {0}};
+        m_parent = getpid();
+        std::fflush(nullptr);
+        for (uint32_t p = 1; p < m_partitions; p++)
+        {
+            pid_t pid = fork();
+            NS_ABORT_MSG_IF(pid < 0, "Cannot fork partition " << p);
+            if (pid == 0)
+            {
+                m_partition = p;
+                m_children.clear();
+                break;
+            }
+            m_children.push_back(pid);
+        }
+        m_running = true;
+        m_window = 0;
+        m_windowEnd = 0;
+        m_written = 0;
+        m_posted = kNever;
+
+        Ptr<Scheduler> events = m_events;
+        std::vector<Scheduler::Event> kept;
+        while (!events->IsEmpty())
+        {
+            Scheduler::Event ev = events->RemoveNext();
+            if (ev.key.m_context == Simulator::NO_CONTEXT ||
+                GetPartition(ev.key.m_context) == m_partition)
+            {
+                kept.push_back(ev);
+            }
+            else
+            {
+                ev.impl->Unref();
+                m_unscheduledEvents--;
+            }
+        }
+        for (const auto& ev : kept)
+        {
+            events->Insert(ev);
+        }
+    }
+
+    /**
+     * \brief Read the messages of the window, from all partitions, and pass
+     * them to the receive callback in the order of their source node and rank.
+     */
+    void Exchange()
+    {
+        uint32_t parity = m_window % 2;
+        std::vector<std::pair<MessageHeader, const uint8_t*>> messages;
+        for (uint32_t p = 0; p < m_partitions; p++)
+        {
+            const uint8_t* mailbox = GetMailbox(p, parity);
+            uint64_t offset = 0;
+            while (offset < GetSlot(p, parity).written)
+            {
+                MessageHeader header;
+                std::memcpy(&header, mailbox + offset, sizeof(header));
+                messages.emplace_back(header, mailbox + offset + sizeof(header));
+                offset += sizeof(header) + header.size;
+            }
+        }
+        std::sort(messages.begin(), messages.end(), [](const auto& a, const auto& b) {
+            return std::tie(a.first.source, a.first.sequence) <
+                   std::tie(b.first.source, b.first.sequence);
+        });
+        m_exchanging = true;
+        for (const auto& message : messages)
+        {
+            m_receive(message.second, message.first.size);
+        }
+        m_exchanging = false;
+    }
+
+    /**
+     * \brief Wait for all partitions.
+     */
+    void Wait()
+    {
+        auto control = reinterpret_cast<Control*>(m_shared);
+        uint32_t generation = control->generation.load(std::memory_order_acquire);
+        if (control->arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_partitions)
+        {
+            control->arrived.store(0, std::memory_order_relaxed);
+            control->generation.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        for (uint64_t spin = 1;
+             control->generation.load(std::memory_order_acquire) == generation;
+             spin++)
+        {
+            if (spin % 1024 == 0)
+            {
+                sched_yield();
+            }
+            if (spin % (1 << 20) == 0)
+            {
+                CheckPartitions(generation);
+            }
+        }
+    }
+
+    /**
+     * \brief Give up if a partition is gone, rather than wait for it forever.
+     *
+     * The exited processes are not reaped: once the last barrier is passed
+     * the others exit normally, and Join waits for them.
+     *
+     * \param generation The generation of the barrier being waited for.
+     */
+    void CheckPartitions(uint32_t generation)
+    {
+        if (m_partition != 0)
+        {
+            if (getppid() != m_parent)
+            {
+                _exit(1);
+            }
+            return;
+        }
+        siginfo_t info{};
+        waitid(P_ALL, 0, &info, WEXITED | WNOHANG | WNOWAIT);
+        auto control = reinterpret_cast<Control*>(m_shared);
+        NS_ABORT_MSG_IF(info.si_pid != 0 &&
+                            control->generation.load(std::memory_order_acquire) == generation,
+                        "Partition process " << info.si_pid << " exited during the run");
+    }
+
+    /**
+     * \brief Pass the collected strings to the parent; the other partitions exit.
+     */
+    void Join()
+    {
+        std::string collected = m_collect.IsNull() ? std::string() : m_collect();
+        NS_ABORT_MSG_IF(collected.size() > m_mailboxSize,
+                        "The results of a partition exceed the MailboxSize of "
+                            << m_mailboxSize << " bytes");
+        std::memcpy(GetMailbox(m_partition, m_window % 2), collected.data(), collected.size());
+        GetSlot(m_partition, m_window % 2).written = collected.size();
+        Wait();
+        if (m_partition != 0)
+        {
+            std::fflush(nullptr);
+            _exit(0);
+        }
+        m_collected.clear();
+        for (uint32_t p = 0; p < m_partitions; p++)
+        {
+            auto data = reinterpret_cast<const char*>(GetMailbox(p, m_window % 2));
+            m_collected.emplace_back(data, GetSlot(p, m_window % 2).written);
+        }
+        for (pid_t child : m_children)
+        {
+            int status;
+            NS_ABORT_MSG_IF(waitpid(child, &status, 0) != child || !WIFEXITED(status) ||
+                                WEXITSTATUS(status) != 0,
+                            "Partition process " << child << " failed");
+        }
+        m_children.clear();
+        m_running = false;
+        munmap(m_shared, m_sharedSize);
+        m_shared = nullptr;
+    }
+
+    Ptr<Scheduler> m_events;             //!< The event list
+    std::list<EventId> m_destroyEvents;  //!< Events run on Simulator::Destroy
+    bool m_stop;                         //!< Whether Stop was called
+    uint32_t m_uid;                      //!< Next event uid
+    uint32_t m_currentUid;               //!< Uid of the running event
+    uint64_t m_currentTs;                //!< Time of the running event
+    uint32_t m_currentContext;           //!< Context of the running event
+    int m_unscheduledEvents;             //!< Events in the event list
+    uint64_t m_eventCount;               //!< Events run, see GetEventCount
+    uint32_t m_partitions;               //!< Number of partitions
+    uint64_t m_mailboxSize;              //!< Mailbox bytes per partition and window
+    Time m_lookahead;                    //!< Smallest delay of a posted message
+    std::vector<uint32_t> m_partitionOf; //!< Partition of each node, by id
+    Callback<void, const uint8_t*, uint32_t> m_receive; //!< Schedules posted messages
+    Callback<std::string> m_collect;                    //!< Results of a partition
+    std::vector<std::string> m_collected;               //!< Results of all partitions
+    bool m_running{false};                              //!< Whether the partitions run
+    bool m_exchanging{false};                           //!< Whether messages are read
+    uint32_t m_partition{0};                            //!< Partition of this process
+    pid_t m_parent{0};                                  //!< Process of partition 0
+    std::vector<pid_t> m_children;                      //!< Processes of the others
+    uint8_t* m_shared{nullptr};                         //!< The shared memory
+    uint64_t m_sharedSize{0};                           //!< Its size
+    uint64_t m_window{0};                               //!< Windows run
+    uint64_t m_windowEnd{0};                            //!< End of the running window
+    uint64_t m_written{0};                              //!< Bytes posted in the window
+    uint64_t m_posted{kNever};                          //!< Earliest event posted
+    std::vector<uint64_t> m_sequence;                   //!< Messages posted, by node
+};
+
+NS_OBJECT_ENSURE_REGISTERED(SharedMemorySimulatorImpl);
+
+} // namespace ns3
+
+#endif /* SHARED_MEMORY_SIMULATOR_IMPL_H */
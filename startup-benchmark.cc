@@ -0,0 +1,277 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Measures the startup time of scratch programs: each program is launched
+// --runs times with NS3_STARTUP_PROBE set, and the median times from the
+// launch to main, to Simulator::Run, to the first event and to the exit of
+// the process are reported, in milliseconds.  Programs that do not use
+// startup-probe.h only report the time to exit.
+//
+// By default the other executables of the directory of this program (the
+// scratch build directory) that use startup-probe.h are measured; with
+// --all=1, every executable of the directory, and launching a program
+// without the probe runs it to completion.  Compare a default build with
+// one configured with --enable-static or -DNS3_SCRATCH_MINIMAL_LINK=ON:
+//
+// ./ns3 run "startup-benchmark --runs=50"
+// ./ns3 run "startup-benchmark --programs=build/scratch/ns3.40-scratch-simulator-default"
+//
+
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("StartupBenchmark");
+
+/**
+ * \return the CLOCK_MONOTONIC time, in nanoseconds.
+ */
+int64_t
+MonotonicNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * \param program An executable.
+ * \return true if it uses startup-probe.h, whose NS3_STARTUP_PROBE variable
+ * name is in its read-only data.
+ */
+bool
+IsProbed(const std::string& program)
+{
+    const std::string marker = "NS3_STARTUP_PROBE";
+    std::ifstream is(program, std::ios::binary);
+    std::string window;
+    char buffer[65536];
+    while (is.read(buffer, sizeof(buffer)) || is.gcount() > 0)
+    {
+        // keep the end of the previous block: the marker may straddle two
+        window.erase(0, window.size() > marker.size() ? window.size() - marker.size() : 0);
+        window.append(buffer, is.gcount());
+        if (window.find(marker) != std::string::npos)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * \param all Whether to include the programs not using startup-probe.h.
+ * \return the executables of the directory of this program, itself excluded.
+ */
+std::vector<std::string>
+FindPrograms(bool all)
+{
+    char self[4096];
+    ssize_t n = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    std::vector<std::string> programs;
+    if (n <= 0)
+    {
+        return programs;
+    }
+    self[n] = '\0';
+    std::string path(self);
+    std::string directory = path.substr(0, path.rfind('/'));
+    DIR* dir = opendir(directory.c_str());
+    while (dirent* entry = dir ? readdir(dir) : nullptr)
+    {
+        std::string candidate = directory + "/" + entry->d_name;
+        struct stat st;
+        if (entry->d_name[0] != '.' && candidate != path && stat(candidate.c_str(), &st) == 0 &&
+            S_ISREG(st.st_mode) && (st.st_mode & S_IXUSR) && (all || IsProbed(candidate)))
+        {
+            programs.push_back(candidate);
+        }
+    }
+    if (dir)
+    {
+        closedir(dir);
+    }
+    std::sort(programs.begin(), programs.end());
+    return programs;
+}
+
+/**
+ * \brief Launch a program once.
+ *
+ * \param program The program.
+ * \param args Its arguments.
+ * \param exitAtFirstEvent Whether the program exits at its first event.
+ * \return the time from the launch to each stage, in milliseconds.
+ */
+std::map<std::string, double>
+Launch(const std::string& program, const std::vector<std::string>& args, bool exitAtFirstEvent)
+{
+    std::map<std::string, double> stages;
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return stages;
+    }
+    int64_t start = MonotonicNs();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        dup2(fds[1], STDERR_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        setenv("NS3_STARTUP_PROBE", exitAtFirstEvent ? "exit" : "1", 1);
+        std::vector<char*> argv{const_cast<char*>(program.c_str())};
+        for (const auto& arg : args)
+        {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+        execv(program.c_str(), argv.data());
+        _exit(127);
+    }
+    close(fds[1]);
+    std::string output;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+    {
+        output.append(buffer, n);
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    stages["exit"] = (MonotonicNs() - start) / 1e6;
+
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        std::istringstream fields(line);
+        std::string tag;
+        std::string stage;
+        int64_t ns;
+        if (fields >> tag >> stage >> ns && tag == "startup-probe")
+        {
+            stages[stage] = (ns - start) / 1e6;
+        }
+    }
+    return stages;
+}
+
+/**
+ * \param values Some values.
+ * \return their median, or -1 if there are none.
+ */
+double
+Median(std::vector<double> values)
+{
+    if (values.empty())
+    {
+        return -1;
+    }
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string programs;
+    std::string args;
+    uint32_t runs = 20;
+    bool exitAtFirstEvent = true;
+    bool all = false;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("programs", "comma-separated programs (default: the scratch directory)", programs);
+    cmd.AddValue("args", "space-separated arguments passed to every program", args);
+    cmd.AddValue("runs", "launches per program", runs);
+    cmd.AddValue("exit", "stop the programs at their first event", exitAtFirstEvent);
+    cmd.AddValue("all", "measure every program of the directory, probed or not", all);
+    cmd.Parse(argc, argv);
+
+    std::vector<std::string> targets;
+    std::istringstream list(programs);
+    std::string token;
+    while (std::getline(list, token, ','))
+    {
+        targets.push_back(token);
+    }
+    if (targets.empty())
+    {
+        targets = FindPrograms(all);
+    }
+    std::vector<std::string> arguments;
+    std::istringstream argStream(args);
+    while (argStream >> token)
+    {
+        arguments.push_back(token);
+    }
+
+    const std::vector<std::string> stages{"main", "run", "first-event", "exit"};
+    std::cout << std::left << std::setw(48) << "program" << std::right;
+    for (const auto& stage : stages)
+    {
+        std::cout << std::setw(13) << stage;
+    }
+    std::cout << std::endl;
+    for (const auto& program : targets)
+    {
+        std::map<std::string, std::vector<double>> samples;
+        for (uint32_t i = 0; i < runs; i++)
+        {
+            for (const auto& [stage, ms] : Launch(program, arguments, exitAtFirstEvent))
+            {
+                samples[stage].push_back(ms);
+            }
+        }
+        std::cout << std::left << std::setw(48) << program.substr(program.rfind('/') + 1)
+                  << std::right << std::fixed << std::setprecision(2);
+        for (const auto& stage : stages)
+        {
+            double median = Median(samples[stage]);
+            if (median < 0)
+            {
+                std::cout << std::setw(13) << "-";
+            }
+            else
+            {
+                std::cout << std::setw(13) << median;
+            }
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
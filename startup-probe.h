@@ -0,0 +1,110 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef STARTUP_PROBE_H
+#define STARTUP_PROBE_H
+
+#include "ns3/simulator.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace ns3
+{
+
+/**
+ * Startup timestamps of a program, for startup-benchmark.
+ *
+ * When the environment variable NS3_STARTUP_PROBE is set, the probe prints
+ * to stderr the CLOCK_MONOTONIC time, in nanoseconds, of the stages of the
+ * program start:
+ *
+ *     startup-probe main <ns>         entry of main, after the shared
+ *                                     libraries were loaded and the static
+ *                                     TypeId registrations ran
+ *     startup-probe run <ns>          Simulator::Run, once the scenario is built
+ *     startup-probe first-event <ns>  first event at the start time, which
+ *                                     runs after the events already
+ *                                     scheduled for that time
+ *
+ * The clock is shared by all processes, so the launcher subtracts the time
+ * at which it started the program.  With NS3_STARTUP_PROBE=exit the program
+ * exits at its first event, to measure startup alone.
+ *
+ * Main () is called first thing in main, and BeforeRun () right before the
+ * first Simulator::Run; both do nothing when the variable is not set.
+ */
+class StartupProbe
+{
+  public:
+    /**
+     * \brief Record the entry of main.
+     */
+    static void Main()
+    {
+        if (std::getenv("NS3_STARTUP_PROBE"))
+        {
+            Print("main");
+        }
+    }
+
+    /**
+     * \brief Record the start of the simulation and watch for its first event.
+     */
+    static void BeforeRun()
+    {
+        static bool armed = false;
+        if (armed || !std::getenv("NS3_STARTUP_PROBE"))
+        {
+            return;
+        }
+        armed = true;
+        Print("run");
+        Simulator::ScheduleNow(&StartupProbe::FirstEvent);
+    }
+
+  private:
+    /**
+     * \param stage The stage reached.
+     */
+    static void Print(const char* stage)
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        std::fprintf(stderr,
+                     "startup-probe %s %lld\n",
+                     stage,
+                     static_cast<long long>(ts.tv_sec) * 1000000000LL + ts.tv_nsec);
+    }
+
+    /// Record the first event, and exit if only startup is measured
+    static void FirstEvent()
+    {
+        Print("first-event");
+        const char* mode = std::getenv("NS3_STARTUP_PROBE");
+        if (mode && std::strcmp(mode, "exit") == 0)
+        {
+            std::fflush(nullptr);
+            std::_Exit(0);
+        }
+    }
+};
+
+} // namespace ns3
+
+#endif /* STARTUP_PROBE_H */
@@ -0,0 +1,295 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef STEADY_STATE_DETECTOR_H
+#define STEADY_STATE_DETECTOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Online steady-state analysis of a periodically sampled output, such as
+ * the throughput of every sampling interval, to stop a run as soon as its
+ * mean is known precisely enough.
+ *
+ * Every 5 samples, the warm-up is estimated with MSER-5: the samples are
+ * grouped in batches of 5, and the truncation point is the number of
+ * leading batches whose removal minimizes the squared standard error of the
+ * remaining batch means (the last 5 batches, whose error is unreliable, are
+ * always kept).  While the minimum lies in the second half of the series,
+ * the output is still drifting and the warm-up is not considered over.
+ *
+ * The samples after the truncation point are then split into 20 batches of
+ * equal size (the oldest samples left over are ignored), and the confidence
+ * interval of the mean is the Student t interval of the batch means.  The
+ * run is done once the half-width is at most the target precision times
+ * the mean.  No decision is made before the minimum number of samples.
+ */
+class SteadyStateDetector
+{
+  public:
+    /**
+     * \brief Enable the detector.
+     *
+     * \param precision The target half-width relative to the mean, 0 to disable.
+     * \param confidence The confidence level of the interval.
+     * \param minSamples The minimum number of samples before stopping.
+     */
+    void Enable(double precision, double confidence = 0.95, uint32_t minSamples = 100)
+    {
+        m_precision = precision;
+        m_confidence = confidence;
+        m_minSamples = std::max<uint32_t>(minSamples, BATCH_SIZE * BATCHES);
+        Reset();
+    }
+
+    /**
+     * \return true if the detector is enabled.
+     */
+    bool IsEnabled() const
+    {
+        return m_precision > 0;
+    }
+
+    /**
+     * \brief Drop the samples, keeping the settings, for a new run.
+     */
+    void Reset()
+    {
+        m_samples.clear();
+        m_batchMeans.clear();
+        m_done = false;
+        m_truncation = 0;
+        m_mean = 0;
+        m_halfWidth = 0;
+    }
+
+    /**
+     * \param sample The next sample.
+     * \return true once the warm-up is over and the mean precise enough.
+     */
+    bool AddSample(double sample)
+    {
+        if (!IsEnabled() || m_done)
+        {
+            return m_done;
+        }
+        m_samples.push_back(sample);
+        if (m_samples.size() % BATCH_SIZE != 0)
+        {
+            return false;
+        }
+        double sum = 0;
+        for (std::size_t i = m_samples.size() - BATCH_SIZE; i < m_samples.size(); i++)
+        {
+            sum += m_samples[i];
+        }
+        m_batchMeans.push_back(sum / BATCH_SIZE);
+        if (m_samples.size() >= m_minSamples)
+        {
+            Analyze();
+        }
+        return m_done;
+    }
+
+    /**
+     * \return true once the warm-up is over and the mean precise enough.
+     */
+    bool IsDone() const
+    {
+        return m_done;
+    }
+
+    /**
+     * \return the number of samples so far.
+     */
+    uint32_t GetSampleCount() const
+    {
+        return m_samples.size();
+    }
+
+    /**
+     * \return the number of leading samples discarded as warm-up.
+     */
+    uint32_t GetTruncation() const
+    {
+        return m_truncation;
+    }
+
+    /**
+     * \return the steady-state mean.
+     */
+    double GetMean() const
+    {
+        return m_mean;
+    }
+
+    /**
+     * \return the half-width of the confidence interval of the mean.
+     */
+    double GetHalfWidth() const
+    {
+        return m_halfWidth;
+    }
+
+    /**
+     * \brief Print the last analysis.
+     *
+     * \param os The output stream.
+     * \param unit The unit of the samples.
+     */
+    void Print(std::ostream& os, const std::string& unit) const
+    {
+        os << (m_done ? "Steady state" : "No steady state") << " after " << m_samples.size()
+           << " samples: warm-up of " << m_truncation << " samples truncated, mean " << m_mean
+           << " +/- " << m_halfWidth << " " << unit << " (" << m_confidence * 100 << "%)"
+           << std::endl;
+    }
+
+  private:
+    static constexpr uint32_t BATCH_SIZE = 5; //!< Batch size of MSER-5
+    static constexpr uint32_t BATCHES = 20;   //!< Number of batches of the interval
+    static constexpr uint32_t MIN_TAIL = 5;   //!< Batches kept by the MSER search
+
+    /**
+     * \brief Estimate the warm-up and the confidence interval.
+     */
+    void Analyze()
+    {
+        // MSER of the series without its first d batches, from suffix sums
+        std::size_t b = m_batchMeans.size();
+        double sum = 0;
+        double squares = 0;
+        std::size_t best = 0;
+        double bestMser = INFINITY;
+        for (std::size_t d = b; d-- > 0;)
+        {
+            sum += m_batchMeans[d];
+            squares += m_batchMeans[d] * m_batchMeans[d];
+            if (b - d < MIN_TAIL)
+            {
+                continue;
+            }
+            double n = b - d;
+            double mser = (squares - sum * sum / n) / (n * n);
+            if (mser <= bestMser)
+            {
+                bestMser = mser;
+                best = d;
+            }
+        }
+        m_truncation = best * BATCH_SIZE;
+        if (best > b / 2)
+        {
+            return;
+        }
+
+        std::size_t batchSize = (m_samples.size() - m_truncation) / BATCHES;
+        std::size_t first = m_samples.size() - batchSize * BATCHES;
+        double total = 0;
+        double totalSquares = 0;
+        for (uint32_t k = 0; k < BATCHES; k++)
+        {
+            double batch = 0;
+            for (std::size_t i = 0; i < batchSize; i++)
+            {
+                batch += m_samples[first + k * batchSize + i];
+            }
+            batch /= batchSize;
+            total += batch;
+            totalSquares += batch * batch;
+        }
+        m_mean = total / BATCHES;
+        double variance = std::max(0.0, (totalSquares - total * m_mean) / (BATCHES - 1));
+        m_halfWidth =
+            StudentQuantile((1 + m_confidence) / 2, BATCHES - 1) * std::sqrt(variance / BATCHES);
+        m_done = m_halfWidth <= m_precision * std::abs(m_mean);
+    }
+
+    /**
+     * \param p A probability.
+     * \return the quantile of the standard normal distribution (Acklam).
+     */
+    static double NormalQuantile(double p)
+    {
+        static const double a[] = {-3.969683028665376e+01,
+                                   2.209460984245205e+02,
+                                   -2.759285104469687e+02,
+                                   1.383577518672690e+02,
+                                   -3.066479806614716e+01,
+                                   2.506628277459239e+00};
+        static const double b[] = {-5.447609879822406e+01,
+                                   1.615858368580409e+02,
+                                   -1.556989798598866e+02,
+                                   6.680131188771972e+01,
+                                   -1.328068155288572e+01};
+        static const double c[] = {-7.784894002430293e-03,
+                                   -3.223964580411365e-01,
+                                   -2.400758277161838e+00,
+                                   -2.549732539343734e+00,
+                                   4.374664141464968e+00,
+                                   2.938163982698783e+00};
+        static const double d[] = {7.784695709041462e-03,
+                                   3.224671290700398e-01,
+                                   2.445134137142996e+00,
+                                   3.754408661907416e+00};
+        if (p < 0.02425 || p > 1 - 0.02425)
+        {
+            double q = std::sqrt(-2 * std::log(p < 0.5 ? p : 1 - p));
+            double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                       ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+            return p < 0.5 ? x : -x;
+        }
+        double q = p - 0.5;
+        double r = q * q;
+        return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+               (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+    }
+
+    /**
+     * \param p A probability.
+     * \param dof The degrees of freedom.
+     * \return the quantile of the Student t distribution (Cornish-Fisher expansion).
+     */
+    static double StudentQuantile(double p, uint32_t dof)
+    {
+        double z = NormalQuantile(p);
+        double z2 = z * z;
+        double v = dof;
+        return z + z * (z2 + 1) / (4 * v) + z * ((5 * z2 + 16) * z2 + 3) / (96 * v * v) +
+               z * (((3 * z2 + 19) * z2 + 17) * z2 - 15) / (384 * v * v * v);
+    }
+
+    double m_precision{0};            //!< Target relative half-width, 0 if disabled
+    double m_confidence{0.95};        //!< Confidence level
+    uint32_t m_minSamples{100};       //!< Samples before the first decision
+    std::vector<double> m_samples;    //!< Samples so far
+    std::vector<double> m_batchMeans; //!< Means of the MSER-5 batches
+    bool m_done{false};               //!< Whether the run can stop
+    uint32_t m_truncation{0};         //!< Warm-up samples of the last analysis
+    double m_mean{0};                 //!< Steady-state mean of the last analysis
+    double m_halfWidth{0};            //!< Confidence half-width of the last analysis
+};
+
+} // namespace ns3
+
+#endif /* STEADY_STATE_DETECTOR_H */
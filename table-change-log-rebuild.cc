@@ -0,0 +1,58 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Rebuilds the full routing tables or neighbor caches at a given time from
+// a table change log (see table-change-log.h), e.g.:
+//
+// ./ns3 run "wifi-simple-adhoc-grid --tracing=1 --tableLog=1"
+// ./ns3 run "table-change-log-rebuild --input=wifi-simple-adhoc-grid.routes --time=10 --node=3"
+//
+
+#include "table-change-log.h"
+
+#include "ns3/command-line.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace ns3;
+
+int
+main(int argc, char* argv[])
+{
+    std::string input;
+    double time = 1e300;
+    int64_t node = -1;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "table change log to replay", input);
+    cmd.AddValue("time", "time of the tables (s), default the end of the log", time);
+    cmd.AddValue("node", "node to print, -1 for all", node);
+    cmd.Parse(argc, argv);
+
+    std::ifstream is(input);
+    if (!is.is_open())
+    {
+        std::cerr << "Cannot open " << input << std::endl;
+        return 1;
+    }
+    if (!TableChangeLog::Rebuild(is, std::cout, time, node))
+    {
+        std::cerr << input << ": invalid table change log" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,344 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TABLE_CHANGE_LOG_H
+#define TABLE_CHANGE_LOG_H
+
+#include "timer-wheel.h"
+
+#include "ns3/arp-cache.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/node-container.h"
+#include "ns3/olsr-routing-protocol.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Periodic dump of the routing tables or the neighbor (ARP) caches of a set
+ * of nodes, as the entries changed since the previous dump.
+ *
+ * Ipv4RoutingHelper::PrintRoutingTableAllEvery prints every table in full
+ * at every period, although once the routing has converged nothing changes.
+ * The change log keeps the previous snapshot of each node and writes one
+ * line per entry added (+), changed (~) or removed (-), after a line with
+ * the time of the snapshot (@), written only if something changed:
+ *
+ *     # table-change-log routes
+ *     @ 4
+ *     + 3 olsr 10.1.1.5/32 10.1.1.4 1 2
+ *     ~ 3 olsr 10.1.1.5/32 10.1.1.6 1 3
+ *     - 3 olsr 10.1.1.5/32
+ *
+ * The fields are the node id, the table, the entry key and the entry value:
+ *  - routes: table static or olsr (under an Ipv4ListRouting if any), key
+ *    destination/prefix length, value gateway, interface and metric (OLSR
+ *    distance); other routing protocols, a FibCache among them, are not
+ *    logged;
+ *  - neighbors: table arp<interface>, key IPv4 address, value as printed
+ *    by ArpCache::PrintArpCache (device, link-layer address and state).
+ *
+ * Rebuild () replays a log up to a given time and prints the full tables;
+ * see table-change-log-rebuild.cc.
+ */
+class TableChangeLog : public SimpleRefCount<TableChangeLog>
+{
+  public:
+    /// Tables logged
+    enum Table
+    {
+        ROUTES,    //!< Routing tables
+        NEIGHBORS, //!< ARP caches
+    };
+
+    /**
+     * \param table The tables to log.
+     * \param stream The log stream.
+     */
+    TableChangeLog(Table table, Ptr<OutputStreamWrapper> stream)
+        : m_table(table),
+          m_stream(stream)
+    {
+    }
+
+    /**
+     * \brief Log the tables of the nodes every period, from one period on.
+     *
+     * \param nodes The nodes.
+     * \param period The time between snapshots.
+     */
+    void Start(const NodeContainer& nodes, Time period)
+    {
+        m_nodes = nodes;
+        m_last.assign(nodes.GetN(), Entries());
+        *m_stream->GetStream() << "# table-change-log "
+                               << (m_table == ROUTES ? "routes" : "neighbors") << "\n";
+        m_timer.SetFunction(&TableChangeLog::Snapshot, this);
+        m_timer.SetPeriod(period);
+        m_timer.Start(period);
+    }
+
+    /**
+     * \brief Log the entries changed since the previous snapshot.
+     */
+    void Snapshot()
+    {
+        std::ostream& os = *m_stream->GetStream();
+        bool marked = false;
+        auto mark = [&]() -> std::ostream& {
+            if (!marked)
+            {
+                os << "@ " << Simulator::Now().GetSeconds() << "\n";
+                marked = true;
+            }
+            return os;
+        };
+        for (uint32_t i = 0; i < m_nodes.GetN(); i++)
+        {
+            uint32_t id = m_nodes.Get(i)->GetId();
+            Entries current = Collect(m_nodes.Get(i));
+            Entries& last = m_last[i];
+            // both maps are sorted: one merge pass finds every difference
+            auto before = last.begin();
+            auto now = current.begin();
+            while (before != last.end() || now != current.end())
+            {
+                if (now == current.end() || (before != last.end() && before->first < now->first))
+                {
+                    mark() << "- " << id << " " << before->first << "\n";
+                    ++before;
+                }
+                else if (before == last.end() || now->first < before->first)
+                {
+                    mark() << "+ " << id << " " << now->first << " " << now->second << "\n";
+                    ++now;
+                }
+                else
+                {
+                    if (before->second != now->second)
+                    {
+                        mark() << "~ " << id << " " << now->first << " " << now->second << "\n";
+                    }
+                    ++before;
+                    ++now;
+                }
+            }
+            last.swap(current);
+        }
+    }
+
+    /**
+     * \brief Replay a change log and print the tables it describes.
+     *
+     * \param is The change log.
+     * \param os The output stream.
+     * \param time The time of the tables, in seconds.
+     * \param node The node to print, negative for all.
+     * \return false if the log is invalid.
+     */
+    static bool Rebuild(std::istream& is, std::ostream& os, double time, int64_t node = -1)
+    {
+        std::string line;
+        if (!std::getline(is, line) || line.rfind("# table-change-log ", 0) != 0)
+        {
+            return false;
+        }
+        std::string kind = line.substr(19);
+        std::map<uint32_t, Entries> tables;
+        double snapshot = 0;
+        while (std::getline(is, line))
+        {
+            std::istringstream fields(line);
+            char op;
+            if (!(fields >> op))
+            {
+                continue;
+            }
+            if (op == '@')
+            {
+                double at;
+                if (!(fields >> at))
+                {
+                    return false;
+                }
+                if (at > time)
+                {
+                    break;
+                }
+                snapshot = at;
+                continue;
+            }
+            uint32_t id;
+            std::string table;
+            std::string key;
+            if (!(fields >> id >> table >> key))
+            {
+                return false;
+            }
+            std::string value;
+            std::getline(fields >> std::ws, value);
+            if (op == '+' || op == '~')
+            {
+                tables[id][table + " " + key] = value;
+            }
+            else if (op == '-')
+            {
+                tables[id].erase(table + " " + key);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        // the tables are unchanged from the last snapshot logged until the time
+        os << "# " << kind << " as of " << snapshot << "s" << std::endl;
+        for (const auto& [id, entries] : tables)
+        {
+            if (node >= 0 && id != node)
+            {
+                continue;
+            }
+            os << "Node " << id << std::endl;
+            for (const auto& [key, value] : entries)
+            {
+                os << "  " << key << " " << value << std::endl;
+            }
+        }
+        return true;
+    }
+
+  private:
+    /// Entries of a node: table and key, then value
+    using Entries = std::map<std::string, std::string>;
+
+    /**
+     * \param node A node.
+     * \return its current entries.
+     */
+    Entries Collect(Ptr<Node> node) const
+    {
+        Entries entries;
+        Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol>();
+        if (!ipv4)
+        {
+            return entries;
+        }
+        if (m_table == ROUTES)
+        {
+            CollectRoutes(ipv4->GetRoutingProtocol(), entries);
+            return entries;
+        }
+        for (uint32_t i = 0; i < ipv4->GetNInterfaces(); i++)
+        {
+            Ptr<ArpCache> arp = ipv4->GetInterface(i)->GetArpCache();
+            if (!arp)
+            {
+                continue;
+            }
+            std::ostringstream oss;
+            arp->PrintArpCache(Create<OutputStreamWrapper>(&oss));
+            std::istringstream lines(oss.str());
+            std::string address;
+            std::string value;
+            while (lines >> address && std::getline(lines >> std::ws, value))
+            {
+                Add(entries, "arp" + std::to_string(i) + " " + address, value);
+            }
+        }
+        return entries;
+    }
+
+    /**
+     * \param routing A routing protocol.
+     * \param entries The entries to add its routes to.
+     */
+    static void CollectRoutes(Ptr<Ipv4RoutingProtocol> routing, Entries& entries)
+    {
+        if (Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting>(routing))
+        {
+            for (uint32_t i = 0; i < list->GetNRoutingProtocols(); i++)
+            {
+                int16_t priority;
+                CollectRoutes(list->GetRoutingProtocol(i, priority), entries);
+            }
+        }
+        else if (Ptr<Ipv4StaticRouting> routes = DynamicCast<Ipv4StaticRouting>(routing))
+        {
+            for (uint32_t i = 0; i < routes->GetNRoutes(); i++)
+            {
+                Ipv4RoutingTableEntry route = routes->GetRoute(i);
+                std::ostringstream key;
+                std::ostringstream value;
+                key << "static " << route.GetDest() << "/"
+                    << static_cast<uint32_t>(route.GetDestNetworkMask().GetPrefixLength());
+                value << route.GetGateway() << " " << route.GetInterface() << " "
+                      << routes->GetMetric(i);
+                Add(entries, key.str(), value.str());
+            }
+        }
+        else if (Ptr<olsr::RoutingProtocol> olsr = DynamicCast<olsr::RoutingProtocol>(routing))
+        {
+            for (const auto& route : olsr->GetRoutingTableEntries())
+            {
+                std::ostringstream key;
+                std::ostringstream value;
+                key << "olsr " << route.destAddr << "/32";
+                value << route.nextAddr << " " << route.interface << " " << route.distance;
+                Add(entries, key.str(), value.str());
+            }
+        }
+    }
+
+    /**
+     * \brief Add an entry, numbering the keys seen more than once.
+     *
+     * \param entries The entries.
+     * \param key The table and key.
+     * \param value The value.
+     */
+    static void Add(Entries& entries, const std::string& key, const std::string& value)
+    {
+        std::string unique = key;
+        for (uint32_t n = 2; entries.count(unique) != 0; n++)
+        {
+            unique = key + "#" + std::to_string(n);
+        }
+        entries[unique] = value;
+    }
+
+    Table m_table;                     //!< Tables logged
+    Ptr<OutputStreamWrapper> m_stream; //!< Log stream
+    NodeContainer m_nodes;             //!< Nodes logged
+    std::vector<Entries> m_last;       //!< Previous snapshot, by node index
+    PeriodicTimer m_timer;             //!< Snapshot timer
+};
+
+} // namespace ns3
+
+#endif /* TABLE_CHANGE_LOG_H */
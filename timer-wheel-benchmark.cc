@@ -0,0 +1,186 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Compares re-arming periodic timers with Simulator::Schedule and keeping
+// them in the TimerWheel (timer-wheel.h), with the timer population of a
+// dense OLSR run: on every node a HELLO timer (2 s) and a TC timer (5 s),
+// each with a uniform jitter, as OLSR emission timers have.  In both modes a
+// timer expires at its start time plus a whole number of periods, plus a
+// fresh jitter: the jitter does not accumulate, so both modes run the same
+// number of expirations.
+//
+// ./ns3 run "timer-wheel-benchmark --numNodes=10000 --wheel=0"
+// ./ns3 run "timer-wheel-benchmark --numNodes=10000 --wheel=1"
+//
+
+#include "timer-wheel.h"
+
+#include "ns3/command-line.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("TimerWheelBenchmark");
+
+uint64_t g_expirations = 0; //!< Number of timer expirations
+
+/**
+ * The protocol timers of one node.
+ */
+class NodeTimers
+{
+  public:
+    /**
+     * \param jitter The jitter of every emission, in seconds.
+     */
+    NodeTimers(Ptr<RandomVariableStream> jitter)
+        : m_jitter(jitter)
+    {
+    }
+
+    /**
+     * \brief Start the timers, re-armed with Simulator::Schedule.
+     */
+    void StartScheduled()
+    {
+        m_helloNext = Seconds(m_jitter->GetValue());
+        Simulator::Schedule(m_helloNext, &NodeTimers::HelloScheduled, this);
+        m_tcNext = Seconds(m_jitter->GetValue());
+        Simulator::Schedule(m_tcNext, &NodeTimers::TcScheduled, this);
+    }
+
+    /**
+     * \brief Start the timers, kept in the timer wheel.
+     */
+    void StartWheel()
+    {
+        m_hello.SetFunction(&NodeTimers::Expire, this);
+        m_hello.SetPeriod(HELLO_INTERVAL);
+        m_hello.SetJitter(m_jitter);
+        m_hello.Start(Seconds(m_jitter->GetValue()));
+        m_tc.SetFunction(&NodeTimers::Expire, this);
+        m_tc.SetPeriod(TC_INTERVAL);
+        m_tc.SetJitter(m_jitter);
+        m_tc.Start(Seconds(m_jitter->GetValue()));
+    }
+
+  private:
+    /// HELLO timer expiration, re-armed in the main queue
+    void HelloScheduled()
+    {
+        Expire();
+        Simulator::Schedule(NextDelay(m_helloNext, HELLO_INTERVAL),
+                            &NodeTimers::HelloScheduled,
+                            this);
+    }
+
+    /// TC timer expiration, re-armed in the main queue
+    void TcScheduled()
+    {
+        Expire();
+        Simulator::Schedule(NextDelay(m_tcNext, TC_INTERVAL), &NodeTimers::TcScheduled, this);
+    }
+
+    /**
+     * \brief Advance a timer by one period, the jitter shifting the expiration
+     * without accumulating, as PeriodicTimer does.
+     *
+     * \param next The next expiration of the timer, without jitter; advanced.
+     * \param period The period of the timer.
+     * \return the delay to the next expiration, with jitter.
+     */
+    Time NextDelay(Time& next, Time period)
+    {
+        next += period;
+        Time due = std::max(Simulator::Now(), next + Seconds(m_jitter->GetValue()));
+        return due - Simulator::Now();
+    }
+
+    /// Timer expiration
+    void Expire()
+    {
+        g_expirations++;
+    }
+
+    static inline const Time HELLO_INTERVAL = Seconds(2); //!< HELLO emission interval
+    static inline const Time TC_INTERVAL = Seconds(5);    //!< TC emission interval
+
+    Ptr<RandomVariableStream> m_jitter; //!< Emission jitter
+    Time m_helloNext;                   //!< Next HELLO expiration without jitter, in schedule mode
+    Time m_tcNext;                      //!< Next TC expiration without jitter, in schedule mode
+    PeriodicTimer m_hello;              //!< HELLO timer, in wheel mode
+    PeriodicTimer m_tc;                 //!< TC timer, in wheel mode
+};
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t numNodes = 10000;
+    double simulationTime = 100; // seconds
+    bool wheel = true;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("numNodes", "number of nodes", numNodes);
+    cmd.AddValue("simulationTime", "simulation time in seconds", simulationTime);
+    cmd.AddValue("wheel", "keep the timers in the timer wheel", wheel);
+    cmd.Parse(argc, argv);
+
+    Ptr<UniformRandomVariable> jitter = CreateObject<UniformRandomVariable>();
+    jitter->SetAttribute("Min", DoubleValue(0));
+    jitter->SetAttribute("Max", DoubleValue(0.5));
+
+    std::vector<std::unique_ptr<NodeTimers>> nodes;
+    for (uint32_t i = 0; i < numNodes; i++)
+    {
+        nodes.push_back(std::make_unique<NodeTimers>(jitter));
+        if (wheel)
+        {
+            nodes.back()->StartWheel();
+        }
+        else
+        {
+            nodes.back()->StartScheduled();
+        }
+    }
+
+    Simulator::Stop(Seconds(simulationTime));
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Run();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << (wheel ? "Timer wheel" : "Simulator::Schedule") << ": " << g_expirations
+              << " expirations, " << Simulator::GetEventCount() << " events in " << wall
+              << " s" << std::endl;
+    if (wheel)
+    {
+        std::cout << "Pending in the wheel: " << TimerWheel::Get().GetPending()
+                  << ", main queue events scheduled by the wheel: "
+                  << TimerWheel::Get().GetScheduledEvents() << std::endl;
+    }
+
+    Simulator::Destroy();
+    return 0;
+}
@@ -0,0 +1,551 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Hierarchical timer wheel holding recurring timers outside the main event
+ * queue.
+ *
+ * A periodic timer scheduled with Simulator::Schedule keeps one event in the
+ * main queue at all times, so N nodes with a few protocol or sampling timers
+ * each keep the queue N times larger than the traffic needs, and every
+ * re-arm pays a queue insertion.  The wheel keeps these timers in buckets of
+ * one tick instead:
+ *
+ *  - level 0 has 256 buckets of one tick, for timers due in the next 256 ticks;
+ *  - level 1 has 64 buckets of 256 ticks, cascaded into level 0 when their
+ *    window starts;
+ *  - timers further away wait in an overflow list, checked every 256 ticks.
+ *
+ * Inserting a timer is O(1).  The wheel schedules a single main-queue event,
+ * at the next tick holding timers, which schedules each due timer at its
+ * exact time; timers therefore fire at the same times as with
+ * Simulator::Schedule, but only timers due within the current tick are in the
+ * main queue.  Timers expiring at the same time as other events may run in a
+ * different order relative to them.
+ *
+ * The wheel is emptied on Simulator::Destroy.
+ */
+class TimerWheel
+{
+  public:
+    /**
+     * \return the wheel of the simulation.
+     */
+    static TimerWheel& Get()
+    {
+        // never destroyed, so that timers with static storage can stop on exit
+        static TimerWheel* wheel = new TimerWheel;
+        return *wheel;
+    }
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * \brief Set the tick; only while no timer is pending.
+     *
+     * \param tick The bucket width.
+     */
+    void SetTick(Time tick)
+    {
+        NS_ABORT_MSG_IF(m_pending > 0, "Cannot change the tick of a running timer wheel");
+        NS_ABORT_MSG_UNLESS(tick.IsStrictlyPositive(), "The tick must be positive");
+        m_tick = tick.GetTimeStep();
+    }
+
+    /**
+     * \brief Arm a timer.
+     *
+     * \param due The absolute expiration time.
+     * \param callback The function called on expiration.
+     * \return the timer id, for Cancel ().
+     */
+    uint64_t Insert(Time due, Callback<void> callback)
+    {
+        uint32_t index;
+        if (m_free.empty())
+        {
+            index = m_timers.size();
+            m_timers.emplace_back();
+        }
+        else
+        {
+            index = m_free.back();
+            m_free.pop_back();
+        }
+        Entry& entry = m_timers[index];
+        entry.due = due.GetTimeStep();
+        entry.callback = callback;
+        entry.armed = true;
+        m_pending++;
+        if (m_destroyEvent.PeekEventImpl() == nullptr)
+        {
+            m_destroyEvent = Simulator::ScheduleDestroy(&TimerWheel::Clear, this);
+        }
+        Place(index);
+        return (uint64_t(entry.generation) << 32) | index;
+    }
+
+    /**
+     * \brief Disarm a timer; no effect if it already expired or was cancelled.
+     *
+     * \param id The timer id returned by Insert ().
+     */
+    void Cancel(uint64_t id)
+    {
+        uint32_t index = id & 0xffffffff;
+        if (index < m_timers.size() && m_timers[index].generation == (id >> 32) &&
+            m_timers[index].armed)
+        {
+            // the entry stays in its bucket and is skipped when reached
+            m_timers[index].armed = false;
+            m_timers[index].callback = Callback<void>();
+            m_pending--;
+        }
+    }
+
+    /**
+     * \return the number of armed timers.
+     */
+    uint64_t GetPending() const
+    {
+        return m_pending;
+    }
+
+    /**
+     * \return the number of events the wheel put in the main queue.
+     */
+    uint64_t GetScheduledEvents() const
+    {
+        return m_scheduled;
+    }
+
+  private:
+    static constexpr uint32_t L0_BITS = 8;            //!< log2 of the level 0 buckets
+    static constexpr uint32_t L0_SIZE = 1 << L0_BITS; //!< Level 0 buckets
+    static constexpr uint32_t L1_SIZE = 64;           //!< Level 1 buckets
+
+    /// A timer
+    struct Entry
+    {
+        int64_t due{0};          //!< Expiration time, in time steps
+        Callback<void> callback; //!< Expiration function
+        uint32_t generation{0};  //!< Reuse count of the slot
+        bool armed{false};       //!< Whether the timer is pending
+    };
+
+    TimerWheel() = default;
+
+    /**
+     * \param due A time, in time steps.
+     * \return the tick holding it.
+     */
+    int64_t TickOf(int64_t due) const
+    {
+        return due / m_tick;
+    }
+
+    /**
+     * Put an armed timer in the bucket of its tick, or in the main queue if
+     * its tick was already processed.
+     *
+     * \param index The timer.
+     */
+    void Place(uint32_t index)
+    {
+        int64_t tick = TickOf(m_timers[index].due);
+        // no bucket is occupied between the last processed tick and now
+        m_current = std::max(m_current, TickOf(Simulator::Now().GetTimeStep()));
+        if (tick <= m_current)
+        {
+            ScheduleExpiry(index);
+            return;
+        }
+        if (tick - m_current < L0_SIZE)
+        {
+            m_level0[tick & (L0_SIZE - 1)].push_back(index);
+            ScheduleAdvance(tick);
+        }
+        else if ((tick >> L0_BITS) - (m_current >> L0_BITS) < L1_SIZE)
+        {
+            m_level1[(tick >> L0_BITS) % L1_SIZE].push_back(index);
+            ScheduleAdvance(((m_current >> L0_BITS) + 1) << L0_BITS);
+        }
+        else
+        {
+            m_overflow.push_back(index);
+            ScheduleAdvance(((m_current >> L0_BITS) + 1) << L0_BITS);
+        }
+    }
+
+    /**
+     * Make sure the wheel runs at a tick.
+     *
+     * \param tick The tick.
+     */
+    void ScheduleAdvance(int64_t tick)
+    {
+        if (m_advanceEvent.IsRunning() && m_advanceTick <= tick)
+        {
+            return;
+        }
+        Simulator::Cancel(m_advanceEvent);
+        m_advanceTick = tick;
+        m_advanceEvent = Simulator::Schedule(TimeStep(tick * m_tick) - Simulator::Now(),
+                                             &TimerWheel::Advance,
+                                             this);
+        m_scheduled++;
+    }
+
+    /**
+     * Process the tick of the current time: cascade the upper levels if a
+     * level 0 window starts, schedule the due timers and find the next tick
+     * to process.
+     */
+    void Advance()
+    {
+        m_current = m_advanceTick;
+        if ((m_current & (L0_SIZE - 1)) == 0)
+        {
+            std::vector<uint32_t> cascade;
+            cascade.swap(m_level1[(m_current >> L0_BITS) % L1_SIZE]);
+            std::vector<uint32_t> overflow;
+            overflow.swap(m_overflow);
+            cascade.insert(cascade.end(), overflow.begin(), overflow.end());
+            for (uint32_t index : cascade)
+            {
+                if (m_timers[index].armed)
+                {
+                    Place(index);
+                }
+                else
+                {
+                    Release(index);
+                }
+            }
+        }
+
+        std::vector<uint32_t> due;
+        due.swap(m_level0[m_current & (L0_SIZE - 1)]);
+        for (uint32_t index : due)
+        {
+            if (m_timers[index].armed)
+            {
+                ScheduleExpiry(index);
+            }
+            else
+            {
+                Release(index);
+            }
+        }
+
+        // next occupied tick, stopping at the start of the next window if the
+        // upper levels have timers to cascade
+        bool upperLevels = !m_overflow.empty();
+        for (const auto& bucket : m_level1)
+        {
+            upperLevels = upperLevels || !bucket.empty();
+        }
+        int64_t windowEnd = ((m_current >> L0_BITS) + 1) << L0_BITS;
+        int64_t limit = upperLevels ? windowEnd : m_current + L0_SIZE;
+        for (int64_t tick = m_current + 1; tick < limit; tick++)
+        {
+            if (!m_level0[tick & (L0_SIZE - 1)].empty())
+            {
+                ScheduleAdvance(tick);
+                return;
+            }
+        }
+        if (upperLevels)
+        {
+            ScheduleAdvance(windowEnd);
+        }
+    }
+
+    /**
+     * Move a timer into the main queue at its exact expiration time.
+     *
+     * \param index The timer.
+     */
+    void ScheduleExpiry(uint32_t index)
+    {
+        Simulator::Schedule(TimeStep(m_timers[index].due) - Simulator::Now(),
+                            &TimerWheel::Expire,
+                            this,
+                            index,
+                            m_timers[index].generation);
+        m_scheduled++;
+    }
+
+    /**
+     * Run a timer, unless it was cancelled.
+     *
+     * \param index The timer.
+     * \param generation The generation of the slot when the timer was armed.
+     */
+    void Expire(uint32_t index, uint32_t generation)
+    {
+        Entry& entry = m_timers[index];
+        if (entry.generation != generation)
+        {
+            return;
+        }
+        Callback<void> callback = entry.callback;
+        bool armed = entry.armed;
+        if (armed)
+        {
+            m_pending--;
+        }
+        Release(index);
+        if (armed)
+        {
+            callback();
+        }
+    }
+
+    /**
+     * Return a slot to the free list.
+     *
+     * \param index The slot.
+     */
+    void Release(uint32_t index)
+    {
+        m_timers[index].armed = false;
+        m_timers[index].callback = Callback<void>();
+        m_timers[index].generation++;
+        m_free.push_back(index);
+    }
+
+    /**
+     * Drop every timer, on Simulator::Destroy; the slots are kept, with a new
+     * generation, so that ids of the previous run do not match new timers.
+     */
+    void Clear()
+    {
+        m_free.clear();
+        for (uint32_t index = 0; index < m_timers.size(); index++)
+        {
+            Release(index);
+        }
+        for (auto& bucket : m_level0)
+        {
+            bucket.clear();
+        }
+        for (auto& bucket : m_level1)
+        {
+            bucket.clear();
+        }
+        m_overflow.clear();
+        m_pending = 0;
+        // the next run starts again at time 0
+        m_current = 0;
+        m_advanceTick = 0;
+        m_advanceEvent = EventId();
+        m_destroyEvent = EventId();
+    }
+
+    int64_t m_tick{Time(MilliSeconds(1)).GetTimeStep()}; //!< Bucket width, in time steps
+    int64_t m_current{0};                                //!< Last processed tick
+    int64_t m_advanceTick{0};                            //!< Tick of the pending advance
+    std::vector<Entry> m_timers;                         //!< Timer slots
+    std::vector<uint32_t> m_free;                        //!< Free timer slots
+    std::vector<uint32_t> m_level0[L0_SIZE];             //!< Timers due in the next ticks
+    std::vector<uint32_t> m_level1[L1_SIZE];             //!< Timers due in the next windows
+    std::vector<uint32_t> m_overflow;                    //!< Timers due later
+    uint64_t m_pending{0};                               //!< Armed timers
+    uint64_t m_scheduled{0};                             //!< Main queue events scheduled
+    EventId m_advanceEvent;                              //!< Next wheel advance
+    EventId m_destroyEvent;                              //!< Clear on Simulator::Destroy
+};
+
+/**
+ * A recurring timer kept in the TimerWheel.
+ *
+ * Like Timer, the function is called every period from Start () until
+ * Stop () or destruction; an optional random variable adds jitter to each
+ * period, as protocol HELLO timers do.  Copies take the function, period and
+ * jitter of the original but are not running.
+ */
+class PeriodicTimer
+{
+  public:
+    PeriodicTimer() = default;
+
+    ~PeriodicTimer()
+    {
+        Stop();
+    }
+
+    /**
+     * \param other The timer to copy the configuration of.
+     */
+    PeriodicTimer(const PeriodicTimer& other)
+        : m_callback(other.m_callback),
+          m_period(other.m_period),
+          m_jitter(other.m_jitter)
+    {
+    }
+
+    /**
+     * \param other The timer to copy the configuration of.
+     * \return this timer, stopped.
+     */
+    PeriodicTimer& operator=(const PeriodicTimer& other)
+    {
+        if (this != &other)
+        {
+            Stop();
+            m_callback = other.m_callback;
+            m_period = other.m_period;
+            m_jitter = other.m_jitter;
+        }
+        return *this;
+    }
+
+    /**
+     * \param memPtr The member function called on expiration.
+     * \param object The object it is called on.
+     */
+    template <typename MEM_PTR,
+              typename OBJ_PTR,
+              std::enable_if_t<std::is_member_function_pointer_v<MEM_PTR>, int> = 0>
+    void SetFunction(MEM_PTR memPtr, OBJ_PTR object)
+    {
+        m_callback = MakeCallback(memPtr, object);
+    }
+
+    /**
+     * \param fn The function called on expiration.
+     */
+    void SetFunction(void (*fn)())
+    {
+        m_callback = MakeCallback(fn);
+    }
+
+    /**
+     * \param fn The function called on expiration.
+     * \param args The arguments it is called with.
+     */
+    template <typename... Ts, typename... Args>
+    void SetFunction(void (*fn)(Ts...), Args... args)
+    {
+        m_callback = MakeBoundCallback(fn, args...);
+    }
+
+    /**
+     * \param period The time between expirations.
+     */
+    void SetPeriod(Time period)
+    {
+        NS_ABORT_MSG_UNLESS(period.IsStrictlyPositive(), "The period must be positive");
+        m_period = period;
+    }
+
+    /**
+     * \param jitter A random variable, in seconds, added to each period.
+     */
+    void SetJitter(Ptr<RandomVariableStream> jitter)
+    {
+        m_jitter = jitter;
+    }
+
+    /**
+     * \brief Start the timer.
+     *
+     * \param delay The time to the first expiration.
+     */
+    void Start(Time delay)
+    {
+        Stop();
+        m_next = Simulator::Now() + delay;
+        Arm(m_next);
+    }
+
+    /**
+     * \brief Stop the timer.
+     */
+    void Stop()
+    {
+        if (m_running)
+        {
+            TimerWheel::Get().Cancel(m_id);
+            m_running = false;
+        }
+    }
+
+    /**
+     * \return true if the timer is running.
+     */
+    bool IsRunning() const
+    {
+        return m_running;
+    }
+
+  private:
+    /**
+     * Put the next expiration in the wheel.
+     *
+     * \param due The expiration time.
+     */
+    void Arm(Time due)
+    {
+        m_id = TimerWheel::Get().Insert(due, MakeCallback(&PeriodicTimer::Expire, this));
+        m_running = true;
+    }
+
+    /**
+     * Re-arm for the next period, then call the function.
+     */
+    void Expire()
+    {
+        // the jitter shifts each expiration, it does not accumulate
+        m_next += m_period;
+        Time due = m_next;
+        if (m_jitter)
+        {
+            due = std::max(Simulator::Now(), due + Seconds(m_jitter->GetValue()));
+        }
+        Arm(due);
+        m_callback();
+    }
+
+    Callback<void> m_callback;          //!< Function called on expiration
+    Time m_period{Seconds(1)};          //!< Time between expirations
+    Ptr<RandomVariableStream> m_jitter; //!< Jitter added to each period
+    Time m_next;                        //!< Next expiration, without jitter
+    uint64_t m_id{0};                   //!< Id of the armed wheel timer
+    bool m_running{false};              //!< Whether the timer is running
+};
+
+} // namespace ns3
+
+#endif /* TIMER_WHEEL_H */
@@ -0,0 +1,152 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRACE_BINDER_H
+#define TRACE_BINDER_H
+
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+
+#include <string>
+#include <type_traits>
+
+namespace ns3
+{
+
+/**
+ * Bind trace sinks directly to the objects of a container.
+ *
+ * Config::Connect resolves a path such as
+ * "/NodeList/ * /DeviceList/ * /$ns3::WifiNetDevice/Phy/PhyTxBegin" by walking
+ * every node, device and aggregated object, matching each path segment and
+ * looking the trace source up by name on every object it reaches.  The
+ * functions below look the trace source accessor up once per call, then walk
+ * the given container only, connecting each object in a single pass.
+ *
+ * Instead of a context string, the sink receives the id of the node owning
+ * the traced object as its first argument.  The signature typedef of the
+ * trace source is given as well, and the sink is checked against it at
+ * compile time, e.g. for PhyTxBegin:
+ *
+ * \code
+ *   void PhyTxBegin(uint32_t nodeId, Ptr<const Packet> packet, double txPowerW);
+ *   TraceBinder::ConnectWifiPhy<WifiPhy::PhyTxBeginTracedCallback>(devices,
+ *                                                                 "PhyTxBegin",
+ *                                                                 &PhyTxBegin);
+ * \endcode
+ *
+ * An unknown trace source, or an object refusing the connection, aborts
+ * instead of silently binding nothing.
+ */
+class TraceBinder
+{
+  public:
+    /**
+     * \brief Connect a sink to a trace source of the WifiPhy of every device.
+     *
+     * Devices that are not WifiNetDevices are skipped.
+     *
+     * \tparam Signature The signature typedef of the trace source, e.g.
+     *                   WifiPhy::PhyTxBeginTracedCallback.
+     * \param devices The devices.
+     * \param traceSource The name of a WifiPhy trace source.
+     * \param sink The sink, taking the node id followed by the trace source arguments.
+     * \return the number of PHYs connected.
+     */
+    template <typename Signature, typename... Args>
+    static uint32_t ConnectWifiPhy(const NetDeviceContainer& devices,
+                                   const std::string& traceSource,
+                                   void (*sink)(uint32_t, Args...))
+    {
+        static_assert(std::is_same_v<Signature, void (*)(Args...)>,
+                      "The sink does not match the signature of the trace source");
+        Ptr<const TraceSourceAccessor> accessor = Lookup(WifiPhy::GetTypeId(), traceSource);
+        uint32_t connected = 0;
+        for (auto it = devices.Begin(); it != devices.End(); ++it)
+        {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(*it);
+            if (!device)
+            {
+                continue;
+            }
+            uint32_t nodeId = device->GetNode()->GetId();
+            NS_ABORT_MSG_UNLESS(accessor->ConnectWithoutContext(PeekPointer(device->GetPhy()),
+                                                                MakeBoundCallback(sink, nodeId)),
+                                "Cannot connect to " << traceSource << " of node " << nodeId);
+            connected++;
+        }
+        return connected;
+    }
+
+    /**
+     * \brief Connect a sink to a trace source of an object aggregated to every node.
+     *
+     * Nodes without an object of type T are skipped.
+     *
+     * \tparam Signature The signature typedef of the trace source.
+     * \tparam T The aggregated object type, e.g. Ipv4L3Protocol.
+     * \param nodes The nodes.
+     * \param traceSource The name of a trace source of T.
+     * \param sink The sink, taking the node id followed by the trace source arguments.
+     * \return the number of objects connected.
+     */
+    template <typename Signature, typename T, typename... Args>
+    static uint32_t ConnectAggregated(const NodeContainer& nodes,
+                                      const std::string& traceSource,
+                                      void (*sink)(uint32_t, Args...))
+    {
+        static_assert(std::is_same_v<Signature, void (*)(Args...)>,
+                      "The sink does not match the signature of the trace source");
+        Ptr<const TraceSourceAccessor> accessor = Lookup(T::GetTypeId(), traceSource);
+        uint32_t connected = 0;
+        for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+        {
+            Ptr<T> object = (*it)->template GetObject<T>();
+            if (!object)
+            {
+                continue;
+            }
+            uint32_t nodeId = (*it)->GetId();
+            NS_ABORT_MSG_UNLESS(accessor->ConnectWithoutContext(PeekPointer(object),
+                                                                MakeBoundCallback(sink, nodeId)),
+                                "Cannot connect to " << traceSource << " of node " << nodeId);
+            connected++;
+        }
+        return connected;
+    }
+
+  private:
+    /**
+     * \param tid The type declaring the trace source.
+     * \param traceSource The trace source name.
+     * \return the accessor of the trace source.
+     */
+    static Ptr<const TraceSourceAccessor> Lookup(TypeId tid, const std::string& traceSource)
+    {
+        Ptr<const TraceSourceAccessor> accessor = tid.LookupTraceSourceByName(traceSource);
+        NS_ABORT_MSG_UNLESS(accessor,
+                            "No trace source " << traceSource << " in " << tid.GetName());
+        return accessor;
+    }
+};
+
+} // namespace ns3
+
+#endif /* TRACE_BINDER_H */
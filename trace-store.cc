@@ -0,0 +1,129 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Ingests a Wi-Fi ASCII trace into an indexed columnar store (see
+// trace-store.h) once, then queries the store, e.g.:
+//
+// ./ns3 run "wifi-simple-adhoc-grid --tracing=1 --sourceNode=24"
+// ./ns3 run "trace-store --ingest=wifi-simple-adhoc-grid.tr --store=grid.trs"
+//
+// A summary of the trace, then the events of node 12 in a time window:
+//
+// ./ns3 run "trace-store --store=grid.trs"
+// ./ns3 run "trace-store --store=grid.trs --query=events --node=12 --start=30 --stop=31"
+//
+// The hop-by-hop path (24->23->18->...->0) of every packet from node 24 to
+// node 0, then every event of one of them:
+//
+// ./ns3 run "trace-store --store=grid.trs --query=journey --src=10.1.1.25 --dst=10.1.1.1"
+// ./ns3 run "trace-store --store=grid.trs --query=journey --src=10.1.1.25 --dst=10.1.1.1 --id=2"
+//
+// The unicast data frames, retries and receptions of every link, and the
+// transmit airtime of every node, after OLSR has converged:
+//
+// ./ns3 run "trace-store --store=grid.trs --query=links --start=30"
+// ./ns3 run "trace-store --store=grid.trs --query=airtime --start=30"
+//
+
+#include "trace-store.h"
+
+#include "ns3/command-line.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace ns3;
+
+int
+main(int argc, char* argv[])
+{
+    std::string ingest;
+    std::string store;
+    std::string query = "summary";
+    std::string src;
+    std::string dst;
+    int64_t id = -1;
+    int64_t node = -1;
+    double start = 0;
+    double stop = 1e300;
+    uint32_t threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("ingest", "ASCII trace to ingest into the store", ingest);
+    cmd.AddValue("store", "trace store to write or query", store);
+    cmd.AddValue("query", "summary, events, journey, links or airtime", query);
+    cmd.AddValue("src", "journey: IPv4 source", src);
+    cmd.AddValue("dst", "journey: IPv4 destination", dst);
+    cmd.AddValue("id", "journey: IPv4 identification, -1 for every packet", id);
+    cmd.AddValue("node", "events, links, airtime: node, -1 for all", node);
+    cmd.AddValue("start", "events, links, airtime: start of the time window (s)", start);
+    cmd.AddValue("stop", "events, links, airtime: end of the time window (s)", stop);
+    cmd.AddValue("threads", "threads ingesting or scanning", threads);
+    cmd.Parse(argc, argv);
+
+    if (store.empty())
+    {
+        std::cerr << "--store is required" << std::endl;
+        return 1;
+    }
+    auto wallStart = std::chrono::steady_clock::now();
+    if (!ingest.empty())
+    {
+        uint64_t events = TraceStore::Ingest(ingest, store, threads);
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart)
+                          .count();
+        std::cout << "Ingested " << events << " events of " << ingest << " into " << store
+                  << " in " << wall << " s" << std::endl;
+        return 0;
+    }
+
+    TraceStore traces(store);
+    if (query == "summary")
+    {
+        traces.PrintSummary(std::cout);
+    }
+    else if (query == "events")
+    {
+        traces.PrintEvents(std::cout, start, stop, node);
+    }
+    else if (query == "journey")
+    {
+        if (src.empty() || dst.empty())
+        {
+            std::cerr << "--query=journey requires --src and --dst" << std::endl;
+            return 1;
+        }
+        traces.PrintJourney(std::cout, Ipv4Address(src.c_str()), Ipv4Address(dst.c_str()), id);
+    }
+    else if (query == "links")
+    {
+        traces.PrintLinks(std::cout, start, stop, node, threads);
+    }
+    else if (query == "airtime")
+    {
+        traces.PrintAirtime(std::cout, start, stop, node, threads);
+    }
+    else
+    {
+        std::cerr << "Unknown query " << query << std::endl;
+        return 1;
+    }
+    double wall =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    std::cerr << "Query answered in " << wall << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,1344 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRACE_STORE_H
+#define TRACE_STORE_H
+
+#include "ns3/abort.h"
+#include "ns3/ipv4-address.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Columnar store of the events of a Wi-Fi ASCII trace, for post-run queries.
+ *
+ * Questions such as the hop-by-hop path of a packet or the loss of a link
+ * are answered from a .tr file by grepping and parsing every line of it,
+ * again for every question.  Ingest () parses the trace once, in parallel
+ * over chunks of the mapped file, and writes one file holding:
+ *
+ *  - one column per field of the events, in time order: time, node, event
+ *    type and frame flags, MAC sequence number, mode (or drop reason),
+ *    receiver and transmitter addresses, IPv4 source, destination,
+ *    identification, protocol and TTL, and frame size;
+ *  - the modes and the MAC addresses seen, the latter with the node that
+ *    transmits from each (learned from the second address of the frames
+ *    sent);
+ *  - a node index: the rows of every node, in time order;
+ *  - a packet index: the rows carrying every IPv4 packet, sorted by source,
+ *    destination and identification, which stay the same at every hop.
+ *
+ * The ASCII trace does not print packet uids: a packet is identified by its
+ * IPv4 source, destination and identification instead, and frames without
+ * an IPv4 packet (control frames, ARP, management) are only reached by node
+ * and time.  A row is 41 bytes against about 300 for a trace line.
+ *
+ * A TraceStore maps the file read-only: opening it only reads the columns
+ * that index other sections, to check their values, and a query only
+ * touches the columns it uses.  Time windows are binary searches
+ * of the time column, journeys binary searches of the packet index; the
+ * link and airtime queries scan their time window in parallel, one
+ * accumulator per thread, merged at the end.
+ */
+class TraceStore
+{
+  public:
+    /// Event types
+    enum Event : uint8_t
+    {
+        TX = 0,      //!< Transmission
+        RX = 1,      //!< Successful reception
+        TX_DROP = 2, //!< Drop before transmission
+        RX_DROP = 3, //!< Drop on reception
+    };
+
+    /// Bits of the kind column
+    enum Kind : uint8_t
+    {
+        EVENT_MASK = 0x03, //!< Event type
+        DATA = 1 << 2,     //!< Data frame
+        CTL = 1 << 3,      //!< Control frame
+        MGT = 1 << 4,      //!< Management frame
+        RETRY = 1 << 5,    //!< Retry bit set
+        IPV4 = 1 << 6,     //!< Frame carrying an IPv4 packet
+    };
+
+    static constexpr uint32_t NONE = 0xffffffff; //!< No address, or no node
+
+    /// A MAC address of the trace
+    struct MacEntry
+    {
+        uint64_t address; //!< 48-bit address
+        uint32_t node;    //!< Node transmitting from it, NONE if unknown
+        uint32_t padding; //!< Zero
+    };
+
+    /// Packet index entry
+    struct PacketEntry
+    {
+        uint32_t source;      //!< IPv4 source
+        uint32_t destination; //!< IPv4 destination
+        uint16_t id;          //!< IPv4 identification
+        uint16_t padding;     //!< Zero
+        uint32_t row;         //!< Row of an event carrying the packet
+    };
+
+    /**
+     * \brief Map a store in memory.
+     *
+     * \param filename The store written by Ingest ().
+     */
+    explicit TraceStore(const std::string& filename)
+    {
+        int fd = open(filename.c_str(), O_RDONLY);
+        NS_ABORT_MSG_IF(fd < 0, "Cannot open trace store " << filename);
+        struct stat st;
+        NS_ABORT_MSG_IF(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(FileHeader),
+                        "Invalid trace store " << filename);
+        m_size = st.st_size;
+        m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        NS_ABORT_MSG_IF(m_data == MAP_FAILED, "Cannot map trace store " << filename);
+
+        m_header = static_cast<const FileHeader*>(m_data);
+        NS_ABORT_MSG_UNLESS(std::memcmp(m_header->magic, MAGIC, sizeof(MAGIC)) == 0,
+                            filename << " is not a trace store");
+        // the counts first, so that the section sizes cannot overflow
+        NS_ABORT_MSG_UNLESS(m_header->nRows <= m_size / sizeof(int64_t) &&
+                                m_header->nPackets <= m_size / sizeof(PacketEntry),
+                            "Truncated trace store " << filename);
+        std::vector<uint64_t> sizes = GetSectionSizes(*m_header);
+        for (uint32_t s = 0; s < SECTIONS; s++)
+        {
+            NS_ABORT_MSG_UNLESS(m_header->offsets[s] % 8 == 0 && m_header->offsets[s] <= m_size &&
+                                    sizes[s] <= m_size - m_header->offsets[s],
+                                "Truncated trace store " << filename);
+        }
+        m_time = Get<int64_t>(TIME);
+        m_node = Get<uint32_t>(NODE);
+        m_kind = Get<uint8_t>(KIND);
+        m_seq = Get<uint16_t>(SEQ);
+        m_detail = Get<uint16_t>(DETAIL);
+        m_addr1 = Get<uint32_t>(ADDR1);
+        m_addr2 = Get<uint32_t>(ADDR2);
+        m_ipSource = Get<uint32_t>(IP_SOURCE);
+        m_ipDestination = Get<uint32_t>(IP_DESTINATION);
+        m_ipId = Get<uint16_t>(IP_ID);
+        m_protocol = Get<uint8_t>(PROTOCOL);
+        m_ttl = Get<uint8_t>(TTL);
+        m_bytes = Get<uint32_t>(BYTES);
+        m_macs = Get<MacEntry>(MACS);
+        m_nodeOffsets = Get<uint64_t>(NODE_OFFSETS);
+        m_nodeRows = Get<uint32_t>(NODE_ROWS);
+        m_packets = Get<PacketEntry>(PACKETS);
+        CheckIndexes(filename);
+        const char* details = Get<char>(DETAILS);
+        for (uint32_t i = 0; i < m_header->nDetails; i++)
+        {
+            m_details.emplace_back(details + i * DETAIL_SIZE);
+            m_durations.push_back(GetFrameDuration(m_details.back()));
+        }
+    }
+
+    ~TraceStore()
+    {
+        munmap(m_data, m_size);
+    }
+
+    TraceStore(const TraceStore&) = delete;
+    TraceStore& operator=(const TraceStore&) = delete;
+
+    /**
+     * \brief Parse an ASCII trace and write it as a store.
+     *
+     * Lines other than t, r and d events with a WifiMacHeader are skipped.
+     *
+     * \param trace The ASCII trace, e.g. wifi-simple-adhoc-grid.tr.
+     * \param filename The store to write.
+     * \param threads The number of parsing threads.
+     * \return the number of events stored.
+     */
+    static uint64_t Ingest(const std::string& trace, const std::string& filename, uint32_t threads)
+    {
+        int fd = open(trace.c_str(), O_RDONLY);
+        NS_ABORT_MSG_IF(fd < 0, "Cannot open trace " << trace);
+        struct stat st;
+        NS_ABORT_MSG_IF(fstat(fd, &st) != 0 || st.st_size == 0, "Empty trace " << trace);
+        std::size_t size = st.st_size;
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        NS_ABORT_MSG_IF(mapped == MAP_FAILED, "Cannot map trace " << trace);
+        const char* data = static_cast<const char*>(mapped);
+        madvise(mapped, size, MADV_SEQUENTIAL);
+
+        // each thread parses the lines starting in its share of the file
+        threads = std::max<uint32_t>(threads, 1);
+        std::vector<Chunk> chunks(threads);
+        RunThreads(threads, [&](uint32_t t) {
+            std::size_t begin = GetLineStart(data, size, size * t / threads);
+            std::size_t end = GetLineStart(data, size, size * (t + 1) / threads);
+            Parse(data + begin, data + end, chunks[t]);
+        });
+
+        // merge the dictionaries of the chunks, and renumber their rows
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        std::unordered_map<std::string_view, uint16_t> detailIndex;
+        std::vector<std::string_view> details;
+        std::unordered_map<uint64_t, uint32_t> macIndex;
+        std::vector<MacEntry> macs;
+        std::vector<std::vector<uint16_t>> detailMaps(threads);
+        std::vector<std::vector<uint32_t>> macMaps(threads);
+        for (uint32_t t = 0; t < threads; t++)
+        {
+            for (std::string_view detail : chunks[t].details)
+            {
+                auto [it, added] = detailIndex.emplace(detail, details.size());
+                if (added)
+                {
+                    details.push_back(detail);
+                }
+                detailMaps[t].push_back(it->second);
+            }
+            for (uint64_t address : chunks[t].macs)
+            {
+                auto [it, added] = macIndex.emplace(address, macs.size());
+                if (added)
+                {
+                    macs.push_back({address, NONE, 0});
+                }
+                macMaps[t].push_back(it->second);
+            }
+            for (const auto& [address, node] : chunks[t].macNodes)
+            {
+                macs[macIndex[address]].node = node;
+            }
+            header.nRows += chunks[t].time.size();
+        }
+        NS_ABORT_MSG_IF(details.size() > UINT16_MAX, "Too many modes in trace " << trace);
+        NS_ABORT_MSG_IF(header.nRows >= NONE, "Too many events in trace " << trace);
+        RunThreads(threads, [&](uint32_t t) {
+            Chunk& chunk = chunks[t];
+            for (std::size_t i = 0; i < chunk.time.size(); i++)
+            {
+                chunk.detail[i] = detailMaps[t][chunk.detail[i]];
+                chunk.addr1[i] = chunk.addr1[i] == NONE ? NONE : macMaps[t][chunk.addr1[i]];
+                chunk.addr2[i] = chunk.addr2[i] == NONE ? NONE : macMaps[t][chunk.addr2[i]];
+            }
+        });
+
+        // the node and packet indexes
+        int64_t last = INT64_MIN;
+        uint32_t nNodes = 0;
+        for (const Chunk& chunk : chunks)
+        {
+            NS_ABORT_MSG_UNLESS(std::is_sorted(chunk.time.begin(), chunk.time.end()) &&
+                                    (chunk.time.empty() || chunk.time.front() >= last),
+                                trace << " is not in time order");
+            if (!chunk.time.empty())
+            {
+                last = chunk.time.back();
+            }
+            for (uint32_t node : chunk.node)
+            {
+                nNodes = std::max(nNodes, node + 1);
+            }
+        }
+        std::vector<uint64_t> nodeOffsets(nNodes + 1, 0);
+        std::vector<uint32_t> nodeRows(header.nRows);
+        std::vector<PacketEntry> packets;
+        for (const Chunk& chunk : chunks)
+        {
+            for (uint32_t node : chunk.node)
+            {
+                nodeOffsets[node + 1]++;
+            }
+        }
+        std::partial_sum(nodeOffsets.begin(), nodeOffsets.end(), nodeOffsets.begin());
+        std::vector<uint64_t> next(nodeOffsets.begin(), nodeOffsets.end() - 1);
+        uint32_t row = 0;
+        for (const Chunk& chunk : chunks)
+        {
+            for (std::size_t i = 0; i < chunk.time.size(); i++, row++)
+            {
+                nodeRows[next[chunk.node[i]]++] = row;
+                if (chunk.kind[i] & IPV4)
+                {
+                    packets.push_back(
+                        {chunk.ipSource[i], chunk.ipDestination[i], chunk.ipId[i], 0, row});
+                }
+            }
+        }
+        ParallelSort(packets, threads, [](const PacketEntry& a, const PacketEntry& b) {
+            return std::tie(a.source, a.destination, a.id, a.row) <
+                   std::tie(b.source, b.destination, b.id, b.row);
+        });
+
+        header.nNodes = nNodes;
+        header.nDetails = details.size();
+        header.nMacs = macs.size();
+        header.nPackets = packets.size();
+        std::vector<uint64_t> sizes = GetSectionSizes(header);
+        uint64_t offset = sizeof(FileHeader);
+        for (uint32_t s = 0; s < SECTIONS; s++)
+        {
+            header.offsets[s] = (offset + 7) / 8 * 8;
+            offset = header.offsets[s] + sizes[s];
+        }
+
+        std::ofstream os(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+        NS_ABORT_MSG_UNLESS(os.is_open(), "Cannot open trace store " << filename);
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        auto section = [&](Section s) {
+            while (static_cast<uint64_t>(os.tellp()) < header.offsets[s])
+            {
+                os.put(0);
+            }
+        };
+        section(TIME);
+        WriteColumn(os, chunks, &Chunk::time);
+        section(NODE);
+        WriteColumn(os, chunks, &Chunk::node);
+        section(KIND);
+        WriteColumn(os, chunks, &Chunk::kind);
+        section(SEQ);
+        WriteColumn(os, chunks, &Chunk::seq);
+        section(DETAIL);
+        WriteColumn(os, chunks, &Chunk::detail);
+        section(ADDR1);
+        WriteColumn(os, chunks, &Chunk::addr1);
+        section(ADDR2);
+        WriteColumn(os, chunks, &Chunk::addr2);
+        section(IP_SOURCE);
+        WriteColumn(os, chunks, &Chunk::ipSource);
+        section(IP_DESTINATION);
+        WriteColumn(os, chunks, &Chunk::ipDestination);
+        section(IP_ID);
+        WriteColumn(os, chunks, &Chunk::ipId);
+        section(PROTOCOL);
+        WriteColumn(os, chunks, &Chunk::protocol);
+        section(TTL);
+        WriteColumn(os, chunks, &Chunk::ttl);
+        section(BYTES);
+        WriteColumn(os, chunks, &Chunk::bytes);
+        section(DETAILS);
+        for (std::string_view detail : details)
+        {
+            char entry[DETAIL_SIZE] = {};
+            detail.copy(entry, DETAIL_SIZE - 1);
+            os.write(entry, DETAIL_SIZE);
+        }
+        section(MACS);
+        os.write(reinterpret_cast<const char*>(macs.data()), macs.size() * sizeof(MacEntry));
+        section(NODE_OFFSETS);
+        os.write(reinterpret_cast<const char*>(nodeOffsets.data()),
+                 nodeOffsets.size() * sizeof(uint64_t));
+        section(NODE_ROWS);
+        os.write(reinterpret_cast<const char*>(nodeRows.data()),
+                 nodeRows.size() * sizeof(uint32_t));
+        section(PACKETS);
+        os.write(reinterpret_cast<const char*>(packets.data()),
+                 packets.size() * sizeof(PacketEntry));
+        os.close();
+        NS_ABORT_MSG_IF(os.fail(), "Cannot write trace store " << filename);
+
+        munmap(mapped, size);
+        return header.nRows;
+    }
+
+    /**
+     * \brief Print the number of events, by type, the nodes, the time span
+     * and the modes of the trace.
+     *
+     * \param os The output stream.
+     */
+    void PrintSummary(std::ostream& os) const
+    {
+        uint64_t rows = m_header->nRows;
+        uint64_t events[4] = {0, 0, 0, 0};
+        for (uint64_t i = 0; i < rows; i++)
+        {
+            events[m_kind[i] & EVENT_MASK]++;
+        }
+        os << rows << " events (" << events[TX] << " tx, " << events[RX] << " rx, "
+           << events[TX_DROP] << " tx drops, " << events[RX_DROP] << " rx drops), "
+           << m_header->nNodes << " nodes, " << m_header->nPackets << " events of IPv4 packets"
+           << std::endl;
+        if (rows > 0)
+        {
+            os << "from " << m_time[0] / 1e9 << "s to " << m_time[rows - 1] / 1e9 << "s"
+               << std::endl;
+        }
+        os << "modes and drop reasons:";
+        for (const std::string& detail : m_details)
+        {
+            os << " " << (detail.empty() ? "-" : detail);
+        }
+        os << std::endl;
+    }
+
+    /**
+     * \brief Print the events of a node, or of all nodes, in a time window.
+     *
+     * \param os The output stream.
+     * \param start The start of the window (s).
+     * \param stop The end of the window (s).
+     * \param node The node, negative for all.
+     */
+    void PrintEvents(std::ostream& os, double start, double stop, int64_t node) const
+    {
+        auto [first, last] = GetRows(start, stop);
+        if (node < 0)
+        {
+            for (uint64_t i = first; i < last; i++)
+            {
+                PrintRow(os, i);
+            }
+            return;
+        }
+        auto [begin, end] = GetNodeRows(node, first, last);
+        for (const uint32_t* i = begin; i < end; i++)
+        {
+            PrintRow(os, *i);
+        }
+    }
+
+    /**
+     * \brief Print the events of an IPv4 packet, hop by hop, and its path.
+     *
+     * \param os The output stream.
+     * \param source The IPv4 source.
+     * \param destination The IPv4 destination.
+     * \param id The IPv4 identification, negative for a summary of every
+     *        packet from the source to the destination.
+     */
+    void PrintJourney(std::ostream& os, Ipv4Address source, Ipv4Address destination, int64_t id)
+        const
+    {
+        PacketEntry low{source.Get(), destination.Get(), 0, 0, 0};
+        PacketEntry high{source.Get(), destination.Get(), UINT16_MAX, 0, NONE};
+        if (id >= 0)
+        {
+            low.id = high.id = id;
+        }
+        auto less = [](const PacketEntry& a, const PacketEntry& b) {
+            return std::tie(a.source, a.destination, a.id, a.row) <
+                   std::tie(b.source, b.destination, b.id, b.row);
+        };
+        const PacketEntry* begin =
+            std::lower_bound(m_packets, m_packets + m_header->nPackets, low, less);
+        const PacketEntry* end =
+            std::upper_bound(begin, m_packets + m_header->nPackets, high, less);
+        if (begin == end)
+        {
+            os << "No events of packets from " << source << " to " << destination << std::endl;
+            return;
+        }
+        // the entries of an identification are consecutive, in row (time)
+        // order; once the identifications wrapped around, they are those of
+        // several packets: a packet ends before a first transmission (not a
+        // retry) at a TTL no lower than the lowest of the packet so far
+        for (const PacketEntry* packet = begin; packet < end;)
+        {
+            const PacketEntry* next = packet;
+            std::vector<uint32_t> path;
+            int64_t arrival = -1;
+            uint32_t lowest = UINT32_MAX;
+            bool sent = false;
+            for (; next < end && next->id == packet->id; next++)
+            {
+                uint32_t row = next->row;
+                uint8_t event = m_kind[row] & EVENT_MASK;
+                if (event == TX && (m_kind[row] & RETRY) == 0 && sent && m_ttl[row] >= lowest)
+                {
+                    break;
+                }
+                sent |= event == TX;
+                lowest = std::min<uint32_t>(lowest, m_ttl[row]);
+                if (id >= 0)
+                {
+                    PrintRow(os, row);
+                }
+                if (event == TX && path.empty())
+                {
+                    path.push_back(m_node[row]);
+                }
+                // a hop ends at the node the frame is addressed to
+                if (event == RX && GetMacNode(m_addr1[row]) == m_node[row] &&
+                    (path.empty() || path.back() != m_node[row]))
+                {
+                    path.push_back(m_node[row]);
+                    arrival = m_time[row];
+                }
+            }
+            os << (id >= 0 ? std::string("path") : "id " + std::to_string(packet->id) + ":");
+            for (std::size_t i = 0; i < path.size(); i++)
+            {
+                os << (i == 0 ? " " : " -> ") << path[i];
+            }
+            if (arrival >= 0)
+            {
+                os << ", " << path.size() - 1 << " hops, sent at " << m_time[packet->row] / 1e9
+                   << "s, last received at " << arrival / 1e9 << "s";
+            }
+            os << std::endl;
+            packet = next;
+        }
+    }
+
+    /**
+     * \brief Print the unicast data frames sent on each link in a time
+     * window, with their retries, receptions and drops at the receiver.
+     *
+     * \param os The output stream.
+     * \param start The start of the window (s).
+     * \param stop The end of the window (s).
+     * \param node The node whose links to print, negative for all.
+     * \param threads The number of scanning threads.
+     */
+    void PrintLinks(std::ostream& os, double start, double stop, int64_t node, uint32_t threads)
+        const
+    {
+        auto [first, last] = GetRows(start, stop);
+        std::vector<std::map<std::pair<uint32_t, uint32_t>, LinkStats>> results =
+            Scan<std::map<std::pair<uint32_t, uint32_t>, LinkStats>>(
+                threads,
+                last - first,
+                [&, first = first](auto& links, uint64_t i) {
+                    uint64_t row = first + i;
+                    if ((m_kind[row] & DATA) == 0)
+                    {
+                        return;
+                    }
+                    uint32_t receiver = GetMacNode(m_addr1[row]);
+                    if (receiver == NONE)
+                    {
+                        return;
+                    }
+                    switch (m_kind[row] & EVENT_MASK)
+                    {
+                    case TX: {
+                        LinkStats& link = links[{m_node[row], receiver}];
+                        link.frames++;
+                        link.retries += (m_kind[row] & RETRY) != 0;
+                        break;
+                    }
+                    case RX:
+                        if (receiver == m_node[row] && GetMacNode(m_addr2[row]) != NONE)
+                        {
+                            links[{GetMacNode(m_addr2[row]), receiver}].received++;
+                        }
+                        break;
+                    case RX_DROP:
+                        if (receiver == m_node[row] && GetMacNode(m_addr2[row]) != NONE)
+                        {
+                            links[{GetMacNode(m_addr2[row]), receiver}].dropped++;
+                        }
+                        break;
+                    }
+                });
+        std::map<std::pair<uint32_t, uint32_t>, LinkStats> links;
+        for (const auto& result : results)
+        {
+            for (const auto& [link, stats] : result)
+            {
+                links[link].frames += stats.frames;
+                links[link].retries += stats.retries;
+                links[link].received += stats.received;
+                links[link].dropped += stats.dropped;
+            }
+        }
+        os << "tx\trx\tframes\tretries\treceived\tdropped\tloss" << std::endl;
+        for (const auto& [link, stats] : links)
+        {
+            if (node >= 0 && link.first != node && link.second != node)
+            {
+                continue;
+            }
+            os << link.first << "\t" << link.second << "\t" << stats.frames << "\t"
+               << stats.retries << "\t" << stats.received << "\t" << stats.dropped << "\t"
+               << (stats.frames == 0 ? 0 : 1 - static_cast<double>(stats.received) / stats.frames)
+               << std::endl;
+        }
+    }
+
+    /**
+     * \brief Print the frames, bytes and transmit airtime of each node in a
+     * time window.
+     *
+     * \param os The output stream.
+     * \param start The start of the window (s).
+     * \param stop The end of the window (s).
+     * \param node The node to print, negative for all.
+     * \param threads The number of scanning threads.
+     */
+    void PrintAirtime(std::ostream& os, double start, double stop, int64_t node, uint32_t threads)
+        const
+    {
+        auto [first, last] = GetRows(start, stop);
+        const uint32_t* rows = nullptr;
+        uint64_t count = last - first;
+        if (node >= 0)
+        {
+            auto [begin, end] = GetNodeRows(node, first, last);
+            rows = begin;
+            count = end - begin;
+        }
+        std::vector<std::vector<AirtimeStats>> results = Scan<std::vector<AirtimeStats>>(
+            threads,
+            count,
+            [&, first = first](auto& nodes, uint64_t i) {
+                uint64_t row = rows ? rows[i] : first + i;
+                if ((m_kind[row] & EVENT_MASK) != TX)
+                {
+                    return;
+                }
+                nodes.resize(m_header->nNodes);
+                AirtimeStats& stats = nodes[m_node[row]];
+                stats.frames++;
+                stats.bytes += m_bytes[row];
+                stats.airtime += m_durations[m_detail[row]](m_bytes[row]);
+            });
+        std::vector<AirtimeStats> nodes(m_header->nNodes);
+        for (const auto& result : results)
+        {
+            for (std::size_t n = 0; n < result.size(); n++)
+            {
+                nodes[n].frames += result[n].frames;
+                nodes[n].bytes += result[n].bytes;
+                nodes[n].airtime += result[n].airtime;
+            }
+        }
+        double span = 0;
+        if (last > first)
+        {
+            span = (m_time[last - 1] - m_time[first]) / 1e9;
+        }
+        os << "node\tframes\tbytes\tairtime\tshare" << std::endl;
+        for (uint32_t n = 0; n < nodes.size(); n++)
+        {
+            if ((node >= 0 && n != node) || nodes[n].frames == 0)
+            {
+                continue;
+            }
+            os << n << "\t" << nodes[n].frames << "\t" << nodes[n].bytes << "\t"
+               << nodes[n].airtime << "\t" << (span > 0 ? nodes[n].airtime / span : 0)
+               << std::endl;
+        }
+    }
+
+  private:
+    /// Sections of the file
+    enum Section
+    {
+        TIME,           //!< Event time (ns), int64_t per row
+        NODE,           //!< Node id, uint32_t per row
+        KIND,           //!< Event type and frame flags, uint8_t per row
+        SEQ,            //!< MAC sequence number, uint16_t per row
+        DETAIL,         //!< Mode or drop reason, uint16_t per row
+        ADDR1,          //!< Receiver address (MAC entry), uint32_t per row
+        ADDR2,          //!< Transmitter address (MAC entry), uint32_t per row
+        IP_SOURCE,      //!< IPv4 source, uint32_t per row
+        IP_DESTINATION, //!< IPv4 destination, uint32_t per row
+        IP_ID,          //!< IPv4 identification, uint16_t per row
+        PROTOCOL,       //!< IPv4 protocol, uint8_t per row
+        TTL,            //!< IPv4 TTL, uint8_t per row
+        BYTES,          //!< Frame size with FCS, uint32_t per row
+        DETAILS,        //!< Modes and drop reasons, DETAIL_SIZE characters each
+        MACS,           //!< MAC entries
+        NODE_OFFSETS,   //!< First index in NODE_ROWS of every node, and the total
+        NODE_ROWS,      //!< Rows of every node, uint32_t each
+        PACKETS,        //!< Packet index entries
+        SECTIONS,       //!< Number of sections
+    };
+
+    /// File header
+    struct FileHeader
+    {
+        char magic[8];              //!< "NS3TRSTO"
+        uint32_t nNodes;            //!< Number of nodes (largest id + 1)
+        uint32_t nDetails;          //!< Number of modes and drop reasons
+        uint64_t nRows;             //!< Number of events
+        uint32_t nMacs;             //!< Number of MAC addresses
+        uint32_t padding;           //!< Zero
+        uint64_t nPackets;          //!< Number of packet index entries
+        uint64_t offsets[SECTIONS]; //!< File offset of every section
+    };
+
+    /// Columns and dictionaries of the lines parsed by one thread
+    struct Chunk
+    {
+        std::vector<int64_t> time;                                  //!< Times (ns)
+        std::vector<uint32_t> node;                                 //!< Nodes
+        std::vector<uint8_t> kind;                                  //!< Kinds
+        std::vector<uint16_t> seq;                                  //!< Sequence numbers
+        std::vector<uint16_t> detail;                               //!< Details, local index
+        std::vector<uint32_t> addr1;                                //!< Receivers, local index
+        std::vector<uint32_t> addr2;                                //!< Transmitters, local index
+        std::vector<uint32_t> ipSource;                             //!< IPv4 sources
+        std::vector<uint32_t> ipDestination;                        //!< IPv4 destinations
+        std::vector<uint16_t> ipId;                                 //!< IPv4 identifications
+        std::vector<uint8_t> protocol;                              //!< IPv4 protocols
+        std::vector<uint8_t> ttl;                                   //!< IPv4 TTLs
+        std::vector<uint32_t> bytes;                                //!< Frame sizes
+        std::vector<std::string_view> details;                      //!< Details seen
+        std::unordered_map<std::string_view, uint16_t> detailIndex; //!< Index of each detail
+        std::vector<uint64_t> macs;                                 //!< Addresses seen
+        std::unordered_map<uint64_t, uint32_t> macIndex;            //!< Index of each address
+        std::unordered_map<uint64_t, uint32_t> macNodes;            //!< Node of each transmitter
+    };
+
+    /// Unicast data frames of a link
+    struct LinkStats
+    {
+        uint64_t frames{0};   //!< Frames sent
+        uint64_t retries{0};  //!< Frames sent with the retry bit
+        uint64_t received{0}; //!< Frames received by the receiver
+        uint64_t dropped{0};  //!< Frames dropped by the receiver
+    };
+
+    /// Transmissions of a node
+    struct AirtimeStats
+    {
+        uint64_t frames{0}; //!< Frames sent
+        uint64_t bytes{0};  //!< Bytes sent
+        double airtime{0};  //!< Time on the air (s)
+    };
+
+    static constexpr char MAGIC[8] = {'N', 'S', '3', 'T', 'R', 'S', 'T', 'O'}; //!< File magic
+    /// Characters of a mode or drop reason, with the terminating null
+    static constexpr std::size_t DETAIL_SIZE = 48;
+
+    /**
+     * \param header A file header.
+     * \return the size of every section.
+     */
+    static std::vector<uint64_t> GetSectionSizes(const FileHeader& header)
+    {
+        uint64_t rows = header.nRows;
+        return {rows * 8,
+                rows * 4,
+                rows,
+                rows * 2,
+                rows * 2,
+                rows * 4,
+                rows * 4,
+                rows * 4,
+                rows * 4,
+                rows * 2,
+                rows,
+                rows,
+                rows * 4,
+                header.nDetails * DETAIL_SIZE,
+                header.nMacs * sizeof(MacEntry),
+                (header.nNodes + uint64_t{1}) * 8,
+                rows * 4,
+                header.nPackets * sizeof(PacketEntry)};
+    }
+
+    /**
+     * \param section A section.
+     * \return its start in the mapped file.
+     */
+    template <class T>
+    const T* Get(Section section) const
+    {
+        return reinterpret_cast<const T*>(static_cast<const char*>(m_data) +
+                                          m_header->offsets[section]);
+    }
+
+    /**
+     * \brief Abort unless every row, node and packet index entry refers to
+     * an entry of the store: the queries use them without bounds checks.
+     *
+     * \param filename The store, for the messages.
+     */
+    void CheckIndexes(const std::string& filename) const
+    {
+        const FileHeader& header = *m_header;
+        for (uint64_t i = 0; i < header.nRows; i++)
+        {
+            NS_ABORT_MSG_UNLESS(m_node[i] < header.nNodes && m_detail[i] < header.nDetails &&
+                                    (m_addr1[i] == NONE || m_addr1[i] < header.nMacs) &&
+                                    (m_addr2[i] == NONE || m_addr2[i] < header.nMacs) &&
+                                    m_nodeRows[i] < header.nRows,
+                                "Corrupt row " << i << " in trace store " << filename);
+        }
+        NS_ABORT_MSG_UNLESS(m_nodeOffsets[0] == 0 && m_nodeOffsets[header.nNodes] == header.nRows,
+                            "Corrupt node index in trace store " << filename);
+        for (uint32_t n = 0; n < header.nNodes; n++)
+        {
+            NS_ABORT_MSG_UNLESS(m_nodeOffsets[n] <= m_nodeOffsets[n + 1],
+                                "Corrupt node index in trace store " << filename);
+        }
+        for (uint64_t i = 0; i < header.nPackets; i++)
+        {
+            NS_ABORT_MSG_UNLESS(m_packets[i].row < header.nRows,
+                                "Corrupt packet index in trace store " << filename);
+        }
+    }
+
+    /**
+     * \param os The output stream.
+     * \param chunks The chunks, in file order.
+     * \param column The column to write.
+     */
+    template <class T>
+    static void WriteColumn(std::ostream& os,
+                            const std::vector<Chunk>& chunks,
+                            std::vector<T> Chunk::*column)
+    {
+        for (const Chunk& chunk : chunks)
+        {
+            const std::vector<T>& values = chunk.*column;
+            os.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        }
+    }
+
+    /**
+     * \param threads The number of threads.
+     * \param work The work of a thread, called with its index.
+     */
+    static void RunThreads(uint32_t threads, const std::function<void(uint32_t)>& work)
+    {
+        std::vector<std::thread> workers;
+        for (uint32_t t = 0; t < threads; t++)
+        {
+            workers.emplace_back(work, t);
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    /**
+     * \brief Sort in parallel: sort one slice per thread, then merge pairs
+     * of sorted slices until one is left.
+     *
+     * \param values The values.
+     * \param threads The number of threads.
+     * \param less The order.
+     */
+    template <class T, class Less>
+    static void ParallelSort(std::vector<T>& values, uint32_t threads, Less less)
+    {
+        std::vector<std::size_t> bounds;
+        for (uint32_t t = 0; t <= threads; t++)
+        {
+            bounds.push_back(values.size() * t / threads);
+        }
+        RunThreads(threads, [&](uint32_t t) {
+            std::sort(values.begin() + bounds[t], values.begin() + bounds[t + 1], less);
+        });
+        for (uint32_t width = 1; width < threads; width *= 2)
+        {
+            RunThreads((threads + 2 * width - 1) / (2 * width), [&](uint32_t m) {
+                uint32_t t = m * 2 * width;
+                if (t + width < threads)
+                {
+                    std::inplace_merge(values.begin() + bounds[t],
+                                       values.begin() + bounds[t + width],
+                                       values.begin() + bounds[std::min(t + 2 * width, threads)],
+                                       less);
+                }
+            });
+        }
+    }
+
+    /**
+     * \brief Visit rows in parallel, each thread with its own result.
+     *
+     * \param threads The number of threads.
+     * \param count The number of rows.
+     * \param visit The visit of a row, called with the result of the thread
+     *        and the index of the row, from 0 to count.
+     * \return the results of the threads.
+     */
+    template <class Result, class Visit>
+    static std::vector<Result> Scan(uint32_t threads, uint64_t count, Visit visit)
+    {
+        threads = std::max<uint64_t>(std::min<uint64_t>(threads, count), 1);
+        std::vector<Result> results(threads);
+        RunThreads(threads, [&](uint32_t t) {
+            for (uint64_t i = count * t / threads; i < count * (t + 1) / threads; i++)
+            {
+                visit(results[t], i);
+            }
+        });
+        return results;
+    }
+
+    /**
+     * \param data The trace.
+     * \param size Its size.
+     * \param offset An offset in the trace.
+     * \return the offset of the first line starting at or after it.
+     */
+    static std::size_t GetLineStart(const char* data, std::size_t size, std::size_t offset)
+    {
+        if (offset == 0 || offset >= size)
+        {
+            return std::min(offset, size);
+        }
+        auto eol =
+            static_cast<const char*>(std::memchr(data + offset - 1, '\n', size - offset + 1));
+        return eol ? eol - data + 1 : size;
+    }
+
+    /**
+     * \param begin The first line.
+     * \param end The end of the last line.
+     * \param chunk The chunk to add the events to.
+     */
+    static void Parse(const char* begin, const char* end, Chunk& chunk)
+    {
+        while (begin < end)
+        {
+            auto eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+            eol = eol ? eol : end;
+            ParseLine(std::string_view(begin, eol - begin), chunk);
+            begin = eol + 1;
+        }
+    }
+
+    /**
+     * \brief Add the event of a trace line, in the format of WifiPhyHelper:
+     *
+     *     t <time> <context> <mode> <frame>
+     *     r <time> <context> <mode> <frame>
+     *     d <time> <context> [<drop reason>] <frame>
+     *
+     * \param line The line.
+     * \param chunk The chunk to add the event to.
+     */
+    static void ParseLine(std::string_view line, Chunk& chunk)
+    {
+        constexpr auto npos = std::string_view::npos;
+        if (line.size() < 4 || line[1] != ' ' ||
+            (line[0] != 't' && line[0] != 'r' && line[0] != 'd'))
+        {
+            return;
+        }
+        std::size_t contextAt = line.find(' ', 2);
+        if (contextAt == npos)
+        {
+            return;
+        }
+        std::size_t nodeAt = line.find("/NodeList/", contextAt);
+        std::size_t detailAt = line.find(' ', contextAt + 1);
+        std::size_t frameAt = line.find("ns3::WifiMacHeader (", detailAt);
+        if (nodeAt == npos || nodeAt > detailAt || frameAt == npos)
+        {
+            return;
+        }
+        std::string_view context = line.substr(contextAt + 1, detailAt - contextAt - 1);
+        uint8_t kind = line[0] == 't'   ? TX
+                       : line[0] == 'r' ? RX
+                       : context.find("TxDrop") != npos ? TX_DROP
+                                                        : RX_DROP;
+        std::string_view detail = line.substr(detailAt + 1, frameAt - detailAt - 1);
+        while (!detail.empty() && detail.back() == ' ')
+        {
+            detail.remove_suffix(1);
+        }
+
+        // the MAC header: type, frame control, addresses and sequence number
+        std::size_t headerAt = frameAt + 20;
+        std::size_t headerEnd = line.find(')', headerAt);
+        std::string_view header = line.substr(headerAt, headerEnd - headerAt);
+        std::string_view type = header.substr(0, header.find(' '));
+        uint32_t bytes = 4; // FCS
+        if (type.substr(0, 4) == "CTL_")
+        {
+            kind |= CTL;
+            bytes += type == "CTL_ACK" || type == "CTL_CTS" ? 10 : 16;
+        }
+        else if (type.substr(0, 4) == "MGT_")
+        {
+            kind |= MGT;
+            bytes += 24;
+        }
+        else
+        {
+            kind |= DATA;
+            bytes += type.substr(0, 3) == "QOS" ? 26 : 24;
+        }
+        if (header.find("Retry=1") != npos)
+        {
+            kind |= RETRY;
+        }
+        uint32_t addresses[2] = {NONE, NONE};
+        uint32_t found = 0;
+        for (std::size_t eq = header.find('='); eq != npos && found < 2;
+             eq = header.find('=', eq + 1))
+        {
+            uint64_t address;
+            if (ParseMac(header.substr(eq + 1), address))
+            {
+                auto [it, added] = chunk.macIndex.emplace(address, chunk.macs.size());
+                if (added)
+                {
+                    chunk.macs.push_back(address);
+                }
+                addresses[found++] = it->second;
+            }
+        }
+        // the second address of a frame sent is the address of the sender
+        if ((kind & EVENT_MASK) == TX && addresses[1] != NONE)
+        {
+            chunk.macNodes[chunk.macs[addresses[1]]] = ParseUnsigned(line.substr(nodeAt + 10));
+        }
+
+        // the IPv4 header, or the size of what the frame carries
+        uint32_t source = 0;
+        uint32_t destination = 0;
+        uint32_t id = 0;
+        uint32_t protocol = 0;
+        uint32_t ttl = 0;
+        std::size_t ipAt = line.find("ns3::Ipv4Header (", headerEnd);
+        std::size_t lengthAt = line.find("length: ", ipAt);
+        if (ipAt != npos && lengthAt != npos)
+        {
+            kind |= IPV4;
+            std::string_view ip = line.substr(ipAt, lengthAt - ipAt);
+            ttl = GetField(ip, " ttl ");
+            id = GetField(ip, " id ");
+            protocol = GetField(ip, " protocol ");
+            uint32_t length = ParseUnsigned(line.substr(lengthAt + 8));
+            std::size_t sourceAt = line.find(' ', lengthAt + 8) + 1;
+            std::size_t arrowAt = line.find(" > ", sourceAt);
+            source = ParseIpv4(line.substr(sourceAt));
+            destination = arrowAt == npos ? 0 : ParseIpv4(line.substr(arrowAt + 3));
+            bytes += 8 + length; // LLC/SNAP header and IPv4 packet
+        }
+        else if (line.find("ns3::ArpHeader", headerEnd) != npos)
+        {
+            bytes += 8 + 28;
+        }
+        else
+        {
+            for (std::size_t at = line.find("size=", headerEnd); at != npos;
+                 at = line.find("size=", at + 5))
+            {
+                bytes += ParseUnsigned(line.substr(at + 5));
+            }
+        }
+
+        auto [it, added] = chunk.detailIndex.emplace(detail, chunk.details.size());
+        if (added)
+        {
+            chunk.details.push_back(detail);
+        }
+        chunk.time.push_back(std::llround(std::strtod(line.data() + 2, nullptr) * 1e9));
+        chunk.node.push_back(ParseUnsigned(line.substr(nodeAt + 10)));
+        chunk.kind.push_back(kind);
+        chunk.seq.push_back(GetField(header, "SeqNumber="));
+        chunk.detail.push_back(it->second);
+        chunk.addr1.push_back(addresses[0]);
+        chunk.addr2.push_back(addresses[1]);
+        chunk.ipSource.push_back(source);
+        chunk.ipDestination.push_back(destination);
+        chunk.ipId.push_back(id);
+        chunk.protocol.push_back(protocol);
+        chunk.ttl.push_back(ttl);
+        chunk.bytes.push_back(bytes);
+    }
+
+    /**
+     * \param text A text starting with a decimal number.
+     * \return the number, 0 if none.
+     */
+    static uint32_t ParseUnsigned(std::string_view text)
+    {
+        uint32_t value = 0;
+        for (std::size_t i = 0; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++)
+        {
+            value = value * 10 + (text[i] - '0');
+        }
+        return value;
+    }
+
+    /**
+     * \param text A text.
+     * \param key A key.
+     * \return the number after the first occurrence of the key, 0 if none.
+     */
+    static uint32_t GetField(std::string_view text, std::string_view key)
+    {
+        std::size_t at = text.find(key);
+        return at == std::string_view::npos ? 0 : ParseUnsigned(text.substr(at + key.size()));
+    }
+
+    /**
+     * \param text A text starting with a dotted IPv4 address.
+     * \return the address.
+     */
+    static uint32_t ParseIpv4(std::string_view text)
+    {
+        uint32_t address = 0;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            address = (address << 8) | ParseUnsigned(text);
+            std::size_t dot = text.find('.');
+            text = text.substr(dot == std::string_view::npos ? text.size() : dot + 1);
+        }
+        return address;
+    }
+
+    /**
+     * \param text A text.
+     * \param address The 48-bit MAC address it starts with, if any.
+     * \return true if the text starts with a MAC address (xx:xx:xx:xx:xx:xx).
+     */
+    static bool ParseMac(std::string_view text, uint64_t& address)
+    {
+        if (text.size() < 17)
+        {
+            return false;
+        }
+        address = 0;
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            int high = GetHexDigit(text[3 * i]);
+            int low = GetHexDigit(text[3 * i + 1]);
+            if (high < 0 || low < 0 || (i < 5 && text[3 * i + 2] != ':'))
+            {
+                return false;
+            }
+            address = (address << 8) | (high << 4) | low;
+        }
+        return true;
+    }
+
+    /**
+     * \param c A character.
+     * \return its value as a hexadecimal digit, -1 if it is not one.
+     */
+    static int GetHexDigit(char c)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f')
+        {
+            return c - 'a' + 10;
+        }
+        return c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+    }
+
+    /**
+     * \brief Get the duration of the frames of a mode.
+     *
+     * The durations are nominal: long preamble for DSSS, 20 MHz and one
+     * spatial stream for VHT and HE, 800 ns guard interval; the trace does not
+     * record the channel width.  Unknown modes (and drop reasons) take no
+     * time.
+     *
+     * \param mode A mode name, e.g. DsssRate1Mbps, OfdmRate54Mbps or HtMcs7.
+     * \return the duration (s) of a frame of the mode, given its size.
+     */
+    static std::function<double(uint32_t)> GetFrameDuration(const std::string& mode)
+    {
+        auto ofdm = [](double preamble, double symbol, double mbps) {
+            return [=](uint32_t bytes) {
+                // service (16) and tail (6) bits, whole symbols
+                return preamble + symbol * std::ceil((22 + 8.0 * bytes) / (mbps * symbol * 1e6));
+            };
+        };
+        auto rateAfter = [&](std::string_view prefix) {
+            std::string rate = mode.substr(mode.find(prefix) + prefix.size());
+            std::replace(rate.begin(), rate.end(), '_', '.');
+            return std::strtod(rate.c_str(), nullptr);
+        };
+        if (mode.rfind("DsssRate", 0) == 0)
+        {
+            double mbps = rateAfter("DsssRate");
+            return [=](uint32_t bytes) { return 192e-6 + 8.0 * bytes / (mbps * 1e6); };
+        }
+        if (mode.find("OfdmRate") != std::string::npos)
+        {
+            double scale = mode.find("BW10MHz") != std::string::npos  ? 2
+                           : mode.find("BW5MHz") != std::string::npos ? 4
+                                                                      : 1;
+            return ofdm(20e-6 * scale, 4e-6 * scale, rateAfter("OfdmRate"));
+        }
+        static const double ht[] = {6.5, 13, 19.5, 26, 39, 52, 58.5, 65, 78, 86.7};
+        static const double he[] =
+            {8.6, 17.2, 25.8, 34.4, 51.6, 68.8, 77.4, 86, 103.2, 114.7, 129, 143.4};
+        if (mode.rfind("HtMcs", 0) == 0)
+        {
+            auto mcs = static_cast<uint32_t>(rateAfter("HtMcs"));
+            uint32_t streams = mcs / 8 + 1;
+            return ofdm((32 + 4 * streams) * 1e-6, 4e-6, ht[mcs % 8] * streams);
+        }
+        if (mode.rfind("VhtMcs", 0) == 0)
+        {
+            return ofdm(36e-6, 4e-6, ht[std::min<uint32_t>(rateAfter("VhtMcs"), 9)]);
+        }
+        if (mode.rfind("HeMcs", 0) == 0)
+        {
+            return ofdm(48e-6, 13.6e-6, he[std::min<uint32_t>(rateAfter("HeMcs"), 11)]);
+        }
+        return [](uint32_t) { return 0.0; };
+    }
+
+    /**
+     * \param start The start of a time window (s).
+     * \param stop The end of the window (s).
+     * \return the first row in the window, and one past the last.
+     */
+    std::pair<uint64_t, uint64_t> GetRows(double start, double stop) const
+    {
+        const int64_t* end = m_time + m_header->nRows;
+        const int64_t* first = std::lower_bound(m_time, end, std::llround(start * 1e9));
+        const int64_t* last =
+            stop >= INT64_MAX / 1e9 ? end : std::lower_bound(first, end, std::llround(stop * 1e9));
+        return {first - m_time, last - m_time};
+    }
+
+    /**
+     * \param node A node.
+     * \param first The first row.
+     * \param last One past the last row.
+     * \return the node index entries of the node between the rows.
+     */
+    std::pair<const uint32_t*, const uint32_t*> GetNodeRows(uint64_t node,
+                                                            uint64_t first,
+                                                            uint64_t last) const
+    {
+        if (node >= m_header->nNodes)
+        {
+            return {m_nodeRows, m_nodeRows};
+        }
+        const uint32_t* begin = m_nodeRows + m_nodeOffsets[node];
+        const uint32_t* end = m_nodeRows + m_nodeOffsets[node + 1];
+        begin = std::lower_bound(begin, end, first);
+        return {begin, std::lower_bound(begin, end, last)};
+    }
+
+    /**
+     * \param mac A MAC entry, or NONE.
+     * \return the node transmitting from the address, NONE if unknown.
+     */
+    uint32_t GetMacNode(uint32_t mac) const
+    {
+        return mac == NONE ? NONE : m_macs[mac].node;
+    }
+
+    /**
+     * \param os The output stream.
+     * \param row The row to print.
+     */
+    void PrintRow(std::ostream& os, uint64_t row) const
+    {
+        static const char* events[] = {"tx", "rx", "txdrop", "rxdrop"};
+        uint8_t kind = m_kind[row];
+        os << m_time[row] / 1e9 << " " << events[kind & EVENT_MASK] << " node " << m_node[row]
+           << " " << m_details[m_detail[row]] << " "
+           << (kind & DATA ? "data" : kind & CTL ? "ctl" : "mgt") << " seq " << m_seq[row];
+        // addresses as the node transmitting from them, if known
+        auto address = [&](const char* label, uint32_t mac) {
+            os << label;
+            if (mac == NONE)
+            {
+                os << "-";
+            }
+            else if (m_macs[mac].node != NONE)
+            {
+                os << m_macs[mac].node;
+            }
+            else
+            {
+                char text[18];
+                uint64_t a = m_macs[mac].address;
+                std::snprintf(text,
+                              sizeof(text),
+                              "%02x:%02x:%02x:%02x:%02x:%02x",
+                              static_cast<uint32_t>(a >> 40) & 0xff,
+                              static_cast<uint32_t>(a >> 32) & 0xff,
+                              static_cast<uint32_t>(a >> 24) & 0xff,
+                              static_cast<uint32_t>(a >> 16) & 0xff,
+                              static_cast<uint32_t>(a >> 8) & 0xff,
+                              static_cast<uint32_t>(a) & 0xff);
+                os << text;
+            }
+        };
+        address(" from ", m_addr2[row]);
+        address(" to ", m_addr1[row]);
+        if (kind & RETRY)
+        {
+            os << " retry";
+        }
+        if (kind & IPV4)
+        {
+            os << " " << Ipv4Address(m_ipSource[row]) << " > " << Ipv4Address(m_ipDestination[row])
+               << " id " << m_ipId[row] << " protocol " << static_cast<uint32_t>(m_protocol[row])
+               << " ttl " << static_cast<uint32_t>(m_ttl[row]);
+        }
+        os << std::endl;
+    }
+
+    void* m_data;                                             //!< Mapped file
+    std::size_t m_size;                                       //!< Mapped size
+    const FileHeader* m_header;                               //!< File header
+    const int64_t* m_time;                                    //!< Time column (ns)
+    const uint32_t* m_node;                                   //!< Node column
+    const uint8_t* m_kind;                                    //!< Kind column
+    const uint16_t* m_seq;                                    //!< Sequence number column
+    const uint16_t* m_detail;                                 //!< Mode or drop reason column
+    const uint32_t* m_addr1;                                  //!< Receiver column
+    const uint32_t* m_addr2;                                  //!< Transmitter column
+    const uint32_t* m_ipSource;                               //!< IPv4 source column
+    const uint32_t* m_ipDestination;                          //!< IPv4 destination column
+    const uint16_t* m_ipId;                                   //!< IPv4 identification column
+    const uint8_t* m_protocol;                                //!< IPv4 protocol column
+    const uint8_t* m_ttl;                                     //!< IPv4 TTL column
+    const uint32_t* m_bytes;                                  //!< Frame size column
+    const MacEntry* m_macs;                                   //!< MAC addresses
+    const uint64_t* m_nodeOffsets;                            //!< Node index offsets
+    const uint32_t* m_nodeRows;                               //!< Node index rows
+    const PacketEntry* m_packets;                             //!< Packet index
+    std::vector<std::string> m_details;                       //!< Modes and drop reasons
+    std::vector<std::function<double(uint32_t)>> m_durations; //!< Frame duration of each mode
+};
+
+} // namespace ns3
+
+#endif /* TRACE_STORE_H */
@@ -0,0 +1,408 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRAFFIC_TRACE_H
+#define TRAFFIC_TRACE_H
+
+#include "burst-sender.h"
+
+#include "ns3/abort.h"
+#include "ns3/application.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/node-container.h"
+#include "ns3/on-off-application.h"
+#include "ns3/packet.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Binary trace of the packets emitted by the applications of a run.
+ *
+ * File layout: a TrafficTrace::FileHeader, then one NodeSlice per node
+ * (offset and number of records of that node), then the records, sorted by
+ * node and, within a node, by time.
+ */
+class TrafficTrace : public SimpleRefCount<TrafficTrace>
+{
+  public:
+    /// One packet handed to a socket by an application.
+    struct Record
+    {
+        int64_t time;         //!< Send time, in ns
+        uint32_t node;        //!< Sending node id
+        uint32_t destination; //!< Destination IPv4 address
+        uint32_t size;        //!< Payload size in bytes
+        uint16_t port;        //!< Destination port
+        uint16_t reserved;    //!< Padding, zero
+    };
+
+    /// File header
+    struct FileHeader
+    {
+        char magic[8];     //!< "NS3TRAFF"
+        uint32_t nNodes;   //!< Number of node slices
+        uint32_t padding;  //!< Zero
+        uint64_t nRecords; //!< Total number of records
+    };
+
+    /// Records of one node
+    struct NodeSlice
+    {
+        uint64_t offset; //!< Index of the first record
+        uint64_t count;  //!< Number of records
+    };
+
+    /**
+     * \brief Map a trace file in memory.
+     *
+     * \param filename The trace file.
+     */
+    explicit TrafficTrace(const std::string& filename)
+    {
+        int fd = open(filename.c_str(), O_RDONLY);
+        NS_ABORT_MSG_IF(fd < 0, "Cannot open traffic trace " << filename);
+        struct stat st;
+        NS_ABORT_MSG_IF(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(FileHeader),
+                        "Invalid traffic trace " << filename);
+        m_size = st.st_size;
+        m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        NS_ABORT_MSG_IF(m_data == MAP_FAILED, "Cannot map traffic trace " << filename);
+
+        auto header = static_cast<const FileHeader*>(m_data);
+        NS_ABORT_MSG_UNLESS(std::memcmp(header->magic, MAGIC, sizeof(header->magic)) == 0,
+                            filename << " is not a traffic trace");
+        // sizes checked by division: a corrupt count must not wrap the products
+        std::size_t left = m_size - sizeof(FileHeader);
+        NS_ABORT_MSG_UNLESS(header->nNodes <= left / sizeof(NodeSlice),
+                            "Truncated traffic trace " << filename);
+        left -= header->nNodes * sizeof(NodeSlice);
+        NS_ABORT_MSG_UNLESS(header->nRecords <= left / sizeof(Record),
+                            "Truncated traffic trace " << filename);
+        m_nNodes = header->nNodes;
+        m_slices = reinterpret_cast<const NodeSlice*>(header + 1);
+        m_records = reinterpret_cast<const Record*>(m_slices + m_nNodes);
+        for (uint32_t node = 0; node < m_nNodes; node++)
+        {
+            const NodeSlice& slice = m_slices[node];
+            NS_ABORT_MSG_UNLESS(slice.offset <= header->nRecords &&
+                                    slice.count <= header->nRecords - slice.offset,
+                                "Slice of node " << node << " out of the records of traffic trace "
+                                                 << filename);
+        }
+    }
+
+    ~TrafficTrace()
+    {
+        munmap(m_data, m_size);
+    }
+
+    TrafficTrace(const TrafficTrace&) = delete;
+    TrafficTrace& operator=(const TrafficTrace&) = delete;
+
+    /**
+     * \return the number of nodes in the trace.
+     */
+    uint32_t GetNNodes() const
+    {
+        return m_nNodes;
+    }
+
+    /**
+     * \param node The node id.
+     * \return the first record of the node.
+     */
+    const Record* Begin(uint32_t node) const
+    {
+        return node < m_nNodes ? m_records + m_slices[node].offset : m_records;
+    }
+
+    /**
+     * \param node The node id.
+     * \return one past the last record of the node.
+     */
+    const Record* End(uint32_t node) const
+    {
+        return node < m_nNodes ? Begin(node) + m_slices[node].count : m_records;
+    }
+
+    /**
+     * \brief Write records to a trace file.
+     *
+     * \param filename The trace file.
+     * \param records The records, in any order; they are sorted in place.
+     * \param nNodes The number of nodes of the run.
+     */
+    static void Write(const std::string& filename, std::vector<Record>& records, uint32_t nNodes)
+    {
+        std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+            return a.node < b.node || (a.node == b.node && a.time < b.time);
+        });
+        std::vector<NodeSlice> slices(nNodes, NodeSlice{0, 0});
+        for (uint64_t i = 0; i < records.size(); i++)
+        {
+            NS_ABORT_MSG_UNLESS(records[i].node < nNodes,
+                                "Record of node " << records[i].node << " in a trace of " << nNodes
+                                                  << " nodes");
+            NodeSlice& slice = slices[records[i].node];
+            if (slice.count++ == 0)
+            {
+                slice.offset = i;
+            }
+        }
+        FileHeader header;
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.nNodes = nNodes;
+        header.padding = 0;
+        header.nRecords = records.size();
+
+        std::ofstream os(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+        NS_ABORT_MSG_UNLESS(os.is_open(), "Cannot open traffic trace " << filename);
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        os.write(reinterpret_cast<const char*>(slices.data()), slices.size() * sizeof(NodeSlice));
+        os.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+    }
+
+  private:
+    static constexpr char MAGIC[8] = {'N', 'S', '3', 'T', 'R', 'A', 'F', 'F'}; //!< File magic
+
+    void* m_data;              //!< Mapped file
+    std::size_t m_size;        //!< Mapped size
+    uint32_t m_nNodes;         //!< Number of node slices
+    const NodeSlice* m_slices; //!< Node slices
+    const Record* m_records;   //!< Records
+};
+
+/**
+ * Record the packets sent by the OnOffApplications and BurstSenders of a run.
+ */
+class TrafficRecorder
+{
+  public:
+    /**
+     * \brief Start recording the OnOffApplications and BurstSenders installed
+     * on the nodes.
+     *
+     * \param nodes The nodes.
+     */
+    void Connect(const NodeContainer& nodes)
+    {
+        for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+        {
+            m_nNodes = std::max(m_nNodes, (*it)->GetId() + 1);
+            for (uint32_t i = 0; i < (*it)->GetNApplications(); i++)
+            {
+                Ptr<Application> app = (*it)->GetApplication(i);
+                if (DynamicCast<OnOffApplication>(app) || DynamicCast<BurstSender>(app))
+                {
+                    NS_ABORT_MSG_UNLESS(app->TraceConnectWithoutContext(
+                                            "TxWithAddresses",
+                                            MakeBoundCallback(&TrafficRecorder::Tx,
+                                                              this,
+                                                              (*it)->GetId())),
+                                        "Cannot connect to TxWithAddresses of node "
+                                            << (*it)->GetId());
+                }
+            }
+        }
+    }
+
+    /**
+     * \brief Write the recorded packets.
+     *
+     * \param filename The trace file.
+     */
+    void Write(const std::string& filename)
+    {
+        TrafficTrace::Write(filename, m_records, m_nNodes);
+    }
+
+  private:
+    /**
+     * Record one packet.
+     *
+     * \param recorder The recorder.
+     * \param node The sending node id.
+     * \param packet The packet.
+     * \param from The local address.
+     * \param to The destination address.
+     */
+    static void Tx(TrafficRecorder* recorder,
+                   uint32_t node,
+                   Ptr<const Packet> packet,
+                   const Address& from,
+                   const Address& to)
+    {
+        if (!InetSocketAddress::IsMatchingType(to))
+        {
+            return;
+        }
+        InetSocketAddress destination = InetSocketAddress::ConvertFrom(to);
+        recorder->m_records.push_back(TrafficTrace::Record{Simulator::Now().GetNanoSeconds(),
+                                                           node,
+                                                           destination.GetIpv4().Get(),
+                                                           packet->GetSize(),
+                                                           destination.GetPort(),
+                                                           0});
+    }
+
+    std::vector<TrafficTrace::Record> m_records; //!< Recorded packets
+    uint32_t m_nNodes{0};                        //!< Highest node id + 1
+};
+
+/**
+ * Send the packets of a node listed in a TrafficTrace, at their recorded times.
+ *
+ * The application walks its node's slice of the mapped trace with a single
+ * cursor, so no random variables or on/off state are involved.
+ */
+class TrafficReplayApplication : public Application
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::TrafficReplayApplication")
+                                .SetParent<Application>()
+                                .AddConstructor<TrafficReplayApplication>();
+        return tid;
+    }
+
+    /**
+     * \param trace The trace to replay.
+     */
+    void SetTrace(Ptr<TrafficTrace> trace)
+    {
+        m_trace = trace;
+    }
+
+    /**
+     * \brief Install a replay application on every node that sends in the trace.
+     *
+     * \param nodes The nodes.
+     * \param trace The trace to replay.
+     * \return the number of applications installed.
+     */
+    static uint32_t Install(const NodeContainer& nodes, Ptr<TrafficTrace> trace)
+    {
+        uint32_t installed = 0;
+        for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+        {
+            uint32_t id = (*it)->GetId();
+            if (trace->Begin(id) == trace->End(id))
+            {
+                continue;
+            }
+            Ptr<TrafficReplayApplication> app = CreateObject<TrafficReplayApplication>();
+            app->SetTrace(trace);
+            (*it)->AddApplication(app);
+            installed++;
+        }
+        return installed;
+    }
+
+  private:
+    void DoDispose() override
+    {
+        m_socket = nullptr;
+        m_trace = nullptr;
+        Application::DoDispose();
+    }
+
+    void StartApplication() override
+    {
+        uint32_t id = GetNode()->GetId();
+        m_cursor = m_trace->Begin(id);
+        m_end = m_trace->End(id);
+        m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+        m_socket->Bind();
+        // skip what was sent before the application started
+        int64_t now = Simulator::Now().GetNanoSeconds();
+        while (m_cursor != m_end && m_cursor->time < now)
+        {
+            m_cursor++;
+        }
+        ScheduleNext();
+    }
+
+    void StopApplication() override
+    {
+        Simulator::Cancel(m_sendEvent);
+        if (m_socket)
+        {
+            m_socket->Close();
+        }
+    }
+
+    /**
+     * Schedule the send of the record under the cursor.
+     */
+    void ScheduleNext()
+    {
+        if (m_cursor != m_end)
+        {
+            m_sendEvent = Simulator::Schedule(NanoSeconds(m_cursor->time) - Simulator::Now(),
+                                              &TrafficReplayApplication::Send,
+                                              this);
+        }
+    }
+
+    /**
+     * Send every record due now and schedule the next one.
+     */
+    void Send()
+    {
+        int64_t now = Simulator::Now().GetNanoSeconds();
+        while (m_cursor != m_end && m_cursor->time <= now)
+        {
+            m_socket->SendTo(Create<Packet>(m_cursor->size),
+                             0,
+                             InetSocketAddress(Ipv4Address(m_cursor->destination), m_cursor->port));
+            m_cursor++;
+        }
+        ScheduleNext();
+    }
+
+    Ptr<TrafficTrace> m_trace;                     //!< Trace being replayed
+    const TrafficTrace::Record* m_cursor{nullptr}; //!< Next record to send
+    const TrafficTrace::Record* m_end{nullptr};    //!< End of this node's records
+    Ptr<Socket> m_socket;                          //!< Sending socket
+    EventId m_sendEvent;                           //!< Next send
+};
+
+NS_OBJECT_ENSURE_REGISTERED(TrafficReplayApplication);
+
+} // namespace ns3
+
+#endif /* TRAFFIC_TRACE_H */
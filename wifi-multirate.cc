@@ -15,12 +15,31 @@
  * Author: Duy Nguyen <duy@soe.ucsc.edu>
  */
 
+#include "batched-yans-wifi-phy.h"
+#include "binary-event-log.h"
+#include "burst-sender.h"
+#include "compact-minstrel-wifi-manager.h"
+#include "fast-exit.h"
+#include "fib-cache.h"
+#include "latency-histogram.h"
+#include "memory-report.h"
+#include "result-cache.h"
+#include "scenario-generator.h"
+#include "shared-memory-simulator-impl.h"
+#include "startup-probe.h"
+#include "steady-state-detector.h"
+#include "timer-wheel.h"
+#include "trace-binder.h"
+#include "traffic-trace.h"
+
 #include "ns3/boolean.h"
 #include "ns3/command-line.h"
 #include "ns3/config.h"
 #include "ns3/double.h"
 #include "ns3/flow-monitor-helper.h"
+#include "ns3/global-value.h"
 #include "ns3/gnuplot.h"
+#include "ns3/hash.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-list-routing-helper.h"
@@ -36,10 +55,48 @@
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/yans-wifi-helper.h"
 
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("multirate");
 
+BinaryEventLog g_eventLog; //!< Per-run binary event log, enabled with --eventLog
+ResultCache g_resultCache; //!< Outputs of runs already made, enabled with --resultCache
+uint16_t g_flowEvent = g_eventLog.RegisterFormat(
+    "flow node {} ({}) at ({},{}) -> node {} ({}) at ({},{}) from {}s to {}s");
+
+std::vector<uint64_t> g_phyTxCount;     //!< Transmissions started, indexed by node id
+std::vector<uint64_t> g_phyRxDropCount; //!< Receptions dropped, indexed by node id
+
+/**
+ * Count a transmission started by a node's PHY.
+ *
+ * \param nodeId The node id.
+ * \param packet The packet being transmitted.
+ * \param txPowerW The transmit power in Watts.
+ */
+static void
+PhyTxBegin(uint32_t nodeId, Ptr<const Packet> packet, double txPowerW)
+{
+    g_phyTxCount[nodeId]++;
+}
+
+/**
+ * Count a reception dropped by a node's PHY.
+ *
+ * \param nodeId The node id.
+ * \param packet The dropped packet.
+ * \param reason The reason of the drop.
+ */
+static void
+PhyRxDrop(uint32_t nodeId, Ptr<const Packet> packet, WifiPhyRxfailureReason reason)
+{
+    g_phyRxDropCount[nodeId]++;
+}
+
 /**
  * WiFi multirate experiment class.
  *
@@ -48,6 +105,11 @@ NS_LOG_COMPONENT_DEFINE("multirate");
  * Scenarios: 100 nodes, multiple simultaneous flows, multi-hop ad hoc, routing,
  * and mobility
  *
+ * The topology defaults to a 10x10 grid; the same scenarios run on grids,
+ * random disks or clusters of any size, with senders and destinations picked
+ * from the node positions (see scenario-generator.h):
+ * ./ns3 run "wifi-multirate --numNodes=10000 --placement=disk --senderSpacing=300"
+ *
  * QUICK INSTRUCTIONS:
  *
  * To optimize build:
@@ -64,6 +126,70 @@ NS_LOG_COMPONENT_DEFINE("multirate");
  * export NS_LOG=multirate=level_all
  * (can only view log if built with ./ns3 configure -d debug)
  *
+ * Minstrel keeps, for every peer a device has sent to, a station object
+ * with per-rate statistics and a sample table of (number of rates x
+ * SampleColumn) entries, each refreshed on its own every UpdateStatistics.
+ * On large all-to-all grids CompactMinstrelWifiManager runs the same
+ * algorithm over per-device tables, one row per peer, updated in one pass
+ * (see compact-minstrel-wifi-manager.h); --memoryReport=1 compares the two:
+ * ./ns3 run "wifi-multirate --rateManager=ns3::CompactMinstrelWifiManager --memoryReport=1"
+ *
+ * In scenarios 3 and 4 every sender saturates its MAC queue with packets for
+ * many neighbors.  The queue keeps one container per (receiver, TID), so
+ * serving a station does not walk the packets of the others, but packets
+ * that wait past MaxDelay are only dropped once they reach the head of their
+ * container; a smaller queue bounds both the backlog and the delay:
+ * ./ns3 run "wifi-multirate --ns3::WifiMacQueue::MaxSize=100p
+ *            --ns3::WifiMacQueue::MaxDelay=100ms"
+ * mac-queue-benchmark compares this organization with a single list.
+ *
+ * Every frame is delivered with one event per receiving PHY.  To schedule
+ * one event per group of receivers at equal propagation delay instead, exact
+ * or rounded down to a quantum (see batched-yans-wifi-phy.h), and compare the
+ * events executed and the wall-clock time:
+ * ./ns3 run "wifi-multirate --eventStats=1 --enableRouting=1"
+ * ./ns3 run "wifi-multirate --eventStats=1 --enableRouting=1 --deliveryQuantum=0"
+ *
+ * To check that two builds or simulator implementations produce exactly the
+ * same run, compare the digest of all packet deliveries:
+ * ./ns3 run "wifi-multirate --printDigest=1"
+ *
+ * To run the nodes on several cores, in vertical strips of the area, each
+ * in its own process (see shared-memory-simulator-impl.h); --partitions=1 is
+ * the sequential reference, whose digest every partitioning reproduces.
+ * The 10x10 grid is the correctness test, the 100x100 grid the benchmark:
+ * ./ns3 run "wifi-multirate --enableTracing=0 --printDigest=1 --partitions=1"
+ * ./ns3 run "wifi-multirate --enableTracing=0 --printDigest=1 --partitions=4"
+ * ./ns3 run "wifi-multirate --enableTracing=0 --eventStats=1 --gridSize=100 --partitions=8"
+ *
+ * For the end-to-end delay quantiles and jitter of every flow without the
+ * cost of FlowMonitor, stamp the packets and histogram their delays at the
+ * sinks (not with --replayTraffic, whose packets are not stamped):
+ * ./ns3 run "wifi-multirate --latency=1"
+ *
+ * To hold the offered load identical across PHY/MAC variants, record the
+ * packets sent by the applications once and replay them in later runs:
+ * ./ns3 run "wifi-multirate --recordTraffic=scenario4.traffic"
+ * ./ns3 run "wifi-multirate --replayTraffic=scenario4.traffic --rtsThreshold=0"
+ *
+ * To record the flow setup to a binary log, formatted offline:
+ * ./ns3 run "wifi-multirate --eventLog=multirate.evlog"
+ * ./ns3 run "binary-event-log-decode --input=multirate.evlog"
+ *
+ * To make repeated sweep points free, store every run under a key made of its
+ * whole configuration; a later run with the same key prints the stored output
+ * and restores the stored files instead of simulating:
+ * ./ns3 run "wifi-multirate --resultCache=results --enableFlowMon=1"
+ *
+ * On large grids, skip the teardown of every object once the outputs are
+ * flushed (not with pcap, whose files are only flushed on teardown):
+ * ./ns3 run "wifi-multirate --fastExit=1 --verifyExit=1"
+ *
+ * To stop as soon as the sampled throughput has settled and its mean is known
+ * within a given fraction, with totalTime as an upper bound; the warm-up
+ * truncated from the mean is reported (see steady-state-detector.h):
+ * ./ns3 run "wifi-multirate --totalTime=100 --samplingPeriod=0.05 --steadyState=0.05"
+ *
  * To debug:
  * ./ns3 shell
  * gdb ./build/debug/examples/wireless/wifi-multirate
@@ -178,7 +304,9 @@ class Experiment
      */
     Ptr<Socket> SetupPacketReceive(Ptr<Node> node);
     /**
-     * Generate 1-hop and 2-hop neighbors of a node in grid topology
+     * Generate the neighbors of a node, up to m_neighborHops hops away; on a
+     * square grid with 2 hops, the original 5x5 block around the node,
+     * itself included, in the original order
      * \param c The node container.
      * \param senderId The sender ID.
      * \return the neighbor nodes.
@@ -195,8 +323,9 @@ class Experiment
      */
     void ApplicationSetup(Ptr<Node> client, Ptr<Node> server, double start, double stop);
     /**
-     * Take the grid map, divide it into 4 quadrants
+     * Take the node map, divide it into 4 quadrants
      * Assign all nodes from each quadrant to a specific container
+     * (by index on the default square grid, by position otherwise)
      *
      * \param c The node container.
      */
@@ -204,7 +333,8 @@ class Experiment
     /**
      * Sources and destinations are randomly selected such that a node
      * may be the source for multiple destinations and a node maybe a destination
-     * for multiple sources.
+     * for multiple sources.  There are m_flowDensity flows per node; with
+     * m_maxHops set, destinations are at most that many hops from their source.
      *
      * \param c The node container.
      */
@@ -219,6 +349,24 @@ class Experiment
      * \brief Calculate the throughput.
      */
     void CheckThroughput();
+    /**
+     * \brief Print the throughput of a sampling period.
+     *
+     * \param time The end of the period.
+     * \param bytes The bytes received in it.
+     */
+    void PrintThroughput(Time time, uint32_t bytes);
+    /**
+     * \return the results of the partition of this process.
+     */
+    std::string CollectPartition();
+    /**
+     * \brief Merge the results of all partitions, and print the throughput.
+     *
+     * \param collected The results of each partition.
+     * \return the events run by all partitions.
+     */
+    uint64_t MergePartitions(const std::vector<std::string>& collected);
     /**
      * A sender node will  set up a flow to each of the its neighbors
      * in its quadrant randomly.  All the flows are exponentially distributed.
@@ -230,9 +378,15 @@ class Experiment
 
     Gnuplot2dDataset m_output; //!< Output dataset.
 
-    double m_totalTime;      //!< Total experiment time.
-    double m_expMean;        //!< Exponential parameter for sending packets.
-    double m_samplingPeriod; //!< Sampling period.
+    double m_totalTime;       //!< Total experiment time.
+    double m_expMean;         //!< Exponential parameter for sending packets.
+    double m_samplingPeriod;  //!< Sampling period.
+    double m_memoryReport;    //!< Time of the memory report, negative to disable.
+    double m_range;           //!< Hop range of the neighbor index, 0 for 1.5 nodeDistance.
+    double m_senderSpacing;   //!< Distance between senders, 0 for 2 nodeDistance.
+    double m_flowDensity;     //!< Flows per node in scenario 1.
+    double m_steadyState;     //!< Target relative precision of the throughput, 0 to disable.
+    double m_deliveryQuantum; //!< Delivery event quantum (ns), negative for one per receiver.
 
     uint32_t m_bytesTotal;   //!< Total number of received bytes.
     uint32_t m_packetSize;   //!< Packet size.
@@ -240,12 +394,24 @@ class Experiment
     uint32_t m_nodeDistance; //!< Node distance.
     uint32_t m_port;         //!< Listening port.
     uint32_t m_scenario;     //!< Scenario number.
+    uint32_t m_numNodes;     //!< Number of nodes, 0 for gridSize x gridSize.
+    uint32_t m_neighborHops; //!< Hops from a sender to its destinations in scenario 4.
+    uint32_t m_maxHops;      //!< Largest source to destination hops in scenario 1, 0 for any.
+    uint32_t m_clusters;     //!< Number of clusters of the clustered placement.
+    uint32_t m_burstSize;    //!< Packets per sender timer expiration, 0 for OnOff.
+    uint32_t m_flows;        //!< Number of flows set up.
+    uint32_t m_partitions;   //!< Parallel simulator processes, 0 for the default simulator.
 
     bool m_enablePcap;     //!< True if PCAP output is enabled.
     bool m_enableTracing;  //!< True if tracing output is enabled.
     bool m_enableFlowMon;  //!< True if FlowMon is enabled.
     bool m_enableRouting;  //!< True if routing is enabled.
     bool m_enableMobility; //!< True if mobility is enabled.
+    bool m_enablePhyStats; //!< True if per-node PHY counters are enabled.
+    bool m_eventStats;     //!< True if event counts and wall time are reported.
+    bool m_fibCache;       //!< True if forwarding decisions are cached.
+    bool m_latency;        //!< True if end-to-end delay and jitter are recorded.
+    bool m_printDigest;    //!< True if the delivery digest is printed.
 
     /**
      * Node containers for each quadrant.
@@ -259,6 +425,17 @@ class Experiment
     std::string m_rtsThreshold;   //!< Rts threshold.
     std::string m_rateManager;    //!< Rate manager.
     std::string m_outputFileName; //!< Output file name.
+    std::string m_eventLog;       //!< Binary event log file name.
+    std::string m_recordTraffic;  //!< File to record the application traffic to.
+    std::string m_replayTraffic;  //!< File to replay the application traffic from.
+    std::string m_placement;      //!< Node placement: grid, disk or clustered.
+
+    ScenarioGenerator m_generator;             //!< Node positions and neighbor index.
+    PeriodicTimer m_throughputTimer;           //!< Throughput sampling timer.
+    SteadyStateDetector m_steadyStateDetector; //!< Stops the run once the throughput settles.
+    LatencyRecorder m_latencyRecorder;         //!< Delay and jitter of every flow.
+    std::vector<uint64_t> m_rxDigests;         //!< Hash of the deliveries of every node.
+    std::vector<uint32_t> m_sampleBytes;       //!< Bytes of each sampling period (partitions).
 };
 
 Experiment::Experiment()
@@ -271,6 +448,12 @@ Experiment::Experiment(std::string name)
       m_expMean(0.1),
       // flows being exponentially distributed
       m_samplingPeriod(0.1),
+      m_memoryReport(-1),
+      m_range(0),
+      m_senderSpacing(0),
+      m_flowDensity(1.0 / 3),
+      m_steadyState(0),
+      m_deliveryQuantum(-1),
       m_bytesTotal(0),
       m_packetSize(2000),
       m_gridSize(10),
@@ -278,15 +461,31 @@ Experiment::Experiment(std::string name)
       m_nodeDistance(30),
       m_port(5000),
       m_scenario(4),
+      m_numNodes(0),
+      m_neighborHops(2),
+      m_maxHops(0),
+      m_clusters(10),
+      m_burstSize(0),
+      m_flows(0),
+      m_partitions(0),
       m_enablePcap(false),
       m_enableTracing(true),
       m_enableFlowMon(false),
       m_enableRouting(false),
       m_enableMobility(false),
+      m_enablePhyStats(false),
+      m_eventStats(false),
+      m_fibCache(false),
+      m_latency(false),
+      m_printDigest(false),
       m_rtsThreshold("2200"),
       // 0 for enabling rts/cts
       m_rateManager("ns3::MinstrelWifiManager"),
-      m_outputFileName("minstrel")
+      m_outputFileName("minstrel"),
+      m_eventLog(""),
+      m_recordTraffic(""),
+      m_replayTraffic(""),
+      m_placement("grid")
 {
     m_output.SetStyle(Gnuplot2dDataset::LINES);
 }
@@ -310,51 +509,198 @@ Experiment::ReceivePacket(Ptr<Socket> socket)
     while ((packet = socket->Recv()))
     {
         m_bytesTotal += packet->GetSize();
+        if (m_latency)
+        {
+            m_latencyRecorder.Receive(packet);
+        }
+        if (m_printDigest)
+        {
+            // chain the previous digest of the node with this delivery so
+            // that the digest depends on the order of its deliveries too; one
+            // chain per node, as the partitions of a parallel run see them
+            uint64_t& digest = m_rxDigests[socket->GetNode()->GetId()];
+            uint64_t record[3] = {digest,
+                                  static_cast<uint64_t>(Simulator::Now().GetTimeStep()),
+                                  packet->GetSize()};
+            digest = Hash64(reinterpret_cast<const char*>(record), sizeof(record));
+        }
     }
 }
 
 void
 Experiment::CheckThroughput()
 {
-    double mbs = ((m_bytesTotal * 8.0) / 1000000 / m_samplingPeriod);
+    if (m_partitions > 0)
+    {
+        // each partition only sees its own sinks: printed once merged
+        m_sampleBytes.push_back(m_bytesTotal);
+        m_bytesTotal = 0;
+        return;
+    }
+    uint32_t bytes = m_bytesTotal;
     m_bytesTotal = 0;
-    m_output.Add((Simulator::Now()).GetSeconds(), mbs);
-    std::cout << (Simulator::Now()).GetSeconds() << "s: \t" << mbs << " Mbit/s" << std::endl;
+    PrintThroughput(Simulator::Now(), bytes);
+}
 
-    // check throughput every samplingPeriod second
-    Simulator::Schedule(Seconds(m_samplingPeriod), &Experiment::CheckThroughput, this);
+void
+Experiment::PrintThroughput(Time time, uint32_t bytes)
+{
+    double mbs = ((bytes * 8.0) / 1000000 / m_samplingPeriod);
+    m_output.Add(time.GetSeconds(), mbs);
+    std::cout << time.GetSeconds() << "s: \t" << mbs << " Mbit/s" << std::endl;
+    if (m_steadyStateDetector.AddSample(mbs))
+    {
+        Simulator::Stop();
+    }
+}
+
+std::string
+Experiment::CollectPartition()
+{
+    std::ostringstream os;
+    os << Simulator::GetEventCount() << " " << m_sampleBytes.size();
+    for (uint32_t bytes : m_sampleBytes)
+    {
+        os << " " << bytes;
+    }
+    os << " " << m_rxDigests.size();
+    for (uint64_t digest : m_rxDigests)
+    {
+        os << " " << digest;
+    }
+    os << " " << g_phyTxCount.size();
+    for (std::size_t i = 0; i < g_phyTxCount.size(); i++)
+    {
+        os << " " << g_phyTxCount[i] << " " << g_phyRxDropCount[i];
+    }
+    os << "\n";
+    m_latencyRecorder.Serialize(os);
+    return os.str();
+}
+
+uint64_t
+Experiment::MergePartitions(const std::vector<std::string>& collected)
+{
+    std::vector<uint32_t> sampleBytes;
+    uint64_t totalEvents = 0;
+    std::fill(m_rxDigests.begin(), m_rxDigests.end(), 0);
+    std::fill(g_phyTxCount.begin(), g_phyTxCount.end(), 0);
+    std::fill(g_phyRxDropCount.begin(), g_phyRxDropCount.end(), 0);
+    m_latencyRecorder = LatencyRecorder();
+    for (const auto& partition : collected)
+    {
+        std::istringstream is(partition);
+        uint64_t events;
+        std::size_t n;
+        is >> events >> n;
+        sampleBytes.resize(n, 0);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            uint32_t bytes;
+            is >> bytes;
+            sampleBytes[i] += bytes;
+        }
+        is >> n;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            // a node only receives in its own partition: the others are 0
+            uint64_t digest;
+            is >> digest;
+            m_rxDigests[i] ^= digest;
+        }
+        is >> n;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            uint64_t tx;
+            uint64_t rxDrop;
+            is >> tx >> rxDrop;
+            g_phyTxCount[i] += tx;
+            g_phyRxDropCount[i] += rxDrop;
+        }
+        NS_ABORT_MSG_UNLESS(is && m_latencyRecorder.Deserialize(is), "Invalid partition results");
+        totalEvents += events;
+    }
+    for (std::size_t i = 0; i < sampleBytes.size(); i++)
+    {
+        PrintThroughput(Seconds(i * m_samplingPeriod), sampleBytes[i]);
+    }
+    return totalEvents;
 }
 
 void
 Experiment::AssignNeighbors(NodeContainer c)
 {
-    uint32_t totalNodes = c.GetN();
-    for (uint32_t i = 0; i < totalNodes; i++)
+    if (m_placement == "grid" && m_numNodes == 0)
     {
-        if ((i % m_gridSize) <= (m_gridSize / 2 - 1))
+        // square grid: the original split by index, the quadrants sharing
+        // the column left of the center and the row below it
+        uint32_t totalNodes = c.GetN();
+        for (uint32_t i = 0; i < totalNodes; i++)
+        {
+            if ((i % m_gridSize) <= (m_gridSize / 2 - 1))
+            {
+                // lower left quadrant
+                if (i < totalNodes / 2)
+                {
+                    m_containerA.Add(c.Get(i));
+                }
+
+                // upper left quadrant
+                if (i >= (uint32_t)(4 * totalNodes) / 10)
+                {
+                    m_containerC.Add(c.Get(i));
+                }
+            }
+            if ((i % m_gridSize) >= (m_gridSize / 2 - 1))
+            {
+                // lower right quadrant
+                if (i < totalNodes / 2)
+                {
+                    m_containerB.Add(c.Get(i));
+                }
+
+                // upper right quadrant
+                if (i >= (uint32_t)(4 * totalNodes) / 10)
+                {
+                    m_containerD.Add(c.Get(i));
+                }
+            }
+        }
+        return;
+    }
+
+    // other topologies: split at the center, the quadrants sharing the
+    // nodes on the center lines
+    Vector center((m_generator.GetMin().x + m_generator.GetMax().x) / 2,
+                  (m_generator.GetMin().y + m_generator.GetMax().y) / 2,
+                  0);
+    for (uint32_t i = 0; i < c.GetN(); i++)
+    {
+        const Vector& position = m_generator.GetPosition(i);
+        if (position.x <= center.x)
         {
             // lower left quadrant
-            if (i < totalNodes / 2)
+            if (position.y <= center.y)
             {
                 m_containerA.Add(c.Get(i));
             }
 
             // upper left quadrant
-            if (i >= (uint32_t)(4 * totalNodes) / 10)
+            if (position.y >= center.y)
             {
                 m_containerC.Add(c.Get(i));
             }
         }
-        if ((i % m_gridSize) >= (m_gridSize / 2 - 1))
+        if (position.x >= center.x)
         {
             // lower right quadrant
-            if (i < totalNodes / 2)
+            if (position.y <= center.y)
             {
                 m_containerB.Add(c.Get(i));
             }
 
             // upper right quadrant
-            if (i >= (uint32_t)(4 * totalNodes) / 10)
+            if (position.y >= center.y)
             {
                 m_containerD.Add(c.Get(i));
             }
@@ -366,15 +712,29 @@ NodeContainer
 Experiment::GenerateNeighbors(NodeContainer c, uint32_t senderId)
 {
     NodeContainer nc;
-    uint32_t limit = senderId + 2;
-    for (uint32_t i = senderId - 2; i <= limit; i++)
+    if (m_placement == "grid" && m_numNodes == 0 && m_neighborHops == 2)
+    {
+        // column by column, each from the sender's row up then down, as the
+        // 10x10 scenario has always drawn its destinations from; the block
+        // is clipped at the edges of the grid
+        int32_t width = m_gridSize;
+        int32_t row = senderId / width;
+        int32_t column = senderId % width;
+        for (int32_t dx = -2; dx <= 2; dx++)
+        {
+            for (int32_t dy : {0, 1, 2, -1, -2})
+            {
+                if (column + dx >= 0 && column + dx < width && row + dy >= 0 && row + dy < width)
+                {
+                    nc.Add(c.Get((row + dy) * width + column + dx));
+                }
+            }
+        }
+        return nc;
+    }
+    for (uint32_t i : m_generator.GetNeighbors(senderId, m_neighborHops))
     {
-        // must ensure the boundaries for other topologies
         nc.Add(c.Get(i));
-        nc.Add(c.Get(i + 10));
-        nc.Add(c.Get(i + 20));
-        nc.Add(c.Get(i - 10));
-        nc.Add(c.Get(i - 20));
     }
     return nc;
 }
@@ -383,14 +743,24 @@ void
 Experiment::SelectSrcDest(NodeContainer c)
 {
     uint32_t totalNodes = c.GetN();
+    uint32_t flows = std::max<uint32_t>(1, m_flowDensity * totalNodes);
+    if (m_maxHops > 0)
+    {
+        for (const auto& [src, dest] : m_generator.SelectPairs(flows, m_maxHops))
+        {
+            ApplicationSetup(c.Get(src), c.Get(dest), 0, m_totalTime);
+        }
+        return;
+    }
+
     Ptr<UniformRandomVariable> uvSrc = CreateObject<UniformRandomVariable>();
     uvSrc->SetAttribute("Min", DoubleValue(0));
     uvSrc->SetAttribute("Max", DoubleValue(totalNodes / 2 - 1));
     Ptr<UniformRandomVariable> uvDest = CreateObject<UniformRandomVariable>();
     uvDest->SetAttribute("Min", DoubleValue(totalNodes / 2));
-    uvDest->SetAttribute("Max", DoubleValue(totalNodes));
+    uvDest->SetAttribute("Max", DoubleValue(totalNodes - 1));
 
-    for (uint32_t i = 0; i < totalNodes / 3; i++)
+    for (uint32_t i = 0; i < flows; i++)
     {
         ApplicationSetup(c.Get(uvSrc->GetInteger()), c.Get(uvDest->GetInteger()), 0, m_totalTime);
     }
@@ -399,6 +769,11 @@ Experiment::SelectSrcDest(NodeContainer c)
 void
 Experiment::SendMultiDestinations(Ptr<Node> sender, NodeContainer c)
 {
+    if (c.GetN() == 0 || (c.GetN() == 1 && c.Get(0) == sender))
+    {
+        return;
+    }
+
     // UniformRandomVariable params: (Xrange, Yrange)
     Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
     uv->SetAttribute("Min", DoubleValue(0));
@@ -477,15 +852,49 @@ Experiment::ApplicationSetup(Ptr<Node> client, Ptr<Node> server, double start, d
     Ipv4Address ipv4AddrServer = iaddrServer.GetLocal();
 
     NS_LOG_DEBUG(PrintPosition(client, server));
+    if (g_eventLog.IsEnabled())
+    {
+        Vector serverPos = server->GetObject<MobilityModel>()->GetPosition();
+        Vector clientPos = client->GetObject<MobilityModel>()->GetPosition();
+        g_eventLog.Record(g_flowEvent,
+                          client->GetId(),
+                          client->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal(),
+                          clientPos.x,
+                          clientPos.y,
+                          server->GetId(),
+                          ipv4AddrServer,
+                          serverPos.x,
+                          serverPos.y,
+                          start,
+                          stop);
+    }
 
-    // Equipping the source  node with OnOff Application used for sending
-    OnOffHelper onoff("ns3::UdpSocketFactory",
-                      Address(InetSocketAddress(Ipv4Address("10.0.0.1"), m_port)));
-    onoff.SetConstantRate(DataRate(60000000));
-    onoff.SetAttribute("PacketSize", UintegerValue(m_packetSize));
-    onoff.SetAttribute("Remote", AddressValue(InetSocketAddress(ipv4AddrServer, m_port)));
-
-    ApplicationContainer apps = onoff.Install(client);
+    ApplicationContainer apps;
+    if (m_burstSize == 0)
+    {
+        // Equipping the source  node with OnOff Application used for sending
+        OnOffHelper onoff("ns3::UdpSocketFactory",
+                          Address(InetSocketAddress(Ipv4Address("10.0.0.1"), m_port)));
+        onoff.SetConstantRate(DataRate(60000000));
+        onoff.SetAttribute("PacketSize", UintegerValue(m_packetSize));
+        onoff.SetAttribute("Remote", AddressValue(InetSocketAddress(ipv4AddrServer, m_port)));
+        apps = onoff.Install(client);
+    }
+    else
+    {
+        // same rate, m_burstSize packets per sender event
+        BurstSenderHelper burst("ns3::UdpSocketFactory",
+                                InetSocketAddress(ipv4AddrServer, m_port));
+        burst.SetAttribute("DataRate", DataRateValue(DataRate(60000000)));
+        burst.SetAttribute("PacketSize", UintegerValue(m_packetSize));
+        burst.SetAttribute("BurstSize", UintegerValue(m_burstSize));
+        apps = burst.Install(client);
+    }
+    if (m_latency)
+    {
+        LatencyRecorder::EnableSource(apps.Get(0), m_flows);
+    }
+    m_flows++;
     apps.Start(Seconds(start));
     apps.Stop(Seconds(stop));
 
@@ -499,12 +908,31 @@ Experiment::Run(const WifiHelper& wifi,
                 const YansWifiChannelHelper& wifiChannel,
                 const MobilityHelper& mobility)
 {
-    uint32_t nodeSize = m_gridSize * m_gridSize;
+    // before the applications are set up: they record their flows
+    if (!m_eventLog.empty())
+    {
+        g_eventLog.Open(m_eventLog);
+        g_resultCache.AddOutput(m_eventLog);
+    }
+
+    uint32_t nodeSize = m_numNodes > 0 ? m_numNodes : m_gridSize * m_gridSize;
+    m_generator.SetPlacement(ScenarioGenerator::ParsePlacement(m_placement));
+    m_generator.SetSpacing(m_nodeDistance);
+    m_generator.SetGridWidth(m_numNodes > 0 ? 0 : m_gridSize);
+    m_generator.SetClusters(m_clusters, 0);
+    m_generator.SetRange(m_range > 0 ? m_range : 1.5 * m_nodeDistance);
+    m_generator.Generate(nodeSize);
+
     NodeContainer c;
     c.Create(nodeSize);
 
     YansWifiPhyHelper phy = wifiPhy;
-    phy.SetChannel(wifiChannel.Create());
+    if (m_deliveryQuantum >= 0)
+    {
+        phy = BatchedYansWifiPhyHelper(wifiPhy, NanoSeconds(m_deliveryQuantum));
+    }
+    Ptr<YansWifiChannel> channel = wifiChannel.Create();
+    phy.SetChannel(channel);
 
     NetDeviceContainer devices = wifi.Install(phy, wifiMac, c);
 
@@ -517,6 +945,10 @@ Experiment::Run(const WifiHelper& wifi,
     {
         list.Add(staticRouting, 0);
         list.Add(olsr, 10);
+        if (m_fibCache)
+        {
+            FibCacheHelper::Install(list);
+        }
     }
 
     InternetStackHelper internet;
@@ -528,25 +960,13 @@ Experiment::Run(const WifiHelper& wifi,
     internet.Install(c);
 
     Ipv4AddressHelper address;
-    address.SetBase("10.0.0.0", "255.255.255.0");
+    address.SetBase("10.0.0.0", nodeSize < 255 ? "255.255.255.0" : "255.0.0.0");
 
     Ipv4InterfaceContainer ipInterfaces;
     ipInterfaces = address.Assign(devices);
 
     MobilityHelper mobil = mobility;
-    mobil.SetPositionAllocator("ns3::GridPositionAllocator",
-                               "MinX",
-                               DoubleValue(0.0),
-                               "MinY",
-                               DoubleValue(0.0),
-                               "DeltaX",
-                               DoubleValue(m_nodeDistance),
-                               "DeltaY",
-                               DoubleValue(m_nodeDistance),
-                               "GridWidth",
-                               UintegerValue(m_gridSize),
-                               "LayoutType",
-                               StringValue("RowFirst"));
+    mobil.SetPositionAllocator(m_generator.GetPositionAllocator());
 
     mobil.SetMobilityModel("ns3::ConstantPositionMobilityModel");
 
@@ -555,7 +975,10 @@ Experiment::Run(const WifiHelper& wifi,
         // Rectangle (xMin, xMax, yMin, yMax)
         mobil.SetMobilityModel("ns3::RandomDirection2dMobilityModel",
                                "Bounds",
-                               RectangleValue(Rectangle(0, 500, 0, 500)),
+                               RectangleValue(Rectangle(std::min(0.0, m_generator.GetMin().x),
+                                                        std::max(500.0, m_generator.GetMax().x),
+                                                        std::min(0.0, m_generator.GetMin().y),
+                                                        std::max(500.0, m_generator.GetMax().y))),
                                "Speed",
                                StringValue("ns3::ConstantRandomVariable[Constant=10]"),
                                "Pause",
@@ -563,7 +986,28 @@ Experiment::Run(const WifiHelper& wifi,
     }
     mobil.Install(c);
 
-    if (m_scenario == 1 && m_enableRouting)
+    Ptr<SharedMemorySimulatorImpl> parallel;
+    if (m_partitions > 0)
+    {
+        parallel = SharedMemorySimulatorImpl::Get();
+        NS_ABORT_MSG_UNLESS(parallel, "The simulator was created before --partitions was applied");
+        parallel->PartitionNodes(c);
+        BatchedYansWifiPhy::SetupPartitions(channel);
+        parallel->SetCollectCallback(MakeCallback(&Experiment::CollectPartition, this));
+    }
+    m_rxDigests.assign(m_printDigest ? nodeSize : 0, 0);
+
+    if (!m_replayTraffic.empty())
+    {
+        // the recorded packets replace the scenario's applications
+        Ptr<TrafficTrace> trace = Create<TrafficTrace>(m_replayTraffic);
+        TrafficReplayApplication::Install(c, trace);
+        for (uint32_t i = 0; i < nodeSize; i++)
+        {
+            SetupPacketReceive(c.Get(i));
+        }
+    }
+    else if (m_scenario == 1 && m_enableRouting)
     {
         SelectSrcDest(c);
     }
@@ -578,69 +1022,93 @@ Experiment::Run(const WifiHelper& wifi,
     else if (m_scenario == 3)
     {
         AssignNeighbors(c);
-        // Note: these senders are hand-picked in order to ensure good coverage
-        // for 10x10 grid, basically one sender for each quadrant
-        // you might have to change these values for other grids
+        // one sender for each quadrant: on the default 10x10 grid the
+        // hand-picked 22, 26, 72 and 76, elsewhere the node nearest to the
+        // quadrant center
+        uint32_t senders[4] = {22, 26, 72, 76};
+        if (m_placement != "grid" || m_numNodes != 0 || m_gridSize != 10)
+        {
+            Vector min = m_generator.GetMin();
+            Vector max = m_generator.GetMax();
+            double left = min.x + (max.x - min.x) / 4;
+            double right = max.x - (max.x - min.x) / 4;
+            double bottom = min.y + (max.y - min.y) / 4;
+            double top = max.y - (max.y - min.y) / 4;
+            senders[0] = m_generator.GetNearest(Vector(left, bottom, 0));
+            senders[1] = m_generator.GetNearest(Vector(right, bottom, 0));
+            senders[2] = m_generator.GetNearest(Vector(left, top, 0));
+            senders[3] = m_generator.GetNearest(Vector(right, top, 0));
+        }
+
         NS_LOG_DEBUG(">>>>>>>>>region A<<<<<<<<<");
-        SendMultiDestinations(c.Get(22), m_containerA);
+        SendMultiDestinations(c.Get(senders[0]), m_containerA);
 
         NS_LOG_DEBUG(">>>>>>>>>region B<<<<<<<<<");
-        SendMultiDestinations(c.Get(26), m_containerB);
+        SendMultiDestinations(c.Get(senders[1]), m_containerB);
 
         NS_LOG_DEBUG(">>>>>>>>>region C<<<<<<<<<");
-        SendMultiDestinations(c.Get(72), m_containerC);
+        SendMultiDestinations(c.Get(senders[2]), m_containerC);
 
         NS_LOG_DEBUG(">>>>>>>>>region D<<<<<<<<<");
-        SendMultiDestinations(c.Get(76), m_containerD);
+        SendMultiDestinations(c.Get(senders[3]), m_containerD);
     }
     else if (m_scenario == 4)
     {
-        // GenerateNeighbors(NodeContainer, uint32_t sender)
-        // Note: these senders are hand-picked in order to ensure good coverage
-        // you might have to change these values for other grids
-        NodeContainer c1;
-        NodeContainer c2;
-        NodeContainer c3;
-        NodeContainer c4;
-        NodeContainer c5;
-        NodeContainer c6;
-        NodeContainer c7;
-        NodeContainer c8;
-        NodeContainer c9;
-
-        c1 = GenerateNeighbors(c, 22);
-        c2 = GenerateNeighbors(c, 24);
-        c3 = GenerateNeighbors(c, 26);
-        c4 = GenerateNeighbors(c, 42);
-        c5 = GenerateNeighbors(c, 44);
-        c6 = GenerateNeighbors(c, 46);
-        c7 = GenerateNeighbors(c, 62);
-        c8 = GenerateNeighbors(c, 64);
-        c9 = GenerateNeighbors(c, 66);
-
-        SendMultiDestinations(c.Get(22), c1);
-        SendMultiDestinations(c.Get(24), c2);
-        SendMultiDestinations(c.Get(26), c3);
-        SendMultiDestinations(c.Get(42), c4);
-        SendMultiDestinations(c.Get(44), c5);
-        SendMultiDestinations(c.Get(46), c6);
-        SendMultiDestinations(c.Get(62), c7);
-        SendMultiDestinations(c.Get(64), c8);
-        SendMultiDestinations(c.Get(66), c9);
+        // senders spread over the area, each sending to its neighbors; on the
+        // default 10x10 grid these are nodes 22, 24, 26, 42, ..., 66
+        double senderSpacing = m_senderSpacing > 0 ? m_senderSpacing : 2.0 * m_nodeDistance;
+        for (uint32_t sender : m_generator.SelectSenders(senderSpacing))
+        {
+            SendMultiDestinations(c.Get(sender), GenerateNeighbors(c, sender));
+        }
+    }
+
+    if (m_memoryReport >= 0)
+    {
+        MemoryReport::Schedule(Seconds(m_memoryReport), &std::cout);
+    }
+
+    TrafficRecorder recorder;
+    if (!m_recordTraffic.empty())
+    {
+        recorder.Connect(c);
     }
 
+    // check throughput every samplingPeriod second
+    m_steadyStateDetector.Enable(m_steadyState);
+    m_throughputTimer.SetFunction(&Experiment::CheckThroughput, this);
+    m_throughputTimer.SetPeriod(Seconds(m_samplingPeriod));
     CheckThroughput();
+    m_throughputTimer.Start(Seconds(m_samplingPeriod));
 
     if (m_enablePcap)
     {
         phy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
         phy.EnablePcapAll(GetOutputFileName());
+        // the pcap files are only flushed when their writers are disposed
+        FastExit::RequireDestroy();
     }
 
     if (m_enableTracing)
     {
         AsciiTraceHelper ascii;
-        phy.EnableAsciiAll(ascii.CreateFileStream(GetOutputFileName() + ".tr"));
+        Ptr<OutputStreamWrapper> stream = ascii.CreateFileStream(GetOutputFileName() + ".tr");
+        FastExit::Register(stream, GetOutputFileName() + ".tr");
+        g_resultCache.AddOutput(GetOutputFileName() + ".tr");
+        phy.EnableAsciiAll(stream);
+    }
+
+    if (m_enablePhyStats)
+    {
+        // bound directly on the PHYs of the devices: no Config path resolution
+        g_phyTxCount.assign(nodeSize, 0);
+        g_phyRxDropCount.assign(nodeSize, 0);
+        TraceBinder::ConnectWifiPhy<WifiPhy::PhyTxBeginTracedCallback>(devices,
+                                                                       "PhyTxBegin",
+                                                                       &PhyTxBegin);
+        TraceBinder::ConnectWifiPhy<WifiPhy::PhyRxDropTracedCallback>(devices,
+                                                                      "PhyRxDrop",
+                                                                      &PhyRxDrop);
     }
 
     FlowMonitorHelper flowmonHelper;
@@ -651,14 +1119,89 @@ Experiment::Run(const WifiHelper& wifi,
     }
 
     Simulator::Stop(Seconds(m_totalTime));
+    auto wallStart = std::chrono::steady_clock::now();
+    StartupProbe::BeforeRun();
     Simulator::Run();
+    g_eventLog.Close();
+
+    uint64_t events = Simulator::GetEventCount();
+    if (parallel)
+    {
+        // only the first partition returns from Run
+        events = MergePartitions(parallel->GetCollected());
+    }
+
+    if (m_eventStats)
+    {
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart)
+                          .count();
+        std::cout << "Events executed: " << events << " in " << wall << " s wall-clock time ("
+                  << events / wall << " events/s)" << std::endl;
+    }
+
+    if (m_enableRouting && m_fibCache)
+    {
+        FibCacheHelper::PrintStatistics(std::cout, c);
+    }
+
+    if (m_steadyStateDetector.IsEnabled())
+    {
+        m_steadyStateDetector.Print(std::cout, "Mbit/s");
+        std::cout << "Warm-up ends at "
+                  << m_steadyStateDetector.GetTruncation() * m_samplingPeriod << "s" << std::endl;
+    }
 
     if (m_enableFlowMon)
     {
         flowmonHelper.SerializeToXmlFile((GetOutputFileName() + ".flomon"), false, false);
+        g_resultCache.AddOutput(GetOutputFileName() + ".flomon");
     }
 
-    Simulator::Destroy();
+    if (!m_recordTraffic.empty())
+    {
+        recorder.Write(m_recordTraffic);
+        g_resultCache.AddOutput(m_recordTraffic);
+    }
+
+    if (m_printDigest)
+    {
+        uint64_t digest = Hash64(reinterpret_cast<const char*>(m_rxDigests.data()),
+                                 m_rxDigests.size() * sizeof(uint64_t));
+        std::cout << "Delivery digest: " << std::hex << digest << std::dec << std::endl;
+    }
+
+    if (m_latency)
+    {
+        std::cout << "End-to-end delay and jitter, by flow:" << std::endl;
+        m_latencyRecorder.Print(std::cout);
+    }
+
+    if (m_memoryReport >= 0)
+    {
+        MemoryReport::Print(std::cout);
+    }
+
+    if (m_enablePhyStats)
+    {
+        std::ofstream phyStats(GetOutputFileName() + ".phystats");
+        g_resultCache.AddOutput(GetOutputFileName() + ".phystats");
+        uint64_t totalTx = 0;
+        uint64_t totalRxDrop = 0;
+        phyStats << "# node tx rxDrop" << std::endl;
+        for (uint32_t i = 0; i < nodeSize; i++)
+        {
+            phyStats << i << " " << g_phyTxCount[i] << " " << g_phyRxDropCount[i] << std::endl;
+            totalTx += g_phyTxCount[i];
+            totalRxDrop += g_phyRxDropCount[i];
+        }
+        std::cout << "PHY transmissions: " << totalTx << ", dropped receptions: " << totalRxDrop
+                  << std::endl;
+    }
+
+    if (!FastExit::IsActive())
+    {
+        Simulator::Destroy();
+    }
 
     return m_output;
 }
@@ -686,22 +1229,116 @@ Experiment::CommandSetup(int argc, char** argv)
     cmd.AddValue("outputFileName", "output filename", m_outputFileName);
     cmd.AddValue("enableRouting", "enable Routing", m_enableRouting);
     cmd.AddValue("enableMobility", "enable Mobility", m_enableMobility);
+    cmd.AddValue("fibCache", "cache forwarding decisions in front of the routing", m_fibCache);
+    cmd.AddValue("enablePhyStats", "count PHY transmissions and drops per node", m_enablePhyStats);
+    cmd.AddValue("eventStats", "report executed events and wall-clock time", m_eventStats);
+    cmd.AddValue("deliveryQuantum",
+                 "group receivers at equal delays (ns), 0 exact, -1 for one event each",
+                 m_deliveryQuantum);
+    cmd.AddValue("printDigest",
+                 "print a hash of every delivery (time, node, size) to compare runs",
+                 m_printDigest);
+    cmd.AddValue("partitions",
+                 "run the nodes in this many processes in parallel, 0 for the default simulator",
+                 m_partitions);
+    cmd.AddValue("latency", "report end-to-end delay quantiles and jitter per flow", m_latency);
+    cmd.AddValue("burstSize",
+                 "packets sent per sender timer expiration, 0 for one event per packet",
+                 m_burstSize);
     cmd.AddValue("scenario", "scenario ", m_scenario);
+    cmd.AddValue("gridSize", "nodes per side of the default square grid", m_gridSize);
+    cmd.AddValue("numNodes", "number of nodes (0 for gridSize x gridSize)", m_numNodes);
+    cmd.AddValue("nodeDistance", "grid spacing; other placements keep its density", m_nodeDistance);
+    cmd.AddValue("placement", "node placement: grid, disk or clustered", m_placement);
+    cmd.AddValue("clusters", "number of clusters of the clustered placement", m_clusters);
+    cmd.AddValue("range", "hop range used to pick neighbors (0 for 1.5 nodeDistance)", m_range);
+    cmd.AddValue("neighborHops",
+                 "hops from a sender to its destinations (scenario 4)",
+                 m_neighborHops);
+    cmd.AddValue("senderSpacing",
+                 "distance between senders (scenario 4, 0 for 2 nodeDistance)",
+                 m_senderSpacing);
+    cmd.AddValue("flowDensity", "flows per node (scenario 1)", m_flowDensity);
+    cmd.AddValue("maxHops",
+                 "largest source to destination hops (scenario 1, 0 for any)",
+                 m_maxHops);
+    cmd.AddValue("steadyState",
+                 "stop once the throughput is known within this fraction, 0 to disable",
+                 m_steadyState);
+    cmd.AddValue("memoryReport",
+                 "time (s) of a memory usage report, also printed at the end",
+                 m_memoryReport);
+    cmd.AddValue("eventLog", "record flow events to this binary log file", m_eventLog);
+    cmd.AddValue("recordTraffic", "record the packets sent by the applications", m_recordTraffic);
+    cmd.AddValue("replayTraffic",
+                 "replay recorded packets instead of the scenario's applications",
+                 m_replayTraffic);
+
+    bool fastExit = false;
+    bool verifyExit = false;
+    cmd.AddValue("fastExit", "exit without Simulator::Destroy once outputs are flushed", fastExit);
+    cmd.AddValue("verifyExit", "with fastExit, check that no trace output was lost", verifyExit);
+
+    std::string resultCache;
+    bool forceRerun = false;
+    cmd.AddValue("resultCache",
+                 "directory of stored runs: a run with the same configuration is replayed",
+                 resultCache);
+    cmd.AddValue("forceRerun",
+                 "with resultCache, run and store even if already stored",
+                 forceRerun);
 
     cmd.Parse(argc, argv);
+    // the sinks abort on a packet without a LatencyTag
+    NS_ABORT_MSG_IF(m_latency && !m_replayTraffic.empty(),
+                    "--latency needs the scenario's applications: "
+                    "replayed packets are not stamped");
+    if (m_partitions > 0)
+    {
+        // every partition would write its own part of these, or stop on its own
+        NS_ABORT_MSG_IF(m_enableMobility, "--partitions needs nodes that do not move");
+        NS_ABORT_MSG_IF(m_enableTracing || m_enablePcap || m_enableFlowMon,
+                        "--partitions needs --enableTracing=0, and no pcap or FlowMonitor");
+        NS_ABORT_MSG_IF(!m_eventLog.empty() || !m_recordTraffic.empty() ||
+                            m_memoryReport >= 0 || m_steadyState > 0 || m_fibCache,
+                        "--partitions does not support --eventLog, --recordTraffic, "
+                        "--memoryReport, --steadyState or --fibCache");
+        // the frames are posted to the partitions by BatchedYansWifiPhy
+        m_deliveryQuantum = std::max(m_deliveryQuantum, 0.0);
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::SharedMemorySimulatorImpl"));
+        Config::SetDefault("ns3::SharedMemorySimulatorImpl::Partitions",
+                           UintegerValue(m_partitions));
+    }
+    FastExit::Enable(fastExit, verifyExit);
+    // pcap files are named after each device and not stored
+    g_resultCache.Enable(m_enablePcap ? "" : resultCache, forceRerun);
+    g_resultCache.SetArguments(argc, argv);
+    if (!m_replayTraffic.empty())
+    {
+        g_resultCache.AddInput(m_replayTraffic);
+    }
     return true;
 }
 
 int
 main(int argc, char* argv[])
 {
+    StartupProbe::Main();
     Experiment experiment;
     experiment = Experiment("multirate");
 
     // for commandline input
     experiment.CommandSetup(argc, argv);
 
+    if (g_resultCache.Begin())
+    {
+        return 0;
+    }
+
     std::ofstream outfile(experiment.GetOutputFileName() + ".plt");
+    FastExit::Register(&outfile, experiment.GetOutputFileName() + ".plt");
+    g_resultCache.AddOutput(experiment.GetOutputFileName() + ".plt");
 
     MobilityHelper mobility;
     Gnuplot gnuplot;
@@ -728,5 +1365,7 @@ main(int argc, char* argv[])
     gnuplot.AddDataset(dataset);
     gnuplot.GenerateOutput(outfile);
 
-    return 0;
+    FastExit::Flush();
+    g_resultCache.End();
+    return FastExit::Finish(0);
 }
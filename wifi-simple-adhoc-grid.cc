@@ -61,6 +61,19 @@
 // ./ns3 run "wifi-simple-adhoc-grid --tracing=1"
 // grep ^t wifi-simple-adhoc-grid.tr  | grep Udp | grep -v olsr | less
 //
+// The same selection can be made while tracing, so that only the kept
+// events are formatted and written (see filtered-ascii-trace.h for the
+// event, node, protocol and time window settings):
+//
+// ./ns3 run "wifi-simple-adhoc-grid --tracing=1 --traceFilter=events=t;protocols=udp;exclude=olsr"
+// less wifi-simple-adhoc-grid.tr
+//
+// To ask several such questions of a large trace, ingest it once into an
+// indexed store and query that instead (see trace-store.cc):
+//
+// ./ns3 run "trace-store --ingest=wifi-simple-adhoc-grid.tr --store=grid.trs"
+// ./ns3 run "trace-store --store=grid.trs --query=journey --src=10.1.1.25 --dst=10.1.1.1"
+//
 // By changing the distance to a smaller value, more nodes can be reached
 // by each transmission, and the number of forwarding hops will decrease.
 //
@@ -84,7 +97,40 @@
 // or you can examine the text-based trace wifi-simple-adhoc-grid.tr with
 // an editor.
 //
+// The routing tables and neighbor caches are printed in full every 2 s to
+// wifi-simple-adhoc-grid.routes and .neighbors.  On large grids, log only
+// the entries that changed, and rebuild the tables at any time offline:
+//
+// ./ns3 run "wifi-simple-adhoc-grid --tracing=1 --tableLog=1"
+// ./ns3 run "table-change-log-rebuild --input=wifi-simple-adhoc-grid.routes --time=10"
+//
+// Per-packet send/receive messages are cheap to keep for larger runs by
+// recording them to a binary event log, which is formatted offline:
+//
+// ./ns3 run "wifi-simple-adhoc-grid --eventLog=wifi-simple-adhoc-grid.evlog"
+// ./ns3 run "binary-event-log-decode --input=wifi-simple-adhoc-grid.evlog"
+//
+// Every frame reaches each PHY in range through its own event; the HELLO
+// broadcasts of OLSR make most of them.  Receivers at equal propagation
+// delay, exact or rounded down to a quantum, can share one event instead
+// (see batched-yans-wifi-phy.h):
+//
+// ./ns3 run "wifi-simple-adhoc-grid --eventStats=1 --deliveryQuantum=0"
+//
+// The end-to-end delay quantiles and the jitter of the packets received are
+// reported with --latency (see latency-histogram.h):
+//
+// ./ns3 run "wifi-simple-adhoc-grid --latency=1 --numPackets=200 --interval=0.01"
+//
  
+#include "batched-yans-wifi-phy.h"
+#include "binary-event-log.h"
+#include "fast-exit.h"
+#include "fib-cache.h"
+#include "filtered-ascii-trace.h"
+#include "latency-histogram.h"
+#include "table-change-log.h"
+
 #include "ns3/command-line.h"
 #include "ns3/config.h"
 #include "ns3/double.h"
@@ -100,17 +146,36 @@
 #include "ns3/uinteger.h"
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/yans-wifi-helper.h"
+
+#include <chrono>
  
 using namespace ns3;
  
 NS_LOG_COMPONENT_DEFINE("WifiSimpleAdhocGrid");
+
+BinaryEventLog g_eventLog; //!< Per-run binary event log, enabled with --eventLog
+uint16_t g_rxEvent = g_eventLog.RegisterFormat("node {} received one packet of {} bytes");
+uint16_t g_txEvent = g_eventLog.RegisterFormat("node {} sent one packet of {} bytes");
+Ptr<LatencyRecorder> g_latency; //!< End-to-end delay and jitter, enabled with --latency
  
 void
 ReceivePacket(Ptr<Socket> socket)
 {
-    while (socket->Recv())
+    Ptr<Packet> packet;
+    while ((packet = socket->Recv()))
     {
-        NS_LOG_UNCOND("Received one packet!");
+        if (g_latency)
+        {
+            g_latency->Receive(packet);
+        }
+        if (g_eventLog.IsEnabled())
+        {
+            g_eventLog.Record(g_rxEvent, socket->GetNode()->GetId(), packet->GetSize());
+        }
+        else
+        {
+            NS_LOG_UNCOND("Received one packet!");
+        }
     }
 }
  
@@ -119,7 +184,13 @@ GenerateTraffic(Ptr<Socket> socket, uint32_t pktSize, uint32_t pktCount, Time pk
 {
     if (pktCount > 0)
     {
-        socket->Send(Create<Packet>(pktSize));
+        Ptr<Packet> packet = Create<Packet>(pktSize);
+        if (g_latency)
+        {
+            LatencyRecorder::Stamp(0, packet);
+        }
+        socket->Send(packet);
+        g_eventLog.Record(g_txEvent, socket->GetNode()->GetId(), pktSize);
         Simulator::Schedule(pktInterval,
                             &GenerateTraffic,
                             socket,
@@ -146,6 +217,16 @@ main(int argc, char* argv[])
     double interval = 0; // seconds
     bool verbose = false;
     bool tracing = true;
+    std::string eventLog;
+    bool eventStats = false;
+    double deliveryQuantum = -1;
+    bool pcap = true;
+    bool fastExit = false;
+    bool verifyExit = false;
+    bool fibCache = false;
+    std::string traceFilter;
+    bool tableLog = false;
+    bool latency = false;
  
     CommandLine cmd(__FILE__);
     cmd.AddValue("phyMode", "Wifi Phy mode", phyMode);
@@ -158,9 +239,31 @@ main(int argc, char* argv[])
     cmd.AddValue("numNodes", "number of nodes", numNodes);
     cmd.AddValue("sinkNode", "Receiver node number", sinkNode);
     cmd.AddValue("sourceNode", "Sender node number", sourceNode);
+    cmd.AddValue("eventLog", "record packet events to this binary log file", eventLog);
+    cmd.AddValue("eventStats", "report executed events and wall-clock time", eventStats);
+    cmd.AddValue("deliveryQuantum",
+                 "group receivers at equal delays (ns), 0 exact, -1 for one event each",
+                 deliveryQuantum);
+    cmd.AddValue("pcap", "with tracing, also write pcap traces", pcap);
+    cmd.AddValue("fastExit", "exit without Simulator::Destroy once outputs are flushed", fastExit);
+    cmd.AddValue("verifyExit", "with fastExit, check that no trace output was lost", verifyExit);
+    cmd.AddValue("fibCache", "cache forwarding decisions in front of the routing", fibCache);
+    cmd.AddValue("traceFilter", "with tracing, ascii trace events to keep", traceFilter);
+    cmd.AddValue("tableLog", "with tracing, log table changes instead of full tables", tableLog);
+    cmd.AddValue("latency", "report end-to-end delay quantiles and jitter", latency);
     cmd.Parse(argc, argv);
     // Convert to time object
     Time interPacketInterval = Seconds(interval);
+    FastExit::Enable(fastExit, verifyExit);
+
+    if (!eventLog.empty())
+    {
+        g_eventLog.Open(eventLog);
+    }
+    if (latency)
+    {
+        g_latency = Create<LatencyRecorder>();
+    }
  
     // Fix non-unicast data rate to be the same as that of unicast
     Config::SetDefault("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue(phyMode));
@@ -184,6 +287,10 @@ main(int argc, char* argv[])
     YansWifiChannelHelper wifiChannel;
     wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
     wifiChannel.AddPropagationLoss("ns3::FriisPropagationLossModel");
+    if (deliveryQuantum >= 0)
+    {
+        wifiPhy = BatchedYansWifiPhyHelper(wifiPhy, NanoSeconds(deliveryQuantum));
+    }
     wifiPhy.SetChannel(wifiChannel.Create());
  
     // Add an upper mac and disable rate control
@@ -222,6 +329,10 @@ main(int argc, char* argv[])
     Ipv4ListRoutingHelper list;
     list.Add(staticRouting, 0);
     list.Add(olsr, 10);
+    if (fibCache)
+    {
+        FibCacheHelper::Install(list);
+    }
  
     InternetStackHelper internet;
     internet.SetRoutingHelper(list); // has effect on the next Install ()
@@ -242,18 +353,47 @@ main(int argc, char* argv[])
     InetSocketAddress remote = InetSocketAddress(i.GetAddress(sinkNode, 0), 80);
     source->Connect(remote);
  
+    Ptr<TableChangeLog> routeLog;
+    Ptr<TableChangeLog> neighborLog;
     if (tracing)
     {
         AsciiTraceHelper ascii;
-        wifiPhy.EnableAsciiAll(ascii.CreateFileStream("wifi-simple-adhoc-grid.tr"));
-        wifiPhy.EnablePcap("wifi-simple-adhoc-grid", devices);
+        Ptr<OutputStreamWrapper> asciiStream = ascii.CreateFileStream("wifi-simple-adhoc-grid.tr");
+        FastExit::Register(asciiStream, "wifi-simple-adhoc-grid.tr");
+        if (traceFilter.empty())
+        {
+            wifiPhy.EnableAsciiAll(asciiStream);
+        }
+        else
+        {
+            // filtered before formatting instead of after writing everything
+            Create<FilteredAsciiTrace>(asciiStream, traceFilter)->Enable(devices);
+        }
+        if (pcap)
+        {
+            wifiPhy.EnablePcap("wifi-simple-adhoc-grid", devices);
+            // the pcap files are only flushed when their writers are disposed
+            FastExit::RequireDestroy();
+        }
         // Trace routing tables
         Ptr<OutputStreamWrapper> routingStream =
             Create<OutputStreamWrapper>("wifi-simple-adhoc-grid.routes", std::ios::out);
-        Ipv4RoutingHelper::PrintRoutingTableAllEvery(Seconds(2), routingStream);
+        FastExit::Register(routingStream, "wifi-simple-adhoc-grid.routes");
         Ptr<OutputStreamWrapper> neighborStream =
             Create<OutputStreamWrapper>("wifi-simple-adhoc-grid.neighbors", std::ios::out);
-        Ipv4RoutingHelper::PrintNeighborCacheAllEvery(Seconds(2), neighborStream);
+        FastExit::Register(neighborStream, "wifi-simple-adhoc-grid.neighbors");
+        if (tableLog)
+        {
+            routeLog = Create<TableChangeLog>(TableChangeLog::ROUTES, routingStream);
+            routeLog->Start(c, Seconds(2));
+            neighborLog = Create<TableChangeLog>(TableChangeLog::NEIGHBORS, neighborStream);
+            neighborLog->Start(c, Seconds(2));
+        }
+        else
+        {
+            Ipv4RoutingHelper::PrintRoutingTableAllEvery(Seconds(2), routingStream);
+            Ipv4RoutingHelper::PrintNeighborCacheAllEvery(Seconds(2), neighborStream);
+        }
  
         // To do-- enable an IP-level trace that shows forwarding events only
     }
@@ -271,8 +411,23 @@ main(int argc, char* argv[])
                                        << distance);
  
     Simulator::Stop(Seconds(33.0));
+    auto wallStart = std::chrono::steady_clock::now();
     Simulator::Run();
-    Simulator::Destroy();
- 
-    return 0;
+    g_eventLog.Close();
+    if (eventStats)
+    {
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart)
+                          .count();
+        NS_LOG_UNCOND("Events executed: " << Simulator::GetEventCount() << " in " << wall
+                                          << " s wall-clock time");
+    }
+    if (latency)
+    {
+        g_latency->Print(std::cout);
+    }
+    if (fibCache)
+    {
+        FibCacheHelper::PrintStatistics(std::cout, c);
+    }
+    return FastExit::Finish(0);
 }
@@ -31,6 +31,9 @@
  * of TCP i.e. congestion control algorithm to use.
  */
 
+#include "compact-minstrel-wifi-manager.h"
+#include "timer-wheel.h"
+
 #include "ns3/command-line.h"
 #include "ns3/config.h"
 #include "ns3/internet-stack-helper.h"
@@ -54,8 +57,9 @@ NS_LOG_COMPONENT_DEFINE("wifi-tcp");
 
 using namespace ns3;
 
-Ptr<PacketSink> sink;     //!< Pointer to the packet sink application
-uint64_t lastTotalRx = 0; //!< The value of the last total received bytes
+Ptr<PacketSink> sink;          //!< Pointer to the packet sink application
+uint64_t lastTotalRx = 0;      //!< The value of the last total received bytes
+PeriodicTimer throughputTimer; //!< Throughput sampling timer
 
 /**
  * Calculate the throughput
@@ -68,7 +72,6 @@ CalculateThroughput(double sampleInterval)
                  (sampleInterval * 1e3); /* Convert Application RX Packets to MBits. */
     std::cout << now.GetSeconds() << "s: \t" << cur << " Mbit/s" << std::endl;
     lastTotalRx = sink->GetTotalRx();
-    Simulator::Schedule(MilliSeconds(sampleInterval), &CalculateThroughput, sampleInterval);
 }
 
 int
@@ -79,6 +82,7 @@ main(int argc, char* argv[])
     std::string dataRate = "100Mbps";      /* Application layer datarate. */
     std::string tcpVariant = "TcpNewReno"; /* TCP variant type. */
     std::string phyRate = "HtMcs7";        /* Physical layer bitrate. */
+    std::string rateManager = "ns3::MinstrelWifiManager"; /* Rate manager. */
     double simulationTime = 10;            /* Simulation time in seconds. */
     double startMeasureTime = 5;            /* Simulation time in seconds. */   
     double sampleInterval = 100;            /* Simulation time in milliseconds. */
@@ -97,6 +101,7 @@ main(int argc, char* argv[])
                  "TcpBic, TcpYeah, TcpIllinois, TcpWestwood, TcpWestwoodPlus, TcpLedbat ",
                  tcpVariant);
     cmd.AddValue("phyRate", "Physical layer bitrate", phyRate);
+    cmd.AddValue("rateManager", "Rate manager", rateManager);
     cmd.AddValue("simulationTime", "Simulation time in seconds", simulationTime);
     cmd.AddValue("startMeasureTime", "Start measure time in seconds", startMeasureTime);
     cmd.AddValue("sampleInterval", "Sample interval time in milliseconds", sampleInterval);
@@ -140,7 +145,7 @@ main(int argc, char* argv[])
     //                                    StringValue(phyMode));
 
     
-    wifiHelper.SetRemoteStationManager("ns3::MinstrelWifiManager");
+    wifiHelper.SetRemoteStationManager(rateManager);
     
     // wifiHelper.SetRemoteStationManager("ns3::ConstantRateWifiManager",
     //                                    "DataMode",
@@ -257,7 +262,9 @@ main(int argc, char* argv[])
     /* Start Applications */
     sinkApp.Start(Seconds(0.0));
     serverApp.Start(Seconds(startMeasureTime - sampleInterval/1000));
-    Simulator::Schedule(Seconds(startMeasureTime), &CalculateThroughput, sampleInterval);
+    throughputTimer.SetFunction(&CalculateThroughput, sampleInterval);
+    throughputTimer.SetPeriod(MilliSeconds(sampleInterval));
+    throughputTimer.Start(Seconds(startMeasureTime));
 
     /* Enable Traces */
     if (pcapTracing)
@@ -16,24 +16,89 @@
  *
  * Author: Hany Assasa <hany.assasa@gmail.com>
 .*
- * This is a simple example to test TCP over 802.11n (with MPDU aggregation enabled).
+ * This is a simple example to test UDP over a multi-hop 802.11 chain,
+ * either legacy 802.11a with Minstrel or 802.11n/ac/ax with MPDU aggregation.
  *
  * Network topology:
  *
- *   Ap    STA
- *   *      *
- *   |      |
- *   n1     n2
+ *   sink            source
+ *   *      *      *
+ *   |      |      |
+ *   n0     n1 ... nN-1
  *
- * In this example, an HT station sends TCP packets to the access point.
+ * The last node of the chain sends UDP packets to the first one, each hop
+ * forwarding over static host routes.
  * We report the total throughput received during a window of 100ms.
- * The user can specify the application data rate and choose the variant
- * of TCP i.e. congestion control algorithm to use.
+ * The user can specify the application data rate.
+ *
+ * High-throughput mode (--standard=80211n, 80211ac or 80211ax) uses a constant
+ * rate given by --phyRate and lets the user choose the A-MPDU and A-MSDU sizes,
+ * the block ack settings, the channel width and the guard interval:
+ *
+ * ./ns3 run "wifi-udp-stream --standard=80211ac --phyRate=VhtMcs7 --channelWidth=80
+ *            --maxAmpduSize=65535 --maxAmsduSize=7935"
+ *
+ * With --sweep=1 every combination of aggregation sizes, channel widths and
+ * guard intervals valid for the standard is run in turn and the goodput and
+ * MAC efficiency (goodput over the nominal PHY rate) of each is reported.
+ *
+ * With --resultCache=<dir> every run, or every point of a sweep, is stored
+ * under a hash of its whole configuration (arguments, attribute defaults,
+ * global values, binary), and an identical run later replays the stored
+ * result instead of simulating; --forceRerun=1 runs and stores it again.
+ *
+ * With --steadyState=<precision> the throughput samples feed a steady-state
+ * detector (see steady-state-detector.h): the run stops as soon as the
+ * warm-up is over and the confidence interval of the mean throughput is
+ * narrower than the given fraction of the mean, and the average throughput
+ * is the steady-state mean.  --simulationTime is then only an upper bound,
+ * and --startMeasureTime can be short since the warm-up is truncated:
+ *
+ * ./ns3 run "wifi-udp-stream --steadyState=0.02 --startMeasureTime=0.5 --simulationTime=60"
+ *
+ * With --replications=<n> every run is repeated with the run numbers RngRun
+ * to RngRun + n - 1 and the mean goodput is reported; --jobs=<n> runs up to
+ * n replications or sweep points at once, each in a worker forked once the
+ * configuration is parsed (see replication-pool.h):
+ *
+ * ./ns3 run "wifi-udp-stream --replications=16 --jobs=8"
+ *
+ * With --burstSize=<n> the source sends its packets n at a time with a
+ * token-bucket credit that keeps the rate exact (see burst-sender.h),
+ * instead of one application event per packet.  --eventStats=1 reports the
+ * events executed, the wall-clock time and the mean and maximum occupancy of
+ * the MAC queue of the source, to compare the two:
+ *
+ * ./ns3 run "wifi-udp-stream --eventStats=1"
+ * ./ns3 run "wifi-udp-stream --eventStats=1 --burstSize=16"
+ *
+ * --latency=1 stamps the packets of the source and reports the p50, p99 and
+ * p99.9 end-to-end delay and the jitter at the sink from log-linear
+ * histograms (see latency-histogram.h), merged over the replications:
+ *
+ * ./ns3 run "wifi-udp-stream --latency=1 --replications=8 --jobs=4"
+ *
+ * In legacy mode --rateManager selects the rate control, Minstrel by default;
+ * ns3::CompactMinstrelWifiManager runs the same algorithm over per-device
+ * tables (see compact-minstrel-wifi-manager.h).
  */
 
+#include "burst-sender.h"
+#include "compact-minstrel-wifi-manager.h"
+#include "config-index.h"
+#include "latency-histogram.h"
+#include "replication-pool.h"
+#include "result-cache.h"
+#include "startup-probe.h"
+#include "steady-state-detector.h"
+#include "timer-wheel.h"
+
+#include "ns3/boolean.h"
 #include "ns3/command-line.h"
 #include "ns3/config.h"
+#include "ns3/double.h"
 #include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-generator.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-list-routing-helper.h"
 #include "ns3/ipv4-static-routing-helper.h"
@@ -44,18 +109,82 @@
 #include "ns3/on-off-helper.h"
 #include "ns3/packet-sink-helper.h"
 #include "ns3/packet-sink.h"
+#include "ns3/rng-seed-manager.h"
 #include "ns3/ssid.h"
 #include "ns3/string.h"
-#include "ns3/tcp-westwood-plus.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/wifi-net-device.h"
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/yans-wifi-helper.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
 NS_LOG_COMPONENT_DEFINE("wifi-tcp");
 
 using namespace ns3;
 
-Ptr<PacketSink> sink;     //!< Pointer to the packet sink application
-uint64_t lastTotalRx = 0; //!< The value of the last total received bytes
+Ptr<PacketSink> sink;            //!< Pointer to the packet sink application
+uint64_t lastTotalRx = 0;        //!< The value of the last total received bytes
+bool printSamples = true;        //!< Print the throughput of every sample interval
+ConfigIndex configIndex;         //!< Index of the objects of the current run
+PeriodicTimer throughputTimer;   //!< Throughput sampling timer
+SteadyStateDetector steadyState; //!< Stops a run once its throughput is known precisely
+uint32_t burstSize = 0;          //!< Packets per sender timer expiration, 0 for OnOff
+bool eventStats = false;         //!< Report events, wall time and source queue of each run
+bool latency = false;            //!< Record the end-to-end delay and jitter
+Ptr<LatencyRecorder> latencies;  //!< Delay and jitter of the current run
+
+/**
+ * MAC and PHY settings of one run.
+ */
+struct WifiConfig
+{
+    std::string standard;               //!< 80211a, 80211n, 80211ac or 80211ax
+    std::string phyRate;                //!< Data mode used in high-throughput mode
+    std::string rateManager;            //!< Rate manager in legacy mode
+    uint16_t channelWidth;              //!< Channel width in MHz
+    uint16_t guardInterval;             //!< Guard interval in nanoseconds
+    uint32_t maxAmpduSize;              //!< Maximum A-MPDU size in bytes, 0 to disable
+    uint32_t maxAmsduSize;              //!< Maximum A-MSDU size in bytes, 0 to disable
+    uint32_t blockAckThreshold;         //!< Number of queued packets to set up a block ack
+    uint32_t blockAckInactivityTimeout; //!< Block ack inactivity timeout (1024 us units)
+};
+
+/**
+ * Time-weighted occupancy of the MAC queue of the source.
+ */
+struct QueueOccupancy
+{
+    Time lastChange;     //!< Time of the last change
+    uint32_t packets{0}; //!< Packets queued
+    uint32_t max{0};     //!< Largest number of packets queued
+    double area{0};      //!< Packets queued integrated over time (packet seconds)
+};
+
+QueueOccupancy sourceQueue; //!< Occupancy of the MAC queue of the source
+
+/**
+ * Track the occupancy of the MAC queue of the source.
+ *
+ * \param oldValue The previous number of packets.
+ * \param newValue The new number of packets.
+ */
+void
+SourceQueueChanged(uint32_t oldValue, uint32_t newValue)
+{
+    Time now = Simulator::Now();
+    sourceQueue.area += sourceQueue.packets * (now - sourceQueue.lastChange).GetSeconds();
+    sourceQueue.lastChange = now;
+    sourceQueue.packets = newValue;
+    sourceQueue.max = std::max(sourceQueue.max, newValue);
+}
 
 /**
  * Calculate the throughput
@@ -66,50 +195,73 @@ CalculateThroughput(double sampleInterval)
     Time now = Simulator::Now(); /* Return the simulator's virtual time. */
     double cur = (sink->GetTotalRx() - lastTotalRx) * 8.0 /
                  (sampleInterval * 1e3); /* Convert Application RX Packets to MBits. */
-    std::cout << now.GetSeconds() << "s: \t" << cur << " Mbit/s" << std::endl;
+    if (printSamples)
+    {
+        std::cout << now.GetSeconds() << "s: \t" << cur << " Mbit/s" << std::endl;
+    }
     lastTotalRx = sink->GetTotalRx();
-    Simulator::Schedule(MilliSeconds(sampleInterval), &CalculateThroughput, sampleInterval);
+    if (steadyState.AddSample(cur))
+    {
+        Simulator::Stop();
+    }
 }
 
-int
-main(int argc, char* argv[])
+/**
+ * \param config The run settings.
+ * \return true if the standard supports HT or later features.
+ */
+static bool
+IsHighThroughput(const WifiConfig& config)
 {
-    std::string phyMode("DsssRate1Mbps");
-    uint32_t payloadSize = 1472;           /* Transport layer payload size in bytes. */
-    std::string dataRate = "100Mbps";      /* Application layer datarate. */
-    std::string tcpVariant = "TcpNewReno"; /* TCP variant type. */
-    std::string phyRate = "HtMcs7";        /* Physical layer bitrate. */
-    double simulationTime = 10;            /* Simulation time in seconds. */
-    double startMeasureTime = 5;            /* Simulation time in seconds. */   
-    double sampleInterval = 100;            /* Simulation time in milliseconds. */
-    bool pcapTracing = false;              /* PCAP Tracing is enabled or not. */
-    uint32_t numNodes = 3;
-    double distance = 100;      // m
+    return config.standard != "80211a";
+}
 
-    /* Command line argument parser setup. */
-    CommandLine cmd(__FILE__);
-    cmd.AddValue("phyMode", "Wifi Phy mode", phyMode);
-    cmd.AddValue("payloadSize", "Payload size in bytes", payloadSize);
-    cmd.AddValue("dataRate", "Application data rate", dataRate);
-    cmd.AddValue("tcpVariant",
-                 "Transport protocol to use: TcpNewReno, "
-                 "TcpHybla, TcpHighSpeed, TcpHtcp, TcpVegas, TcpScalable, TcpVeno, "
-                 "TcpBic, TcpYeah, TcpIllinois, TcpWestwood, TcpWestwoodPlus, TcpLedbat ",
-                 tcpVariant);
-    cmd.AddValue("phyRate", "Physical layer bitrate", phyRate);
-    cmd.AddValue("simulationTime", "Simulation time in seconds", simulationTime);
-    cmd.AddValue("startMeasureTime", "Start measure time in seconds", startMeasureTime);
-    cmd.AddValue("sampleInterval", "Sample interval time in milliseconds", sampleInterval);
-    cmd.AddValue("pcap", "Enable/disable PCAP Tracing", pcapTracing);
-    cmd.AddValue("numNodes", "number of nodes", numNodes);
-    cmd.AddValue("distance", "distance (m)", distance);
-    cmd.Parse(argc, argv););
+/**
+ * \param config The run settings.
+ * \return the nominal PHY rate in Mbit/s, or 0 if the rate is chosen by a rate manager.
+ */
+static double
+GetNominalPhyRate(const WifiConfig& config)
+{
+    if (!IsHighThroughput(config))
+    {
+        return 0;
+    }
+    WifiMode mode(config.phyRate);
+    return mode.GetDataRate(config.channelWidth, config.guardInterval, 1) / 1e6;
+}
+
+/**
+ * Set up the chain, run one simulation and tear it down.
+ *
+ * \param config The MAC and PHY settings.
+ * \param numNodes Number of nodes in the chain.
+ * \param distance Distance between neighbors (m).
+ * \param payloadSize UDP payload size in bytes.
+ * \param dataRate Application data rate.
+ * \param startMeasureTime Time at which the throughput measurement starts (s).
+ * \param simulationTime Length of the measurement (s).
+ * \param sampleInterval Throughput sample interval (ms).
+ * \param pcapTracing Whether to write pcap traces.
+ * \return the average goodput in Mbit/s over the measurement.
+ */
+static double
+RunScenario(const WifiConfig& config,
+            uint32_t numNodes,
+            double distance,
+            uint32_t payloadSize,
+            const std::string& dataRate,
+            double startMeasureTime,
+            double simulationTime,
+            double sampleInterval,
+            bool pcapTracing)
+{
+    lastTotalRx = 0;
+    steadyState.Reset();
+    Ipv4AddressGenerator::Reset();
 
-    // /* Configure TCP Options */
     WifiMacHelper wifiMac;
     WifiHelper wifiHelper;
-    // wifiHelper.SetStandard(WIFI_STANDARD_80211n);
-    wifiHelper.SetStandard(WIFI_STANDARD_80211a);
 
     /* Set up Legacy Channel */
     YansWifiChannelHelper wifiChannel;
@@ -121,81 +273,177 @@ main(int argc, char* argv[])
     wifiPhy.Set("RxGain", DoubleValue(-10));
     wifiPhy.SetChannel(wifiChannel.Create());
     wifiPhy.SetErrorRateModel("ns3::YansErrorRateModel");
-    
-    wifiHelper.SetRemoteStationManager("ns3::MinstrelWifiManager");
+
+    // /* Configure AP */
+    Ssid ssid = Ssid("network");
+
+    if (IsHighThroughput(config))
+    {
+        std::string controlMode;
+        if (config.standard == "80211n")
+        {
+            wifiHelper.SetStandard(WIFI_STANDARD_80211n);
+            controlMode = "HtMcs0";
+        }
+        else if (config.standard == "80211ac")
+        {
+            wifiHelper.SetStandard(WIFI_STANDARD_80211ac);
+            controlMode = "VhtMcs0";
+        }
+        else if (config.standard == "80211ax")
+        {
+            wifiHelper.SetStandard(WIFI_STANDARD_80211ax);
+            controlMode = "HeMcs0";
+        }
+        else
+        {
+            NS_FATAL_ERROR("Unsupported standard " << config.standard);
+        }
+        NS_ABORT_MSG_UNLESS(config.phyRate.compare(0,
+                                                   controlMode.size() - 1,
+                                                   controlMode,
+                                                   0,
+                                                   controlMode.size() - 1) == 0,
+                            "phyRate " << config.phyRate << " does not match standard "
+                                       << config.standard);
+
+        std::ostringstream channelSettings;
+        channelSettings << "{0, " << config.channelWidth << ", BAND_5GHZ, 0}";
+        wifiPhy.Set("ChannelSettings", StringValue(channelSettings.str()));
+
+        wifiHelper.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                           "DataMode",
+                                           StringValue(config.phyRate),
+                                           "ControlMode",
+                                           StringValue(controlMode));
+
+        /* Configure STA */
+        wifiMac.SetType("ns3::AdhocWifiMac",
+                        "Ssid",
+                        SsidValue(ssid),
+                        "QosSupported",
+                        BooleanValue(true),
+                        "BE_MaxAmpduSize",
+                        UintegerValue(config.maxAmpduSize),
+                        "BE_MaxAmsduSize",
+                        UintegerValue(config.maxAmsduSize),
+                        "BE_BlockAckThreshold",
+                        UintegerValue(config.blockAckThreshold),
+                        "BE_BlockAckInactivityTimeout",
+                        UintegerValue(config.blockAckInactivityTimeout));
+    }
+    else
+    {
+        wifiHelper.SetStandard(WIFI_STANDARD_80211a);
+        wifiHelper.SetRemoteStationManager(config.rateManager);
+
+        /* Configure STA */
+        wifiMac.SetType("ns3::AdhocWifiMac", "Ssid", SsidValue(ssid));
+    }
 
     NodeContainer networkNodes;
     networkNodes.Create(numNodes);
-    
+
     Ptr<Node> sinkNode = networkNodes.Get(0);
     Ptr<Node> sourceNode = networkNodes.Get(numNodes - 1);
 
-    // /* Configure AP */
-    Ssid ssid = Ssid("network");
-
-    /* Configure STA */
-    wifiMac.SetType("ns3::AdhocWifiMac", "Ssid", SsidValue(ssid));
     NetDeviceContainer devices;
     devices = wifiHelper.Install(wifiPhy, wifiMac, networkNodes);
 
+    if (config.standard == "80211n" || config.standard == "80211ac")
+    {
+        configIndex.Set("ns3::HtConfiguration",
+                        "ShortGuardIntervalSupported",
+                        BooleanValue(config.guardInterval == 400));
+    }
+    else if (config.standard == "80211ax")
+    {
+        configIndex.Set("ns3::HeConfiguration",
+                        "GuardInterval",
+                        TimeValue(NanoSeconds(config.guardInterval)));
+    }
+
     /* Mobility model */
     MobilityHelper mobility;
     Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
-    // positionAlloc->Add(Vector(0.0, 0.0, 0.0));
-    // positionAlloc->Add(Vector(distance, 0.0, 0.0));
-    // positionAlloc->Add(Vector(2 * distance, 0.0, 0.0));
-    for (int i = 0; i < numNodes; i++) {
+    for (uint32_t i = 0; i < numNodes; i++)
+    {
         positionAlloc->Add(Vector(i * distance, 0.0, 0.0));
     }
     mobility.SetPositionAllocator(positionAlloc);
     mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
     mobility.Install(networkNodes);
 
-    // Enable OLSR
-    // OlsrHelper olsr;
-    // Ipv4StaticRoutingHelper staticRouting;
- 
-    // Ipv4ListRoutingHelper list;
-    // list.Add(staticRouting, 0);
-    // list.Add(olsr, 10);
-
     /* Internet stack */
-    // InternetStackHelper stack;
-    // stack.SetRoutingHelper(list); // has effect on the next Install ()
-    // stack.Install(networkNodes);
+    InternetStackHelper stack;
+    stack.Install(networkNodes);
 
     Ipv4AddressHelper address;
     NS_LOG_INFO("Assign IP Addresses.");
     address.SetBase("10.0.0.0", "255.255.255.0");
     Ipv4InterfaceContainer interfaces;
     interfaces = address.Assign(devices);
-    
-    for (int i = 1; i < numNodes; i++) {
-        Ipv4StaticRoutingHelper ipv4RoutingHelper;
-        // Create static routes from A to C
-        Ptr<Ipv4StaticRouting> staticRouting = ipv4RoutingHelper.GetStaticRouting(interfaces.GetAddress(i));
-        staticRouting->AddHostRouteTo(Ipv4Address("10.0.0.1"), Ipv4Address("10.0.0." + i), i);
-    }
-    
+
+    // Each node reaches the sink through its neighbor closer to the sink
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    for (uint32_t i = 1; i < numNodes; i++)
+    {
+        Ptr<Ipv4StaticRouting> staticRouting =
+            ipv4RoutingHelper.GetStaticRouting(networkNodes.Get(i)->GetObject<Ipv4>());
+        staticRouting->AddHostRouteTo(interfaces.GetAddress(0), interfaces.GetAddress(i - 1), 1);
+    }
+
     /* Install UDP Receiver on the access point */
     PacketSinkHelper sinkHelper("ns3::UdpSocketFactory",
                                 InetSocketAddress(Ipv4Address::GetAny(), 9));
     ApplicationContainer sinkApp = sinkHelper.Install(sinkNode);
     sink = StaticCast<PacketSink>(sinkApp.Get(0));
 
-    /* Install TCP/UDP Transmitter on the station */
-    TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
-    OnOffHelper server("ns3::UdpSocketFactory", (InetSocketAddress(interfaces.GetAddress(0), 9)));
-    server.SetAttribute("PacketSize", UintegerValue(payloadSize));
-    server.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1]"));
-    server.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0]"));
-    server.SetAttribute("DataRate", DataRateValue(DataRate(dataRate)));
-    ApplicationContainer serverApp = server.Install(sourceNode);
-    
+    /* Install UDP Transmitter on the station */
+    ApplicationContainer serverApp;
+    if (burstSize == 0)
+    {
+        OnOffHelper server("ns3::UdpSocketFactory",
+                           (InetSocketAddress(interfaces.GetAddress(0), 9)));
+        server.SetAttribute("PacketSize", UintegerValue(payloadSize));
+        server.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1]"));
+        server.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0]"));
+        server.SetAttribute("DataRate", DataRateValue(DataRate(dataRate)));
+        serverApp = server.Install(sourceNode);
+    }
+    else
+    {
+        BurstSenderHelper server("ns3::UdpSocketFactory",
+                                 InetSocketAddress(interfaces.GetAddress(0), 9));
+        server.SetAttribute("PacketSize", UintegerValue(payloadSize));
+        server.SetAttribute("DataRate", DataRateValue(DataRate(dataRate)));
+        server.SetAttribute("BurstSize", UintegerValue(burstSize));
+        serverApp = server.Install(sourceNode);
+    }
+
+    if (latency)
+    {
+        latencies = Create<LatencyRecorder>();
+        LatencyRecorder::EnableSource(serverApp.Get(0), 0);
+        latencies->EnableSink(sink);
+    }
+
+    if (eventStats)
+    {
+        sourceQueue = QueueOccupancy();
+        Ptr<WifiMac> mac = DynamicCast<WifiNetDevice>(devices.Get(numNodes - 1))->GetMac();
+        NS_ABORT_MSG_UNLESS(mac->GetTxopQueue(mac->GetQosSupported() ? AC_BE : AC_BE_NQOS)
+                                ->TraceConnectWithoutContext("PacketsInQueue",
+                                                             MakeCallback(&SourceQueueChanged)),
+                            "Cannot connect to PacketsInQueue of node " << numNodes - 1);
+    }
+
     /* Start Applications */
     sinkApp.Start(Seconds(0.0));
-    serverApp.Start(Seconds(startMeasureTime - sampleInterval/1000));
-    Simulator::Schedule(Seconds(startMeasureTime), &CalculateThroughput, sampleInterval);
+    serverApp.Start(Seconds(startMeasureTime - sampleInterval / 1000));
+    throughputTimer.SetFunction(&CalculateThroughput, sampleInterval);
+    throughputTimer.SetPeriod(MilliSeconds(sampleInterval));
+    throughputTimer.Start(Seconds(startMeasureTime));
 
     /* Enable Traces */
     if (pcapTracing)
@@ -206,12 +454,303 @@ main(int argc, char* argv[])
 
     /* Start Simulation */
     Simulator::Stop(Seconds(simulationTime + startMeasureTime));
+    auto wallStart = std::chrono::steady_clock::now();
+    StartupProbe::BeforeRun();
     Simulator::Run();
 
+    if (eventStats)
+    {
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart)
+                          .count();
+        // close the integral at the end of the run
+        SourceQueueChanged(sourceQueue.packets, sourceQueue.packets);
+        std::cout << "Events executed: " << Simulator::GetEventCount() << " in " << wall
+                  << " s wall-clock time" << std::endl;
+        std::cout << "Source MAC queue: mean "
+                  << sourceQueue.area / Simulator::Now().GetSeconds() << " packets, max "
+                  << sourceQueue.max << std::endl;
+    }
+
     double averageThroughput = ((sink->GetTotalRx() * 8) / (1e6 * (simulationTime)));
+    if (steadyState.IsEnabled())
+    {
+        if (printSamples)
+        {
+            steadyState.Print(std::cout, "Mbit/s");
+            std::cout << "Warm-up ends at "
+                      << startMeasureTime + steadyState.GetTruncation() * sampleInterval / 1000
+                      << "s" << std::endl;
+        }
+        if (steadyState.IsDone())
+        {
+            averageThroughput = steadyState.GetMean();
+        }
+    }
 
     Simulator::Destroy();
+    sink = nullptr;
+
+    return averageThroughput;
+}
+
+int
+main(int argc, char* argv[])
+{
+    StartupProbe::Main();
+    std::string phyMode("DsssRate1Mbps");
+    uint32_t payloadSize = 1472;           /* Transport layer payload size in bytes. */
+    std::string dataRate = "100Mbps";      /* Application layer datarate. */
+    std::string phyRate = "HtMcs7";        /* Physical layer bitrate. */
+    std::string rateManager = "ns3::MinstrelWifiManager"; /* Rate manager (legacy mode). */
+    double simulationTime = 10;            /* Simulation time in seconds. */
+    double startMeasureTime = 5;            /* Simulation time in seconds. */
+    double sampleInterval = 100;            /* Simulation time in milliseconds. */
+    bool pcapTracing = false;              /* PCAP Tracing is enabled or not. */
+    uint32_t numNodes = 3;
+    double distance = 100;      // m
+    std::string standard = "80211a";           /* 80211a, 80211n, 80211ac or 80211ax. */
+    uint16_t channelWidth = 20;                /* Channel width in MHz. */
+    uint16_t guardInterval = 800;              /* Guard interval in nanoseconds. */
+    uint32_t maxAmpduSize = 65535;             /* Maximum A-MPDU size in bytes. */
+    uint32_t maxAmsduSize = 0;                 /* Maximum A-MSDU size in bytes. */
+    uint32_t blockAckThreshold = 0;            /* Queued packets before a block ack. */
+    uint32_t blockAckInactivityTimeout = 0;    /* Block ack inactivity (1024 us units). */
+    bool sweep = false;                        /* Sweep the aggregation settings. */
+    std::string resultCache;                   /* Directory of stored runs. */
+    bool forceRerun = false;                   /* Run even if stored. */
+    double steadyStatePrecision = 0;           /* Relative precision, 0 for fixed time. */
+    uint32_t replications = 1;                 /* Runs of each point, RngRun + r. */
+    uint32_t jobs = 1;                         /* Runs in parallel. */
+
+    /* Command line argument parser setup. */
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("phyMode", "Wifi Phy mode", phyMode);
+    cmd.AddValue("payloadSize", "Payload size in bytes", payloadSize);
+    cmd.AddValue("dataRate", "Application data rate", dataRate);
+    cmd.AddValue("phyRate", "Physical layer bitrate (high-throughput mode)", phyRate);
+    cmd.AddValue("rateManager", "Rate manager (legacy mode)", rateManager);
+    cmd.AddValue("simulationTime", "Simulation time in seconds", simulationTime);
+    cmd.AddValue("startMeasureTime", "Start measure time in seconds", startMeasureTime);
+    cmd.AddValue("sampleInterval", "Sample interval time in milliseconds", sampleInterval);
+    cmd.AddValue("pcap", "Enable/disable PCAP Tracing", pcapTracing);
+    cmd.AddValue("numNodes", "number of nodes", numNodes);
+    cmd.AddValue("distance", "distance (m)", distance);
+    cmd.AddValue("standard", "Wifi standard: 80211a, 80211n, 80211ac or 80211ax", standard);
+    cmd.AddValue("channelWidth", "Channel width in MHz (high-throughput mode)", channelWidth);
+    cmd.AddValue("guardInterval",
+                 "Guard interval in ns: 400 or 800 for 802.11n/ac, 800, 1600 or 3200 for 802.11ax",
+                 guardInterval);
+    cmd.AddValue("maxAmpduSize", "Maximum A-MPDU size in bytes, 0 to disable", maxAmpduSize);
+    cmd.AddValue("maxAmsduSize", "Maximum A-MSDU size in bytes, 0 to disable", maxAmsduSize);
+    cmd.AddValue("blockAckThreshold",
+                 "Number of queued packets that triggers a block ack agreement",
+                 blockAckThreshold);
+    cmd.AddValue("blockAckInactivityTimeout",
+                 "Block ack inactivity timeout in units of 1024 us, 0 to disable",
+                 blockAckInactivityTimeout);
+    cmd.AddValue("sweep", "Sweep aggregation sizes, channel widths and guard intervals", sweep);
+    cmd.AddValue("resultCache",
+                 "Directory of stored runs: a run or sweep point already stored is replayed",
+                 resultCache);
+    cmd.AddValue("forceRerun", "Run and store even if already stored", forceRerun);
+    cmd.AddValue("steadyState",
+                 "Stop once the throughput confidence interval is within this fraction of "
+                 "the mean, 0 to disable",
+                 steadyStatePrecision);
+    cmd.AddValue("replications", "Runs of each point, with RngRun, RngRun + 1...", replications);
+    cmd.AddValue("jobs", "Runs in parallel, each in a forked worker", jobs);
+    cmd.AddValue("burstSize",
+                 "Packets sent per sender timer expiration, 0 for one event per packet",
+                 burstSize);
+    cmd.AddValue("eventStats",
+                 "Report events, wall-clock time and source MAC queue occupancy of each run",
+                 eventStats);
+    cmd.AddValue("latency",
+                 "Report end-to-end delay quantiles and jitter, merged over replications",
+                 latency);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(replications == 0, "--replications must be at least 1");
+    steadyState.Enable(steadyStatePrecision);
+
+    ResultCache cache;
+    // pcap files are named after each device and not stored
+    cache.Enable(pcapTracing ? "" : resultCache, forceRerun);
+    // each replication is keyed by its own RngRun, whatever the pool runs
+    cache.SetArguments(argc, argv, {"jobs", "replications"});
+
+    WifiConfig config{standard,
+                      phyRate,
+                      rateManager,
+                      channelWidth,
+                      guardInterval,
+                      maxAmpduSize,
+                      maxAmsduSize,
+                      blockAckThreshold,
+                      blockAckInactivityTimeout};
+
+    // the runs: the given settings, or every point of the sweep
+    std::vector<WifiConfig> points;
+    std::vector<std::string> pointNames;
+    if (!sweep)
+    {
+        points.push_back(config);
+        pointNames.emplace_back();
+    }
+    else
+    {
+        NS_ABORT_MSG_UNLESS(IsHighThroughput(config), "--sweep requires an 802.11n/ac/ax standard");
+
+        std::vector<uint32_t> ampduSizes{0, 8191, 16383, 32767, 65535};
+        std::vector<uint32_t> amsduSizes{0, 3839, 7935};
+        std::vector<uint16_t> channelWidths{20, 40};
+        std::vector<uint16_t> guardIntervals{800, 400};
+        if (standard == "80211ac")
+        {
+            ampduSizes.push_back(1048575);
+            channelWidths.push_back(80);
+        }
+        else if (standard == "80211ax")
+        {
+            ampduSizes.push_back(6500631);
+            amsduSizes.push_back(11398);
+            channelWidths.push_back(80);
+            guardIntervals = {3200, 1600, 800};
+        }
+
+        for (auto width : channelWidths)
+        {
+            for (auto gi : guardIntervals)
+            {
+                for (auto ampdu : ampduSizes)
+                {
+                    for (auto amsdu : amsduSizes)
+                    {
+                        config.channelWidth = width;
+                        config.guardInterval = gi;
+                        config.maxAmpduSize = ampdu;
+                        config.maxAmsduSize = amsdu;
+                        std::ostringstream point;
+                        point << width << " " << gi << " " << ampdu << " " << amsdu;
+                        points.push_back(config);
+                        pointNames.push_back(point.str());
+                    }
+                }
+            }
+        }
+    }
+
+    // every (point, replication) pair is an independent run, replication r
+    // using the substream run number RngRun + r
+    printSamples = !sweep && replications == 1;
+    uint64_t baseRun = RngSeedManager::GetRun();
+    ReplicationPool pool(jobs);
+    std::vector<std::string> results =
+        pool.Run(points.size() * replications, [&](uint32_t job) -> std::string {
+            uint32_t point = job / replications;
+            RngSeedManager::SetRun(baseRun + job % replications);
+            if (cache.Begin(pointNames[point]))
+            {
+                return cache.GetValue();
+            }
+            double goodput = RunScenario(points[point],
+                                         numNodes,
+                                         distance,
+                                         payloadSize,
+                                         dataRate,
+                                         startMeasureTime,
+                                         simulationTime,
+                                         sampleInterval,
+                                         pcapTracing && !sweep);
+            std::string value = ResultCache::Format(goodput);
+            if (latency)
+            {
+                std::ostringstream histograms;
+                latencies->Serialize(histograms);
+                value += "\n" + histograms.str();
+                latencies = nullptr;
+            }
+            cache.End(value);
+            return value;
+        });
+
+    // mean goodput of every point over its replications
+    std::vector<double> goodputs(points.size(), 0);
+    for (uint32_t job = 0; job < results.size(); job++)
+    {
+        goodputs[job / replications] += std::stod(results[job]) / replications;
+    }
+
+    // delay and jitter histograms of every point, merged over its replications
+    std::vector<LatencyRecorder> pointLatencies(points.size());
+    for (uint32_t job = 0; latency && job < results.size(); job++)
+    {
+        std::istringstream is(results[job]);
+        double goodput;
+        is >> goodput;
+        NS_ABORT_MSG_UNLESS(pointLatencies[job / replications].Deserialize(is),
+                            "Invalid latency histograms in the result of run " << job);
+    }
+
+    if (!sweep)
+    {
+        if (replications == 1)
+        {
+            std::cout << "\nAverage throughput: " << goodputs[0] << " Mbit/s" << std::endl;
+        }
+        else
+        {
+            double variance = 0;
+            for (uint32_t r = 0; r < replications; r++)
+            {
+                double goodput = std::stod(results[r]);
+                std::cout << "Replication " << r << " (RngRun " << baseRun + r << "): " << goodput
+                          << " Mbit/s" << std::endl;
+                variance += (goodput - goodputs[0]) * (goodput - goodputs[0]) / (replications - 1);
+            }
+            std::cout << "\nAverage throughput: " << goodputs[0] << " Mbit/s (standard deviation "
+                      << std::sqrt(variance) << " over " << replications << " replications)"
+                      << std::endl;
+        }
+        if (latency)
+        {
+            std::cout << "\nEnd-to-end delay and jitter:" << std::endl;
+            pointLatencies[0].Print(std::cout);
+        }
+        return 0;
+    }
+
+    std::cout << "width\tgi\tampdu\tamsdu\tgoodput\tphyRate\tefficiency"
+              << (latency ? "\tp50ms\tp99ms" : "") << std::endl;
+    WifiConfig best = config;
+    double bestGoodput = -1;
+    for (std::size_t i = 0; i < points.size(); i++)
+    {
+        const WifiConfig& point = points[i];
+        double goodput = goodputs[i];
+        double nominal = GetNominalPhyRate(point);
+        std::cout << point.channelWidth << "\t" << point.guardInterval << "\t" << point.maxAmpduSize
+                  << "\t" << point.maxAmsduSize << "\t" << std::fixed << std::setprecision(2)
+                  << goodput << "\t" << nominal << "\t" << std::setprecision(3)
+                  << goodput / nominal;
+        if (latency)
+        {
+            std::cout << "\t" << pointLatencies[i].GetDelayQuantile(0.5).GetSeconds() * 1e3 << "\t"
+                      << pointLatencies[i].GetDelayQuantile(0.99).GetSeconds() * 1e3;
+        }
+        std::cout << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setprecision(6);
+        if (goodput > bestGoodput)
+        {
+            bestGoodput = goodput;
+            best = point;
+        }
+    }
 
-    std::cout << "\nAverage throughput: " << averageThroughput << " Mbit/s" << std::endl;
+    std::cout << "\nBest goodput: " << bestGoodput << " Mbit/s with channelWidth="
+              << best.channelWidth << " guardInterval=" << best.guardInterval
+              << " maxAmpduSize=" << best.maxAmpduSize << " maxAmsduSize=" << best.maxAmsduSize
+              << std::endl;
     return 0;
 }